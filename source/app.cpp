@@ -2,7 +2,11 @@
 // in the LICENSE file found in the top-level directory of this
 // distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
 
+#include "editjournal.h"
+#include "incrementalsearch.h"
+#include "lexerregistry.h"
 #include "scintillaeditorview.h"
+#include "scintillaminimapview.h"
 #include "vstgui/lib/cframe.h"
 #include "vstgui/lib/controls/csearchtextedit.h"
 #include "vstgui/lib/iviewlistener.h"
@@ -12,11 +16,16 @@
 #include "vstgui/standalone/include/helpers/value.h"
 #include "vstgui/standalone/include/helpers/windowlistener.h"
 #include "vstgui/standalone/include/iapplication.h"
+#include "vstgui/standalone/include/icommondirectories.h"
 #include "vstgui/standalone/include/iuidescwindow.h"
 #include "vstgui/uidescription/delegationcontroller.h"
 
 #include "ILexer.h"
 #include "SciLexer.h"
+#include "Scintilla.h"
+
+#include <fstream>
+#include <iterator>
 
 using namespace VSTGUI;
 using namespace VSTGUI::Standalone;
@@ -30,6 +39,24 @@ static Command ZoomInCommand = {"Zoom", "Zoom In"};
 static Command ZoomOutCommand = {"Zoom", "Zoom Out"};
 static Command ResetZoomCommand = {"Zoom", "Reset Zoom"};
 
+static constexpr auto CppLexerName = "cpp";
+static constexpr uint64_t UndoMemoryLimit = 16 * 1024 * 1024;
+
+//------------------------------------------------------------------------
+static void registerLexers ()
+{
+	LexerRegistry::Config cpp;
+	cpp.lexerName = "cpp";
+	cpp.keywords[0] =
+	    R"(alignas alignof and and_eq asm auto bitand bitor bool break case catch char char16_t char32_t class compl const constexpr const_cast continue decltype default delete do double dynamic_cast else enum explicit export extern false float for friend goto if inline int long mutable namespace new noexcept not not_eq nullptr operator or or_eq private protected public register reinterpret_cast return short signed sizeof static static_assert static_cast struct switch template this thread_local throw true try typedef typeid typename union unsigned using virtual void volatile wchar_t while xor xor_eq)";
+	cpp.properties["fold"] = "1";
+	cpp.properties["fold.comment"] = "1";
+	cpp.properties["lexer.cpp.track.preprocessor"] = "0";
+	cpp.styles[SCE_C_WORD].weight = 900;
+	cpp.styles[SCE_C_PREPROCESSORCOMMENT].foreground = kRedCColor;
+	LexerRegistry::instance ().add (CppLexerName, std::move (cpp));
+}
+
 //------------------------------------------------------------------------
 class SearchModel : public UIDesc::IModelBinding
 {
@@ -43,17 +70,20 @@ public:
 	static constexpr auto WholeWordID = "WholeWord";
 	static constexpr auto MatchCaseID = "MatchCase";
 	static constexpr auto WordStartID = "WordStart";
+	static constexpr auto RegularExpressionID = "RegularExpression";
 
 	SearchModel ()
 	{
 		values.emplace_back (Value::makeStepValue (WholeWordID, 2));
 		values.emplace_back (Value::makeStepValue (MatchCaseID, 2));
 		values.emplace_back (Value::makeStepValue (WordStartID, 2));
+		values.emplace_back (Value::makeStepValue (RegularExpressionID, 2));
 	}
 
 	bool matchCase () const { return getStepValue (MatchCaseID) != 0; }
 	bool wholeWord () const { return getStepValue (WholeWordID) != 0; }
 	bool wordStart () const { return getStepValue (WordStartID) != 0; }
+	bool regularExpression () const { return getStepValue (RegularExpressionID) != 0; }
 
 private:
 	uint32_t getStepValue (IdStringPtr valueID) const
@@ -90,15 +120,10 @@ public:
 		{
 			editor = ed;
 			editor->registerViewListener (this);
-			if (auto lexer = ScintillaEditorView::createLexer ("cpp"))
+			if (auto lexer = LexerRegistry::instance ().create (CppLexerName))
 			{
-				auto keywords =
-				    R"(alignas alignof and and_eq asm auto bitand bitor bool break case catch char char16_t char32_t class compl const constexpr const_cast continue decltype default delete do double dynamic_cast else enum explicit export extern false float for friend goto if inline int long mutable namespace new noexcept not not_eq nullptr operator or or_eq private protected public register reinterpret_cast return short signed sizeof static static_assert static_cast struct switch template this thread_local throw true try typedef typeid typename union unsigned using virtual void volatile wchar_t while xor xor_eq)";
-				lexer->WordListSet (0, keywords);
-				lexer->PropertySet ("fold", "1");
-				lexer->PropertySet ("fold.comment", "1");
-				lexer->PropertySet ("lexer.cpp.track.preprocessor", "0");
 				editor->setLexer (lexer);
+				editor->setBackgroundLexing (true);
 
 				CColor commentColor;
 				auto fontColor = editor->getStaticFontColor ();
@@ -111,18 +136,48 @@ public:
 				commentColor.toHSL (h, s, l);
 				l *= 0.5;
 				commentColor.fromHSL (h, s, l);
-				editor->setStyleColor (SCE_C_COMMENT, commentColor);
-				editor->setStyleColor (SCE_C_COMMENTLINE, commentColor);
-				editor->setStyleColor (SCE_C_COMMENTDOC, commentColor);
-				editor->setStyleFontWeight (SCE_C_WORD, 900);
-				editor->setStyleColor (SCE_C_PREPROCESSORCOMMENT, kRedCColor, backgroundColor);
+				// editors with the same uidesc attributes share one theme object
+				ScintillaTheme theme (*editor->getTheme ());
+				LexerRegistry::instance ().applyStyles (CppLexerName, theme);
+				theme.setStyleForeground (SCE_C_COMMENT, commentColor);
+				theme.setStyleForeground (SCE_C_COMMENTLINE, commentColor);
+				theme.setStyleForeground (SCE_C_COMMENTDOC, commentColor);
+				theme.setStyleBackground (SCE_C_PREPROCESSORCOMMENT, backgroundColor);
+				editor->setTheme (ScintillaTheme::intern (theme));
 
 			}
-			Preferences prefs;
-			if (auto value = prefs.get ("EditorText"))
+			editor->setUndoMemoryLimit (UndoMemoryLimit);
+			// a journal left over from the last run means the application did not quit normally
+			std::string recoveredText;
+			auto path = preferencesFilePath ("EditorText.journal");
+			if (!path.empty () && EditJournal::recover (path, recoveredText))
+			{
+				editor->setText (std::string_view (recoveredText));
+			}
+			else if (!restoreUndoHistory ())
+			{
+				Preferences prefs;
+				if (auto value = prefs.get ("EditorText"))
+				{
+					editor->setText (*value);
+				}
+			}
+			if (!path.empty ())
 			{
-				editor->setText (*value);
+				journal = std::make_unique<EditJournal> (path);
+				journal->attach (editor);
 			}
+			search = std::make_unique<IncrementalSearch> (editor);
+			search->setCallback ([this] (const auto& s) { onSearchMatches (s); });
+			if (minimap)
+				minimap->setEditor (editor);
+		}
+		else if (auto mm = dynamic_cast<ScintillaMinimapView*> (view))
+		{
+			minimap = mm;
+			minimap->registerViewListener (this);
+			if (editor)
+				minimap->setEditor (editor);
 		}
 		else if (auto sf = dynamic_cast<CSearchTextEdit*> (view))
 		{
@@ -134,9 +189,9 @@ public:
 
 	void valueChanged (CControl* control) override
 	{
-		if (control == searchField)
+		if (control == searchField && search)
 		{
-			doFind ();
+			search->setQuery (searchField->getText ().getString (), searchFlags ());
 		}
 	}
 
@@ -147,8 +202,15 @@ public:
 			auto text = editor->getText ();
 			Preferences prefs;
 			prefs.set ("EditorText", text);
+			saveUndoHistory ();
+			if (journal)
+				journal->discard ();
+			journal = nullptr;
+			search = nullptr;
 			editor = nullptr;
 		}
+		else if (view == minimap)
+			minimap = nullptr;
 		view->unregisterViewListener (this);
 	}
 
@@ -230,11 +292,9 @@ public:
 		return false;
 	}
 
-	void doFind (bool next = true)
+	uint32_t searchFlags () const
 	{
-		uint32_t flags = ScintillaEditorView::ScrollTo | ScintillaEditorView::Wrap;
-		if (!next)
-			flags |= ScintillaEditorView::Backwards;
+		uint32_t flags = 0;
 		const auto& searchModel = SearchModel::instance ();
 		if (searchModel->matchCase ())
 			flags |= ScintillaEditorView::MatchCase;
@@ -242,14 +302,71 @@ public:
 			flags |= ScintillaEditorView::WordStart;
 		if (searchModel->wholeWord ())
 			flags |= ScintillaEditorView::WholeWord;
+		if (searchModel->regularExpression ())
+			flags |= ScintillaEditorView::RegularExpression;
+		return flags;
+	}
+
+	/** highlight all matches and select the first one after the selection start */
+	void onSearchMatches (const IncrementalSearch& s)
+	{
+		const auto& matches = s.getMatches ();
+		editor->setFindHighlights (matches);
+		auto index = s.nextMatch (editor->getSelection ().start);
+		if (index < 0 && !matches.empty ())
+			index = 0;
+		if (index < 0)
+			return;
+		editor->setSelection (matches[static_cast<size_t> (index)]);
+		editor->sendMessage (SCI_SCROLLCARET);
+	}
+
+	void doFind (bool next = true)
+	{
+		uint32_t flags = ScintillaEditorView::ScrollTo | ScintillaEditorView::Wrap | searchFlags ();
+		if (!next)
+			flags |= ScintillaEditorView::Backwards;
 		const auto& text = searchField->getText ();
 		editor->takeFocus ();
 		editor->findAndSelect (text.data (), flags);
 	}
 
 private:
+	static std::string preferencesFilePath (const char* name)
+	{
+		auto dir = IApplication::instance ().getCommonDirectories ().get (
+		    CommonDirectoryLocation::AppPreferencesPath, "", true);
+		if (!dir)
+			return {};
+		return dir->getString () + name;
+	}
+
+	/** the text and its undo history of the last run */
+	bool restoreUndoHistory ()
+	{
+		auto path = preferencesFilePath ("EditorText.undo");
+		std::ifstream stream (path, std::ios::binary);
+		if (!stream)
+			return false;
+		std::string data {std::istreambuf_iterator<char> (stream), {}};
+		return editor->restoreUndoHistory (data);
+	}
+
+	void saveUndoHistory ()
+	{
+		auto path = preferencesFilePath ("EditorText.undo");
+		if (path.empty ())
+			return;
+		auto data = editor->saveUndoHistory ();
+		std::ofstream stream (path, std::ios::binary | std::ios::trunc);
+		stream.write (data.data (), static_cast<std::streamsize> (data.size ()));
+	}
+
 	ScintillaEditorView* editor {nullptr};
+	ScintillaMinimapView* minimap {nullptr};
 	CSearchTextEdit* searchField {nullptr};
+	std::unique_ptr<EditJournal> journal;
+	std::unique_ptr<IncrementalSearch> search;
 };
 
 //------------------------------------------------------------------------
@@ -262,6 +379,8 @@ public:
 
 	void finishLaunching () override
 	{
+		registerLexers ();
+
 		auto customization = UIDesc::Customization::make ();
 		customization->addCreateViewControllerFunc (
 		    "EditorController", [] (const auto& name, auto parent, const auto uiDesc) {
@@ -0,0 +1,398 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "backgroundlexer.h"
+
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** the document a lexer sees on the worker thread. The text is read from the snapshot, the
+ *	styles, fold levels and line states the lexer sets are collected into a result.
+ */
+class SnapshotDocument final : public Scintilla::IDocument
+{
+public:
+	using Result = BackgroundLexer::Result;
+	using Job = BackgroundLexer::Job;
+
+	explicit SnapshotDocument (const Job& job) : job (job), length (job.snapshot->size ())
+	{
+		result.version = job.snapshot->getVersion ();
+		result.start = job.start;
+		result.startLine = job.startLine;
+		result.styles.assign (static_cast<size_t> (job.end - job.start), 0);
+		lineStarts.emplace_back (job.start);
+		scanned = job.start;
+	}
+
+	Result takeResult () { return std::move (result); }
+
+	int SCI_METHOD Version () const override { return Scintilla::dvRelease4; }
+	void SCI_METHOD SetErrorStatus (int) override {}
+	Sci_Position SCI_METHOD Length () const override { return static_cast<Sci_Position> (length); }
+
+	void SCI_METHOD GetCharRange (char* buffer, Sci_Position position,
+	                              Sci_Position lengthRetrieve) const override
+	{
+		if (position < 0 || lengthRetrieve <= 0)
+			return;
+		job.snapshot->forEach (static_cast<size_t> (position), static_cast<size_t> (lengthRetrieve),
+		                       [&] (std::string_view part) {
+			                       std::memcpy (buffer, part.data (), part.size ());
+			                       buffer += part.size ();
+		                       });
+	}
+
+	char SCI_METHOD StyleAt (Sci_Position position) const override
+	{
+		if (position >= job.start)
+		{
+			auto index = static_cast<size_t> (position - job.start);
+			return index < result.styles.size () ? result.styles[index] : 0;
+		}
+		auto offset = static_cast<int64_t> (job.previousStyles.size ()) - (job.start - position);
+		return offset >= 0 ? job.previousStyles[static_cast<size_t> (offset)] : 0;
+	}
+
+	Sci_Position SCI_METHOD LineFromPosition (Sci_Position position) const override
+	{
+		// the lines before the previous line are never looked at by the lexers
+		if (position < job.start)
+			return std::max<Sci_Position> (0, job.startLine - 1);
+		scanTo (position);
+		auto it = std::upper_bound (lineStarts.begin (), lineStarts.end (), position);
+		return job.startLine + std::distance (lineStarts.begin (), it) - 1;
+	}
+
+	Sci_Position SCI_METHOD LineStart (Sci_Position line) const override
+	{
+		if (line < job.startLine)
+			return line == job.startLine - 1 ? job.previousLineStart : 0;
+		auto index = static_cast<size_t> (line - job.startLine);
+		while (index >= lineStarts.size () && scanned < length)
+			scanTo (static_cast<Sci_Position> (scanned));
+		return index < lineStarts.size () ? lineStarts[index] : Length ();
+	}
+
+	Sci_Position SCI_METHOD LineEnd (Sci_Position line) const override
+	{
+		auto end = LineStart (line + 1);
+		if (end > LineStart (line) && charAt (end - 1) == '\n')
+			--end;
+		if (end > LineStart (line) && charAt (end - 1) == '\r')
+			--end;
+		return end;
+	}
+
+	int SCI_METHOD GetLevel (Sci_Position line) const override
+	{
+		if (line < job.startLine)
+			return line == job.startLine - 1 ? job.previousLevel : SC_FOLDLEVELBASE;
+		auto index = static_cast<size_t> (line - job.startLine);
+		if (index < result.levels.size () && result.levels[index])
+			return *result.levels[index];
+		return SC_FOLDLEVELBASE;
+	}
+
+	int SCI_METHOD SetLevel (Sci_Position line, int level) override
+	{
+		auto previous = GetLevel (line);
+		if (line >= job.startLine)
+			setLineValue (result.levels, line, level);
+		return previous;
+	}
+
+	int SCI_METHOD GetLineState (Sci_Position line) const override
+	{
+		if (line < job.startLine)
+			return line == job.startLine - 1 ? job.previousLineState : 0;
+		auto index = static_cast<size_t> (line - job.startLine);
+		if (index < result.lineStates.size () && result.lineStates[index])
+			return *result.lineStates[index];
+		return 0;
+	}
+
+	int SCI_METHOD SetLineState (Sci_Position line, int state) override
+	{
+		auto previous = GetLineState (line);
+		if (line >= job.startLine)
+			setLineValue (result.lineStates, line, state);
+		return previous;
+	}
+
+	void SCI_METHOD StartStyling (Sci_Position position) override { stylingPosition = position; }
+
+	bool SCI_METHOD SetStyleFor (Sci_Position count, char style) override
+	{
+		for (Sci_Position i = 0; i < count; ++i)
+			setStyle (stylingPosition++, style);
+		return true;
+	}
+
+	bool SCI_METHOD SetStyles (Sci_Position count, const char* styles) override
+	{
+		for (Sci_Position i = 0; i < count; ++i)
+			setStyle (stylingPosition++, styles[i]);
+		return true;
+	}
+
+	// indicators and requests to lex other ranges are not supported
+	void SCI_METHOD DecorationSetCurrentIndicator (int) override {}
+	void SCI_METHOD DecorationFillRange (Sci_Position, int, Sci_Position) override {}
+	void SCI_METHOD ChangeLexerState (Sci_Position, Sci_Position) override {}
+
+	int SCI_METHOD CodePage () const override { return job.codePage; }
+	bool SCI_METHOD IsDBCSLeadByte (char) const override { return false; }
+
+	const char* SCI_METHOD BufferPointer () override
+	{
+		// only a few lexers need the text in one piece
+		if (!text)
+			text = job.snapshot->getText ();
+		return text->data ();
+	}
+
+	int SCI_METHOD GetLineIndentation (Sci_Position line) override
+	{
+		int indent = 0;
+		auto tabWidth = std::max (1, job.tabWidth);
+		for (auto pos = LineStart (line); pos < Length (); ++pos)
+		{
+			auto c = charAt (pos);
+			if (c == ' ')
+				++indent;
+			else if (c == '\t')
+				indent = (indent / tabWidth + 1) * tabWidth;
+			else
+				break;
+		}
+		return indent;
+	}
+
+	Sci_Position SCI_METHOD GetRelativePosition (Sci_Position positionStart,
+	                                             Sci_Position characterOffset) const override
+	{
+		auto pos = positionStart;
+		if (job.codePage != SC_CP_UTF8)
+			pos += characterOffset;
+		else if (characterOffset > 0)
+		{
+			for (; characterOffset > 0 && pos < Length (); --characterOffset)
+			{
+				Sci_Position width = 1;
+				GetCharacterAndWidth (pos, &width);
+				pos += width;
+			}
+			if (characterOffset > 0)
+				return INVALID_POSITION;
+		}
+		else
+		{
+			for (; characterOffset < 0 && pos > 0; ++characterOffset)
+			{
+				--pos;
+				// skip the continuation bytes
+				while (pos > 0 && (static_cast<uint8_t> (charAt (pos)) & 0xC0) == 0x80)
+					--pos;
+			}
+			if (characterOffset < 0)
+				return INVALID_POSITION;
+		}
+		return (pos < 0 || pos > Length ()) ? INVALID_POSITION : pos;
+	}
+
+	int SCI_METHOD GetCharacterAndWidth (Sci_Position position,
+	                                     Sci_Position* pWidth) const override
+	{
+		auto lead = static_cast<uint8_t> (charAt (position));
+		auto setWidth = [&] (Sci_Position width) {
+			if (pWidth)
+				*pWidth = width;
+		};
+		setWidth (1);
+		if (job.codePage != SC_CP_UTF8 || lead < 0x80)
+			return lead;
+		int numBytes = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+		if (numBytes == 1 || position + numBytes > Length ())
+			return 0xFFFD;
+		int character = lead & (0x7F >> numBytes);
+		for (int i = 1; i < numBytes; ++i)
+		{
+			auto c = static_cast<uint8_t> (charAt (position + i));
+			if ((c & 0xC0) != 0x80)
+				return 0xFFFD;
+			character = (character << 6) | (c & 0x3F);
+		}
+		setWidth (numBytes);
+		return character;
+	}
+
+private:
+	char charAt (Sci_Position position) const
+	{
+		return job.snapshot->at (static_cast<size_t> (position));
+	}
+
+	void setStyle (Sci_Position position, char style)
+	{
+		if (position < job.start || position >= static_cast<Sci_Position> (length))
+			return;
+		auto index = static_cast<size_t> (position - job.start);
+		if (index >= result.styles.size ())
+			result.styles.resize (index + 1, 0);
+		result.styles[index] = style;
+	}
+
+	void setLineValue (std::vector<std::optional<int>>& values, Sci_Position line, int value)
+	{
+		auto index = static_cast<size_t> (line - job.startLine);
+		if (index >= values.size ())
+			values.resize (index + 1);
+		values[index] = value;
+	}
+
+	/** find the line starts up to position, a CR LF pair ends one line */
+	void scanTo (Sci_Position position) const
+	{
+		constexpr size_t ScanBlockSize = 64 * 1024;
+		if (position < static_cast<Sci_Position> (scanned) || scanned >= length)
+			return;
+		auto count = std::max (static_cast<size_t> (position) - scanned + 1, ScanBlockSize);
+		auto pos = scanned;
+		job.snapshot->forEach (scanned, count, [&] (std::string_view part) {
+			for (auto c : part)
+			{
+				++pos;
+				if (c == '\n')
+				{
+					if (pendingCR && lineStarts.back () == static_cast<Sci_Position> (pos - 1))
+						lineStarts.back () = static_cast<Sci_Position> (pos);
+					else
+						lineStarts.emplace_back (static_cast<Sci_Position> (pos));
+					pendingCR = false;
+				}
+				else if (c == '\r')
+				{
+					lineStarts.emplace_back (static_cast<Sci_Position> (pos));
+					pendingCR = true;
+				}
+				else
+					pendingCR = false;
+			}
+		});
+		scanned = pos;
+	}
+
+	const Job& job;
+	size_t length;
+	Result result;
+	Sci_Position stylingPosition {0};
+	std::optional<std::string> text;
+	mutable std::vector<Sci_Position> lineStarts;
+	mutable size_t scanned {0};
+	mutable bool pendingCR {false};
+};
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+BackgroundLexer::BackgroundLexer (const std::shared_ptr<Scintilla::ILexer5>& lexer) : lexer (lexer)
+{
+	worker = std::thread ([this] () { workerLoop (); });
+}
+
+//------------------------------------------------------------------------
+BackgroundLexer::~BackgroundLexer () noexcept
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		stopRequested = true;
+		pendingJob.reset ();
+	}
+	condition.notify_all ();
+	worker.join ();
+}
+
+//------------------------------------------------------------------------
+void BackgroundLexer::post (Job&& job)
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		pendingJob = std::move (job);
+	}
+	condition.notify_all ();
+}
+
+//------------------------------------------------------------------------
+auto BackgroundLexer::takeResult () -> std::optional<Result>
+{
+	std::lock_guard<std::mutex> guard (mutex);
+	auto r = std::move (result);
+	result.reset ();
+	return r;
+}
+
+//------------------------------------------------------------------------
+bool BackgroundLexer::isBusy () const
+{
+	std::lock_guard<std::mutex> guard (mutex);
+	return running || pendingJob;
+}
+
+//------------------------------------------------------------------------
+void BackgroundLexer::wait ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	condition.wait (lock, [this] () { return !running && !pendingJob; });
+}
+
+//------------------------------------------------------------------------
+auto BackgroundLexer::run (Scintilla::ILexer5& lexer, const Job& job) -> Result
+{
+	SnapshotDocument document (job);
+	auto length = static_cast<Sci_Position> (job.end - job.start);
+	if (length > 0)
+	{
+		lexer.Lex (static_cast<Sci_PositionU> (job.start), length, job.initStyle, &document);
+		lexer.Fold (static_cast<Sci_PositionU> (job.start), length, job.initStyle, &document);
+	}
+	return document.takeResult ();
+}
+
+//------------------------------------------------------------------------
+void BackgroundLexer::workerLoop ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	while (true)
+	{
+		condition.wait (lock, [this] () { return stopRequested || pendingJob; });
+		if (stopRequested)
+			break;
+		auto job = std::move (*pendingJob);
+		pendingJob.reset ();
+		running = true;
+		lock.unlock ();
+
+		auto jobResult = run (*lexer, job);
+
+		lock.lock ();
+		result = std::move (jobResult);
+		running = false;
+		condition.notify_all ();
+	}
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
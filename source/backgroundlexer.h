@@ -0,0 +1,99 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "documentsnapshot.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Scintilla {
+class ILexer5;
+}
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Runs a lexer on a worker thread against a DocumentSnapshot.
+ *
+ *	Only one job is lexed at a time, a job posted while another one is running replaces the
+ *	waiting job. The lexer must not be used by other threads while the BackgroundLexer exists.
+ */
+class BackgroundLexer
+{
+public:
+	/** lex the lines from start to end of a snapshot. The state of the line before the first
+	 *	line is copied from the document, as lexers continue from it.
+	 */
+	struct Job
+	{
+		std::shared_ptr<const DocumentSnapshot> snapshot;
+		/** the start of the first line to lex */
+		int64_t start {0};
+		/** the start of the line after the last line to lex, or the length of the text */
+		int64_t end {0};
+		int64_t startLine {0};
+		/** the style of the character before start */
+		int initStyle {0};
+		/** the styles of the end of the previous line, up to start */
+		std::string previousStyles;
+		int64_t previousLineStart {0};
+		int previousLineState {0};
+		int previousLevel {0};
+		int codePage {0};
+		int tabWidth {8};
+	};
+
+	struct Result
+	{
+		/** the version of the snapshot which was lexed */
+		uint64_t version {0};
+		int64_t start {0};
+		int64_t startLine {0};
+		/** the styles of the text from start */
+		std::string styles;
+		/** the fold levels and line states of the lines from startLine, set by the lexer */
+		std::vector<std::optional<int>> levels;
+		std::vector<std::optional<int>> lineStates;
+	};
+
+	explicit BackgroundLexer (const std::shared_ptr<Scintilla::ILexer5>& lexer);
+	/** waits for the running job */
+	~BackgroundLexer () noexcept;
+
+	void post (Job&& job);
+	/** get the result of the last finished job */
+	std::optional<Result> takeResult ();
+	/** a job is waiting or running */
+	[[nodiscard]] bool isBusy () const;
+	/** wait until no job is waiting or running */
+	void wait ();
+
+	/** lex on the calling thread */
+	static Result run (Scintilla::ILexer5& lexer, const Job& job);
+
+private:
+	void workerLoop ();
+
+	std::shared_ptr<Scintilla::ILexer5> lexer;
+	std::thread worker;
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	std::optional<Job> pendingJob;
+	std::optional<Result> result;
+	bool running {false};
+	bool stopRequested {false};
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
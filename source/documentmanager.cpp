@@ -0,0 +1,495 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "documentmanager.h"
+
+#include "ILoader.h"
+#include "Scintilla.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** the text is compressed in independent blocks of at most this size */
+constexpr size_t BlockSize = 1024 * 1024;
+constexpr size_t MinMatch = 4;
+constexpr size_t MaxOffset = 0xFFFF;
+constexpr uint32_t HashBits = 14;
+
+//------------------------------------------------------------------------
+void writeUInt32 (std::vector<uint8_t>& output, size_t value)
+{
+	for (auto shift = 0u; shift < 32; shift += 8)
+		output.push_back (static_cast<uint8_t> (value >> shift));
+}
+
+//------------------------------------------------------------------------
+uint32_t readUInt32 (const uint8_t* input)
+{
+	return static_cast<uint32_t> (input[0]) | (static_cast<uint32_t> (input[1]) << 8) |
+	       (static_cast<uint32_t> (input[2]) << 16) | (static_cast<uint32_t> (input[3]) << 24);
+}
+
+//------------------------------------------------------------------------
+/** lengths of 15 and more continue in bytes of 255 and a last byte below 255 */
+void writeLength (std::vector<uint8_t>& output, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		output.push_back (255);
+	output.push_back (static_cast<uint8_t> (length));
+}
+
+//------------------------------------------------------------------------
+void writeSequence (std::vector<uint8_t>& output, const uint8_t* literals, size_t numLiterals,
+                    size_t offset, size_t matchLength)
+{
+	auto matchCode = matchLength ? matchLength - MinMatch : 0;
+	output.push_back (static_cast<uint8_t> ((std::min<size_t> (numLiterals, 15) << 4) |
+	                                        std::min<size_t> (matchCode, 15)));
+	if (numLiterals >= 15)
+		writeLength (output, numLiterals - 15);
+	output.insert (output.end (), literals, literals + numLiterals);
+	if (matchLength == 0)
+		return;
+	output.push_back (static_cast<uint8_t> (offset));
+	output.push_back (static_cast<uint8_t> (offset >> 8));
+	if (matchCode >= 15)
+		writeLength (output, matchCode - 15);
+}
+
+//------------------------------------------------------------------------
+/** a LZ77 compressor in the style of LZ4: each sequence is a token with the lengths of its
+ *	literals and of its match, the literals and the offset of the match in the last 64 KB. The
+ *	last sequence of a block only has literals.
+ */
+void compressBlock (std::string_view block, std::vector<uint32_t>& table,
+                    std::vector<uint8_t>& output)
+{
+	constexpr auto Empty = std::numeric_limits<uint32_t>::max ();
+	std::fill (table.begin (), table.end (), Empty);
+	auto data = reinterpret_cast<const uint8_t*> (block.data ());
+	auto size = block.size ();
+	auto read32 = [data] (size_t position) {
+		uint32_t value;
+		std::memcpy (&value, data + position, sizeof (value));
+		return value;
+	};
+	size_t anchor = 0;
+	size_t position = 0;
+	while (position + MinMatch <= size)
+	{
+		auto value = read32 (position);
+		auto& slot = table[(value * 2654435761u) >> (32 - HashBits)];
+		auto candidate = slot;
+		slot = static_cast<uint32_t> (position);
+		if (candidate == Empty || position - candidate > MaxOffset || read32 (candidate) != value)
+		{
+			++position;
+			continue;
+		}
+		auto length = MinMatch;
+		while (position + length < size && data[candidate + length] == data[position + length])
+			++length;
+		writeSequence (output, data + anchor, position - anchor, position - candidate, length);
+		position += length;
+		anchor = position;
+	}
+	writeSequence (output, data + anchor, size - anchor, 0, 0);
+}
+
+//------------------------------------------------------------------------
+bool readLength (const uint8_t*& input, const uint8_t* end, size_t& length)
+{
+	if (length != 15)
+		return true;
+	while (input < end)
+	{
+		auto byte = *input++;
+		length += byte;
+		if (byte != 255)
+			return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+bool decompressBlock (const uint8_t* input, size_t size, std::string& output)
+{
+	auto end = input + size;
+	while (input < end)
+	{
+		auto token = *input++;
+		size_t numLiterals = token >> 4;
+		if (!readLength (input, end, numLiterals) ||
+		    numLiterals > static_cast<size_t> (end - input))
+			return false;
+		output.append (reinterpret_cast<const char*> (input), numLiterals);
+		input += numLiterals;
+		if (input == end)
+			return true;
+		if (end - input < 2)
+			return false;
+		size_t offset = input[0] | (input[1] << 8);
+		input += 2;
+		size_t matchLength = token & 0x0F;
+		if (!readLength (input, end, matchLength))
+			return false;
+		matchLength += MinMatch;
+		if (offset == 0 || offset > output.size ())
+			return false;
+		// the match may overlap the bytes it produces
+		auto from = output.size () - offset;
+		for (size_t index = 0; index < matchLength; ++index)
+			output.push_back (output[from + index]);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+std::vector<uint8_t> compress (const ScintillaEditorView::TextView& text)
+{
+	std::vector<uint8_t> output;
+	std::vector<uint32_t> table (size_t (1) << HashBits);
+	text.forEach ([&] (std::string_view part) {
+		for (size_t offset = 0; offset < part.size (); offset += BlockSize)
+		{
+			auto block = part.substr (offset, BlockSize);
+			// every block starts with its size and the size of its compressed data
+			auto header = output.size ();
+			writeUInt32 (output, block.size ());
+			writeUInt32 (output, 0);
+			compressBlock (block, table, output);
+			auto compressedSize = output.size () - header - 8;
+			for (auto index = 0u; index < 4; ++index)
+				output[header + 4 + index] = static_cast<uint8_t> (compressedSize >> (index * 8));
+		}
+	});
+	output.shrink_to_fit ();
+	return output;
+}
+
+//------------------------------------------------------------------------
+/** call proc with every decompressed block */
+template <typename Proc>
+bool decompress (const std::vector<uint8_t>& input, Proc proc)
+{
+	std::string block;
+	block.reserve (BlockSize);
+	size_t position = 0;
+	while (position < input.size ())
+	{
+		if (input.size () - position < 8)
+			return false;
+		auto size = readUInt32 (input.data () + position);
+		auto compressedSize = readUInt32 (input.data () + position + 4);
+		position += 8;
+		if (compressedSize > input.size () - position)
+			return false;
+		block.clear ();
+		if (!decompressBlock (input.data () + position, compressedSize, block) ||
+		    block.size () != size || !proc (std::string_view (block)))
+			return false;
+		position += compressedSize;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+/** create a document with a loader, so that no view is notified while the text is added */
+template <typename Proc>
+void* loadDocument (ScintillaEditorView& view, uint64_t length, intptr_t options, Proc addData)
+{
+	auto loader = reinterpret_cast<Scintilla::ILoader*> (
+	    view.sendMessage (SCI_CREATELOADER, length + 1, options));
+	if (!loader)
+		return nullptr;
+	auto add = [loader] (std::string_view data) {
+		return loader->AddData (data.data (), static_cast<Sci_Position> (data.size ())) ==
+		       SC_STATUS_OK;
+	};
+	if (!addData (add))
+	{
+		loader->Release ();
+		return nullptr;
+	}
+	return loader->ConvertToDocument ();
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+DocumentManager::DocumentManager (ScintillaEditorView& view) : view (view) {}
+
+//------------------------------------------------------------------------
+DocumentManager::~DocumentManager () noexcept
+{
+	for (auto& [id, document] : documents)
+	{
+		if (document.document)
+			view.sendMessage (SCI_RELEASEDOCUMENT, 0, document.document);
+	}
+}
+
+//------------------------------------------------------------------------
+auto DocumentManager::add (std::string_view text) -> ID
+{
+	auto options = view.sendMessage (SCI_GETDOCUMENTOPTIONS) & ~SC_DOCUMENTOPTION_STYLES_NONE;
+	auto document = loadDocument (view, text.size (), options, [&] (auto add) {
+		for (size_t offset = 0; offset < text.size (); offset += BlockSize)
+		{
+			if (!add (text.substr (offset, BlockSize)))
+				return false;
+		}
+		return true;
+	});
+	if (!document)
+		return InvalidID;
+	auto id = nextID++;
+	auto& entry = documents[id];
+	entry.document = document;
+	entry.length = text.size ();
+	entry.documentOptions = options;
+	entry.lastAccess = std::chrono::steady_clock::now ();
+	entry.accessCount = ++accessCount;
+	enforceBudget ();
+	return id;
+}
+
+//------------------------------------------------------------------------
+void DocumentManager::remove (ID id)
+{
+	auto it = documents.find (id);
+	if (it == documents.end ())
+		return;
+	if (id == active)
+	{
+		active = InvalidID;
+		auto options = view.sendMessage (SCI_GETDOCUMENTOPTIONS);
+		auto empty = reinterpret_cast<void*> (view.sendMessage (SCI_CREATEDOCUMENT, 0, options));
+		view.setDocument (empty, true);
+		view.sendMessage (SCI_RELEASEDOCUMENT, 0, empty);
+	}
+	if (it->second.document)
+		view.sendMessage (SCI_RELEASEDOCUMENT, 0, it->second.document);
+	documents.erase (it);
+}
+
+//------------------------------------------------------------------------
+bool DocumentManager::show (ID id)
+{
+	auto it = documents.find (id);
+	if (it == documents.end ())
+		return false;
+	auto& document = it->second;
+	document.lastAccess = std::chrono::steady_clock::now ();
+	document.accessCount = ++accessCount;
+	if (id == active)
+		return true;
+
+	auto startTime = std::chrono::steady_clock::now ();
+	auto parked = document.document == nullptr;
+	std::string undoHistory;
+	if (parked && !restore (document, undoHistory))
+		return false;
+	deactivate ();
+	// a document which was shown before has its own settings
+	view.setDocument (document.document, !document.shown);
+	if (parked && document.shown)
+	{
+		view.sendMessage (SCI_SETCODEPAGE, document.codePage);
+		view.sendMessage (SCI_SETEOLMODE, document.eolMode);
+		view.sendMessage (SCI_SETTABWIDTH, document.tabWidth);
+		view.sendMessage (SCI_SETINDENT, document.indent);
+		view.sendMessage (SCI_SETUSETABS, document.useTabs);
+	}
+	// the document is new and not shared, so restoring the data saveUndoHistory wrote succeeds
+	if (!undoHistory.empty ())
+		view.restoreUndoHistory (undoHistory);
+	if (document.shown)
+	{
+		view.setSelection (document.selection);
+		view.sendMessage (SCI_SETFIRSTVISIBLELINE, document.firstVisibleLine);
+		view.sendMessage (SCI_SETXOFFSET, document.xOffset);
+	}
+	document.shown = true;
+	active = id;
+	if (parked)
+	{
+		stats.lastRestoreSeconds =
+		    std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+		stats.totalRestoreSeconds += stats.lastRestoreSeconds;
+		++stats.numRestores;
+	}
+	enforceBudget ();
+	return true;
+}
+
+//------------------------------------------------------------------------
+void DocumentManager::deactivate ()
+{
+	auto it = documents.find (active);
+	active = InvalidID;
+	// the view may show another document, for example after openFileAsync
+	if (it == documents.end () || view.getDocument () != it->second.document)
+		return;
+	auto& document = it->second;
+	document.selection = view.getSelection ();
+	document.firstVisibleLine = view.sendMessage (SCI_GETFIRSTVISIBLELINE);
+	document.xOffset = view.sendMessage (SCI_GETXOFFSET);
+	document.modified = view.sendMessage (SCI_GETMODIFY) != 0;
+	document.canUndo = view.canUndo ();
+	document.length = static_cast<uint64_t> (view.sendMessage (SCI_GETTEXTLENGTH));
+	document.documentOptions = view.sendMessage (SCI_GETDOCUMENTOPTIONS);
+	document.codePage = view.sendMessage (SCI_GETCODEPAGE);
+	document.eolMode = view.sendMessage (SCI_GETEOLMODE);
+	document.tabWidth = view.sendMessage (SCI_GETTABWIDTH);
+	document.indent = view.sendMessage (SCI_GETINDENT);
+	document.useTabs = view.sendMessage (SCI_GETUSETABS);
+}
+
+//------------------------------------------------------------------------
+bool DocumentManager::restore (Document& document, std::string& undoHistory)
+{
+	void* restored = nullptr;
+	if (document.withUndoHistory)
+	{
+		// the text is set together with the history once the document is shown
+		undoHistory.reserve (static_cast<size_t> (document.length));
+		if (!decompress (document.compressed, [&] (std::string_view block) {
+			    undoHistory.append (block);
+			    return true;
+		    }))
+			return false;
+		restored = reinterpret_cast<void*> (
+		    view.sendMessage (SCI_CREATEDOCUMENT, 0, document.documentOptions));
+	}
+	else
+	{
+		restored = loadDocument (view, document.length, document.documentOptions,
+		                         [&] (auto add) { return decompress (document.compressed, add); });
+	}
+	if (!restored)
+		return false;
+	document.document = restored;
+	document.compressed = {};
+	document.withUndoHistory = false;
+	document.canUndo = false;
+	return true;
+}
+
+//------------------------------------------------------------------------
+bool DocumentManager::canPark (const Document& document) const
+{
+	return !document.modified;
+}
+
+//------------------------------------------------------------------------
+bool DocumentManager::park (ID id)
+{
+	auto it = documents.find (id);
+	if (it == documents.end () || id == active)
+		return false;
+	auto& document = it->second;
+	if (!document.document)
+		return true;
+	if (!canPark (document))
+		return false;
+	document.withUndoHistory = document.canUndo && !discardUndoHistory;
+	view.readDocument (document.document, [&] (const auto& text) {
+		document.length = text.size ();
+		if (document.withUndoHistory)
+		{
+			// the undo state messages read the document which readDocument shows
+			auto history = view.saveUndoHistory ();
+			document.compressed = compress ({history, {}});
+		}
+		else
+			document.compressed = compress (text);
+	});
+	view.sendMessage (SCI_RELEASEDOCUMENT, 0, document.document);
+	document.document = nullptr;
+	return true;
+}
+
+//------------------------------------------------------------------------
+bool DocumentManager::isParked (ID id) const
+{
+	auto it = documents.find (id);
+	return it != documents.end () && it->second.document == nullptr;
+}
+
+//------------------------------------------------------------------------
+void DocumentManager::parkInactive (std::chrono::steady_clock::duration duration)
+{
+	auto now = std::chrono::steady_clock::now ();
+	for (auto& [id, document] : documents)
+	{
+		if (document.document && now - document.lastAccess > duration)
+			park (id);
+	}
+}
+
+//------------------------------------------------------------------------
+void DocumentManager::setBudget (uint64_t bytes)
+{
+	budget = bytes;
+	enforceBudget ();
+}
+
+//------------------------------------------------------------------------
+void DocumentManager::enforceBudget ()
+{
+	if (budget == 0)
+		return;
+	auto resident = getStats ().residentBytes;
+	if (resident <= budget)
+		return;
+	std::vector<std::pair<uint64_t, ID>> candidates;
+	for (const auto& [id, document] : documents)
+	{
+		if (document.document && id != active && canPark (document))
+			candidates.emplace_back (document.accessCount, id);
+	}
+	// the documents which were not shown for the longest time are parked first
+	std::sort (candidates.begin (), candidates.end ());
+	for (const auto& candidate : candidates)
+	{
+		if (resident <= budget)
+			break;
+		auto length = documents[candidate.second].length;
+		if (park (candidate.second))
+			resident -= std::min (resident, length);
+	}
+}
+
+//------------------------------------------------------------------------
+auto DocumentManager::getStats () const -> Stats
+{
+	auto result = stats;
+	for (const auto& [id, document] : documents)
+	{
+		if (!document.document)
+		{
+			result.parkedBytes += document.length;
+			result.compressedBytes += document.compressed.size ();
+			++result.numParked;
+		}
+		else if (id == active && view.getDocument () == document.document)
+			result.residentBytes += static_cast<uint64_t> (view.sendMessage (SCI_GETTEXTLENGTH));
+		else
+			result.residentBytes += document.length;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
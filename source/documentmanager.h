@@ -0,0 +1,135 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Many documents which are shown one at a time in a ScintillaEditorView, for example the tabs
+ *	of an editor.
+ *
+ *	The manager keeps the text of all documents below a memory budget. When the budget is
+ *	exceeded, the documents which were not shown for the longest time are parked: their text is
+ *	compressed into a block and their scintilla document is released. A parked document is
+ *	restored when it is shown again, with its selection and scroll position.
+ *
+ *	Documents with unsaved changes are never parked. Saved documents which still have an undo
+ *	history are parked together with it (see ScintillaEditorView::saveUndoHistory), unless
+ *	setDiscardUndoHistory drops the history to save its memory.
+ */
+class DocumentManager
+{
+public:
+	using ID = uint64_t;
+	static constexpr ID InvalidID = 0;
+
+	struct Stats
+	{
+		/** the text of the documents which are kept by scintilla */
+		uint64_t residentBytes {0};
+		/** the text of the parked documents */
+		uint64_t parkedBytes {0};
+		/** the compressed blocks of the parked documents */
+		uint64_t compressedBytes {0};
+		size_t numParked {0};
+		size_t numRestores {0};
+		/** the time the last restore of a parked document took */
+		double lastRestoreSeconds {0.};
+		double totalRestoreSeconds {0.};
+
+		/** the memory which parking saves */
+		[[nodiscard]] uint64_t savedBytes () const
+		{
+			return parkedBytes > compressedBytes ? parkedBytes - compressedBytes : 0;
+		}
+	};
+
+	/** @param view the view which shows the documents, it must outlive the manager */
+	explicit DocumentManager (ScintillaEditorView& view);
+	/** releases all documents, the view keeps showing its current document */
+	~DocumentManager () noexcept;
+
+	/** add a document with the text, it is shown with the next call of show */
+	ID add (std::string_view text = {});
+	/** remove a document, the view gets an empty document if it showed it */
+	void remove (ID id);
+	/** show a document in the view, a parked document is restored */
+	bool show (ID id);
+	[[nodiscard]] ID getActive () const { return active; }
+	[[nodiscard]] size_t size () const { return documents.size (); }
+
+	/** park a document which is not shown, see the class description for which documents can
+	 *	be parked
+	 */
+	bool park (ID id);
+	[[nodiscard]] bool isParked (ID id) const;
+	/** park all documents which were not shown for the duration */
+	void parkInactive (std::chrono::steady_clock::duration duration);
+
+	/** the maximum size of the text of the resident documents, zero for no limit. The documents
+	 *	which were not shown for the longest time are parked when the budget is exceeded.
+	 */
+	void setBudget (uint64_t bytes);
+	[[nodiscard]] uint64_t getBudget () const { return budget; }
+	/** park saved documents without their undo history, which is lost then */
+	void setDiscardUndoHistory (bool state) { discardUndoHistory = state; }
+	[[nodiscard]] bool getDiscardUndoHistory () const { return discardUndoHistory; }
+
+	[[nodiscard]] Stats getStats () const;
+
+private:
+	struct Document
+	{
+		/** nullptr while the document is parked */
+		void* document {nullptr};
+		/** the text, or what saveUndoHistory returned if withUndoHistory is set */
+		std::vector<uint8_t> compressed;
+		bool withUndoHistory {false};
+		uint64_t length {0};
+		std::chrono::steady_clock::time_point lastAccess;
+		uint64_t accessCount {0};
+		bool shown {false};
+
+		// the state of the document when it was shown the last time
+		ScintillaEditorView::Range selection {};
+		intptr_t firstVisibleLine {0};
+		intptr_t xOffset {0};
+		bool modified {false};
+		bool canUndo {false};
+		intptr_t documentOptions {0};
+		intptr_t codePage {0};
+		intptr_t eolMode {0};
+		intptr_t tabWidth {0};
+		intptr_t indent {0};
+		intptr_t useTabs {0};
+	};
+
+	void deactivate ();
+	bool restore (Document& document, std::string& undoHistory);
+	bool canPark (const Document& document) const;
+	void enforceBudget ();
+
+	ScintillaEditorView& view;
+	std::map<ID, Document> documents;
+	ID active {InvalidID};
+	ID nextID {1};
+	uint64_t accessCount {0};
+	uint64_t budget {0};
+	bool discardUndoHistory {false};
+	Stats stats;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
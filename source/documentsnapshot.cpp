@@ -0,0 +1,227 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "documentsnapshot.h"
+
+#include <atomic>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+size_t DocumentSnapshot::chunkIndex (size_t position) const
+{
+	auto it = std::upper_bound (starts.begin (), starts.end (), position);
+	if (it == starts.begin ())
+		return 0;
+	return static_cast<size_t> (std::distance (starts.begin (), it)) - 1;
+}
+
+//------------------------------------------------------------------------
+std::string DocumentSnapshot::getText () const
+{
+	return getText (0, length);
+}
+
+//------------------------------------------------------------------------
+std::string DocumentSnapshot::getText (size_t start, size_t count) const
+{
+	std::string result;
+	if (start < length)
+		result.reserve (std::min (count, length - start));
+	forEach (start, count, [&] (std::string_view part) { result.append (part); });
+	return result;
+}
+
+//------------------------------------------------------------------------
+char DocumentSnapshot::at (size_t position) const
+{
+	if (position >= length)
+		return 0;
+	auto index = chunkIndex (position);
+	return (*chunks[index])[position - starts[index]];
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::reset (std::string_view first, std::string_view second)
+{
+	last = nullptr;
+	text.chunks.clear ();
+	text.length = first.size () + second.size ();
+	text.chunks.reserve (text.length / ChunkSize + 2);
+	auto chunk = std::make_shared<std::string> ();
+	for (auto part : {first, second})
+	{
+		while (!part.empty ())
+		{
+			if (chunk->size () == ChunkSize)
+			{
+				text.chunks.emplace_back (std::move (chunk));
+				chunk = std::make_shared<std::string> ();
+			}
+			if (chunk->empty ())
+				chunk->reserve (ChunkSize);
+			auto count = std::min (part.size (), ChunkSize - chunk->size ());
+			chunk->append (part.substr (0, count));
+			part.remove_prefix (count);
+		}
+	}
+	if (!chunk->empty ())
+		text.chunks.emplace_back (std::move (chunk));
+	updateStarts (0);
+	++text.version;
+	valid = true;
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::insert (size_t position, const char* data, size_t count)
+{
+	if (!valid || count == 0)
+		return;
+	if (position > text.length)
+	{
+		valid = false;
+		return;
+	}
+	// the cached snapshot would keep all chunks shared
+	last = nullptr;
+	if (text.chunks.empty ())
+	{
+		text.chunks.emplace_back (std::make_shared<std::string> ());
+		text.starts.emplace_back (0);
+	}
+	auto index = text.chunkIndex (position);
+	auto offset = position - text.starts[index];
+	writableChunk (index).insert (offset, data, count);
+	if (text.chunks[index]->size () > MaxChunkSize)
+		split (index);
+	text.length += count;
+	updateStarts (index);
+	++text.version;
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::remove (size_t position, size_t count)
+{
+	if (!valid || count == 0)
+		return;
+	if (position + count > text.length)
+	{
+		valid = false;
+		return;
+	}
+	last = nullptr;
+	auto end = position + count;
+	auto first = text.chunkIndex (position);
+	auto index = first;
+	// the starts are updated after all chunks are changed, so they refer to the old text here
+	while (index < text.chunks.size () && text.starts[index] < end)
+	{
+		auto chunkStart = text.starts[index];
+		auto chunkSize = text.chunks[index]->size ();
+		auto from = std::max (position, chunkStart) - chunkStart;
+		auto to = std::min (end, chunkStart + chunkSize) - chunkStart;
+		if (from == 0 && to == chunkSize)
+		{
+			// chunks which are removed completely are not copied
+			text.chunks.erase (text.chunks.begin () + index);
+			text.starts.erase (text.starts.begin () + index);
+			continue;
+		}
+		writableChunk (index).erase (from, to - from);
+		++index;
+	}
+	text.length -= count;
+	// only the first and the last affected chunk were shortened
+	if (first + 1 < text.chunks.size () && text.chunks[first + 1]->size () < MinChunkSize)
+		merge (first + 1);
+	if (first < text.chunks.size () && text.chunks[first]->size () < MinChunkSize)
+		merge (first);
+	updateStarts (first > 0 ? first - 1 : 0);
+	++text.version;
+}
+
+//------------------------------------------------------------------------
+std::shared_ptr<const DocumentSnapshot> DocumentSnapshotTracker::snapshot ()
+{
+	if (!valid)
+		return nullptr;
+	if (!last)
+		last = std::make_shared<const DocumentSnapshot> (text);
+	return last;
+}
+
+//------------------------------------------------------------------------
+std::string& DocumentSnapshotTracker::writableChunk (size_t index)
+{
+	auto& chunk = text.chunks[index];
+	if (chunk.use_count () == 1)
+	{
+		// synchronizes with the release of the last snapshot which shared the chunk
+		std::atomic_thread_fence (std::memory_order_acquire);
+		// all chunks are created as non const strings by the tracker
+		return const_cast<std::string&> (*chunk);
+	}
+	auto copy = std::make_shared<std::string> (*chunk);
+	auto& result = *copy;
+	chunk = std::move (copy);
+	return result;
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::split (size_t index)
+{
+	std::string_view chunk (*text.chunks[index]);
+	auto numParts = (chunk.size () + ChunkSize - 1) / ChunkSize;
+	auto partSize = (chunk.size () + numParts - 1) / numParts;
+	std::vector<DocumentSnapshot::Chunk> parts;
+	parts.reserve (numParts);
+	for (size_t offset = 0; offset < chunk.size (); offset += partSize)
+		parts.emplace_back (std::make_shared<std::string> (chunk.substr (offset, partSize)));
+	text.chunks.erase (text.chunks.begin () + index);
+	text.chunks.insert (text.chunks.begin () + index, parts.begin (), parts.end ());
+	text.starts.resize (text.chunks.size ());
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::merge (size_t index)
+{
+	if (text.chunks.size () < 2)
+	{
+		if (!text.chunks.empty () && text.chunks[0]->empty ())
+		{
+			text.chunks.clear ();
+			text.starts.clear ();
+		}
+		return;
+	}
+	// merge with the smaller neighbour
+	auto left = index;
+	if (index + 1 == text.chunks.size () ||
+	    (index > 0 && text.chunks[index - 1]->size () < text.chunks[index + 1]->size ()))
+		left = index - 1;
+	auto& chunk = writableChunk (left);
+	chunk.append (*text.chunks[left + 1]);
+	text.chunks.erase (text.chunks.begin () + left + 1);
+	text.starts.erase (text.starts.begin () + left + 1);
+	if (chunk.size () > MaxChunkSize)
+		split (left);
+}
+
+//------------------------------------------------------------------------
+void DocumentSnapshotTracker::updateStarts (size_t fromIndex)
+{
+	text.starts.resize (text.chunks.size ());
+	auto position = fromIndex > 0 && fromIndex <= text.chunks.size ()
+	                    ? text.starts[fromIndex - 1] + text.chunks[fromIndex - 1]->size ()
+	                    : 0;
+	for (auto index = fromIndex; index < text.chunks.size (); ++index)
+	{
+		text.starts[index] = position;
+		position += text.chunks[index]->size ();
+	}
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,123 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** An immutable copy of the text of a document.
+ *
+ *	The text is stored in chunks which are shared with the tracker that created the snapshot and
+ *	with other snapshots, so creating a snapshot does not copy the text. A snapshot never changes
+ *	and can be read from any thread.
+ */
+class DocumentSnapshot
+{
+public:
+	using Chunk = std::shared_ptr<const std::string>;
+
+	/** increases with every modification of the document */
+	[[nodiscard]] uint64_t getVersion () const { return version; }
+	[[nodiscard]] size_t size () const { return length; }
+	[[nodiscard]] bool empty () const { return length == 0; }
+	[[nodiscard]] const std::vector<Chunk>& getChunks () const { return chunks; }
+
+	/** call proc with every chunk of the text in order */
+	template <typename Proc>
+	void forEach (Proc proc) const
+	{
+		for (const auto& chunk : chunks)
+			proc (std::string_view (*chunk));
+	}
+	/** call proc with the parts of the text in the range [start, start + count) */
+	template <typename Proc>
+	void forEach (size_t start, size_t count, Proc proc) const;
+
+	/** copy the whole text */
+	[[nodiscard]] std::string getText () const;
+	/** copy count bytes starting at start, both are clamped to the text */
+	[[nodiscard]] std::string getText (size_t start, size_t count) const;
+	[[nodiscard]] char at (size_t position) const;
+
+private:
+	friend class DocumentSnapshotTracker;
+
+	/** the index of the chunk containing position */
+	size_t chunkIndex (size_t position) const;
+
+	std::vector<Chunk> chunks;
+	/** the position of the first byte of each chunk */
+	std::vector<size_t> starts;
+	size_t length {0};
+	uint64_t version {0};
+};
+
+//------------------------------------------------------------------------
+/** keeps a chunked copy of a document in sync with its modifications.
+ *
+ *	A chunk which is not referenced by a snapshot is modified in place, otherwise it is copied
+ *	on write. Chunks are kept between MinChunkSize and MaxChunkSize bytes, so an edit copies at
+ *	most one or two chunks and creating a snapshot only copies the list of chunks.
+ */
+class DocumentSnapshotTracker
+{
+public:
+	static constexpr size_t ChunkSize = 64 * 1024;
+	static constexpr size_t MaxChunkSize = 2 * ChunkSize;
+	static constexpr size_t MinChunkSize = ChunkSize / 4;
+
+	/** replace the text, the parts are concatenated */
+	void reset (std::string_view first, std::string_view second = {});
+	void insert (size_t position, const char* text, size_t count);
+	void remove (size_t position, size_t count);
+
+	/** mark the copy as out of sync with the document, for example after the document was
+	 *	switched. The owner has to reset the tracker before the next snapshot.
+	 */
+	void invalidate () { valid = false; }
+	[[nodiscard]] bool isValid () const { return valid; }
+	[[nodiscard]] size_t size () const { return text.length; }
+	[[nodiscard]] uint64_t getVersion () const { return text.version; }
+
+	/** get a snapshot of the current text, unchanged text returns the same snapshot */
+	std::shared_ptr<const DocumentSnapshot> snapshot ();
+
+private:
+	std::string& writableChunk (size_t index);
+	void split (size_t index);
+	void merge (size_t index);
+	void updateStarts (size_t fromIndex);
+
+	DocumentSnapshot text;
+	std::shared_ptr<const DocumentSnapshot> last;
+	bool valid {false};
+};
+
+//------------------------------------------------------------------------
+template <typename Proc>
+void DocumentSnapshot::forEach (size_t start, size_t count, Proc proc) const
+{
+	if (start >= length)
+		return;
+	auto end = start + std::min (count, length - start);
+	for (auto index = chunkIndex (start); index < chunks.size () && starts[index] < end; ++index)
+	{
+		std::string_view chunk (*chunks[index]);
+		auto from = start > starts[index] ? start - starts[index] : 0;
+		auto to = std::min (chunk.size (), end - starts[index]);
+		proc (chunk.substr (from, to - from));
+	}
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
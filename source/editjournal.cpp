@@ -0,0 +1,403 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "editjournal.h"
+
+#include "Scintilla.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+constexpr char JournalMagic[4] = {'S', 'E', 'J', '1'};
+constexpr char CheckpointMagic[4] = {'S', 'E', 'C', '1'};
+constexpr char InsertRecord = 'I';
+constexpr char DeleteRecord = 'D';
+
+#if defined(_WIN32)
+//------------------------------------------------------------------------
+std::wstring toWide (const std::string& str)
+{
+	auto numChars = MultiByteToWideChar (CP_UTF8, 0, str.data (), -1, nullptr, 0);
+	std::wstring result (static_cast<size_t> (numChars > 0 ? numChars : 1), L'\0');
+	MultiByteToWideChar (CP_UTF8, 0, str.data (), -1, result.data (), numChars);
+	return result;
+}
+#endif
+
+//------------------------------------------------------------------------
+FILE* openFile (const std::string& path, const char* mode)
+{
+#if defined(_WIN32)
+	return _wfopen (toWide (path).data (), toWide (mode).data ());
+#else
+	return fopen (path.data (), mode);
+#endif
+}
+
+//------------------------------------------------------------------------
+bool replaceFile (const std::string& from, const std::string& to)
+{
+#if defined(_WIN32)
+	return MoveFileExW (toWide (from).data (), toWide (to).data (), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename (from.data (), to.data ()) == 0;
+#endif
+}
+
+//------------------------------------------------------------------------
+void removeFile (const std::string& path)
+{
+#if defined(_WIN32)
+	DeleteFileW (toWide (path).data ());
+#else
+	remove (path.data ());
+#endif
+}
+
+//------------------------------------------------------------------------
+void appendVarInt (std::string& out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back (static_cast<char> ((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back (static_cast<char> (value));
+}
+
+//------------------------------------------------------------------------
+bool readVarInt (const std::string& in, size_t& pos, uint64_t& value)
+{
+	value = 0;
+	for (uint32_t shift = 0; pos < in.size () && shift < 64; shift += 7)
+	{
+		auto byte = static_cast<uint8_t> (in[pos++]);
+		value |= static_cast<uint64_t> (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+void appendUInt64 (std::string& out, uint64_t value)
+{
+	for (auto i = 0; i < 8; ++i)
+		out.push_back (static_cast<char> ((value >> (i * 8)) & 0xFF));
+}
+
+//------------------------------------------------------------------------
+bool readUInt64 (const std::string& in, size_t& pos, uint64_t& value)
+{
+	if (in.size () < pos + 8)
+		return false;
+	value = 0;
+	for (auto i = 0; i < 8; ++i)
+		value |= static_cast<uint64_t> (static_cast<uint8_t> (in[pos++])) << (i * 8);
+	return true;
+}
+
+//------------------------------------------------------------------------
+bool readFile (const std::string& path, std::string& content)
+{
+	auto file = openFile (path, "rb");
+	if (!file)
+		return false;
+	content.clear ();
+	char buffer[64 * 1024];
+	size_t numRead;
+	while ((numRead = fread (buffer, 1, sizeof (buffer), file)) > 0)
+		content.append (buffer, numRead);
+	fclose (file);
+	return true;
+}
+
+//------------------------------------------------------------------------
+std::string makeHeader (const char (&magic)[4], uint64_t generation)
+{
+	std::string header (magic, 4);
+	appendUInt64 (header, generation);
+	return header;
+}
+
+//------------------------------------------------------------------------
+bool readHeader (const std::string& in, const char (&magic)[4], uint64_t& generation)
+{
+	size_t pos = 4;
+	return in.compare (0, 4, magic, 4) == 0 && readUInt64 (in, pos, generation);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+EditJournal::EditJournal (const std::string& path)
+: journalPath (path), checkpointPath (path + ".checkpoint")
+{
+}
+
+//------------------------------------------------------------------------
+EditJournal::~EditJournal () noexcept
+{
+	detach ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::attach (ScintillaEditorView* inView)
+{
+	detach ();
+	view = inView;
+	// only text changes are journaled
+	view->registerListener (this, {{SCN_MODIFIED}, SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT});
+	startWriter ();
+	checkpoint ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::detach ()
+{
+	if (!view)
+		return;
+	view->unregisterListener (this);
+	view = nullptr;
+	stopWriter ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::discard ()
+{
+	detach ();
+	removeFile (journalPath);
+	removeFile (checkpointPath);
+}
+
+//------------------------------------------------------------------------
+void EditJournal::checkpoint ()
+{
+	if (!view)
+		return;
+	auto cp = std::make_unique<Checkpoint> ();
+	cp->generation = ++generation;
+	// the view handles its modifications before the journal, so the snapshot contains the
+	// modification which triggered the checkpoint
+	cp->snapshot = view->createSnapshot ();
+	journalBytes = 0;
+
+	std::lock_guard<std::mutex> guard (mutex);
+	// records which are not written yet are part of the checkpoint
+	pendingRecords.clear ();
+	pendingCheckpoint = std::move (cp);
+	condition.notify_one ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::onScintillaNotification (SCNotification* notification)
+{
+	if (notification->nmhdr.code != SCN_MODIFIED)
+		return;
+	if (notification->modificationType & SC_MOD_INSERTTEXT)
+		appendRecord (InsertRecord, notification->position, notification->length,
+		              notification->text);
+	else if (notification->modificationType & SC_MOD_DELETETEXT)
+		appendRecord (DeleteRecord, notification->position, notification->length, nullptr);
+	else
+		return;
+	if (journalBytes > checkpointThreshold)
+		checkpoint ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::onScintillaLoadFinished (ScintillaEditorView*, const ScintillaLoadResult& result)
+{
+	// the document was exchanged without any modification notifications
+	if (result.success)
+		checkpoint ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::onScintillaDocumentChanged (ScintillaEditorView*)
+{
+	// the journal belongs to the text of the previous document
+	checkpoint ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::appendRecord (char type, int64_t position, int64_t length, const char* text)
+{
+	std::lock_guard<std::mutex> guard (mutex);
+	auto start = pendingRecords.size ();
+	pendingRecords.push_back (type);
+	appendVarInt (pendingRecords, static_cast<uint64_t> (position));
+	appendVarInt (pendingRecords, static_cast<uint64_t> (length));
+	if (text)
+		pendingRecords.append (text, static_cast<size_t> (length));
+	journalBytes += pendingRecords.size () - start;
+	condition.notify_one ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::startWriter ()
+{
+	stopRequested = false;
+	writer = std::thread ([this] () { writerLoop (); });
+}
+
+//------------------------------------------------------------------------
+void EditJournal::stopWriter ()
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		stopRequested = true;
+		condition.notify_one ();
+	}
+	if (writer.joinable ())
+		writer.join ();
+	if (journalFile)
+	{
+		fclose (journalFile);
+		journalFile = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------
+void EditJournal::writerLoop ()
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	while (true)
+	{
+		condition.wait (lock, [this] () {
+			return stopRequested || pendingCheckpoint || !pendingRecords.empty ();
+		});
+		auto cp = std::move (pendingCheckpoint);
+		std::string records;
+		records.swap (pendingRecords);
+		auto stop = stopRequested;
+		lock.unlock ();
+
+		if (cp)
+			writeCheckpoint (*cp);
+		if (!records.empty () && journalFile)
+		{
+			if (fwrite (records.data (), 1, records.size (), journalFile) != records.size () ||
+			    fflush (journalFile) != 0)
+				abandonJournal ();
+		}
+
+		lock.lock ();
+		if (stop && !pendingCheckpoint && pendingRecords.empty ())
+			break;
+	}
+}
+
+//------------------------------------------------------------------------
+void EditJournal::writeCheckpoint (const Checkpoint& cp)
+{
+	// the journal of the previous generation is only valid together with the previous
+	// checkpoint, so a crash between the two steps below is detected by recover ()
+	auto tmpPath = checkpointPath + ".tmp";
+	auto file = openFile (tmpPath, "wb");
+	if (!file)
+	{
+		abandonJournal ();
+		return;
+	}
+	auto header = makeHeader (CheckpointMagic, cp.generation);
+	appendUInt64 (header, cp.snapshot->size ());
+	auto success = fwrite (header.data (), 1, header.size (), file) == header.size ();
+	cp.snapshot->forEach ([&] (std::string_view chunk) {
+		success = success && fwrite (chunk.data (), 1, chunk.size (), file) == chunk.size ();
+	});
+	success = (fclose (file) == 0) && success;
+	if (!success || !replaceFile (tmpPath, checkpointPath))
+	{
+		removeFile (tmpPath);
+		abandonJournal ();
+		return;
+	}
+
+	if (journalFile)
+		fclose (journalFile);
+	journalFile = openFile (journalPath, "wb");
+	if (!journalFile)
+	{
+		failed = true;
+		return;
+	}
+	header = makeHeader (JournalMagic, cp.generation);
+	if (fwrite (header.data (), 1, header.size (), journalFile) != header.size () ||
+	    fflush (journalFile) != 0)
+		abandonJournal ();
+}
+
+//------------------------------------------------------------------------
+void EditJournal::abandonJournal ()
+{
+	// the records of the checkpoint which could not be written are gone, later records would
+	// not fit the journal on disk anymore. An empty journal lets recover return the previous
+	// checkpoint, new records are dropped until a checkpoint succeeds.
+	failed = true;
+	if (journalFile)
+		fclose (journalFile);
+	journalFile = nullptr;
+	if (auto file = openFile (journalPath, "wb"))
+		fclose (file);
+}
+
+//------------------------------------------------------------------------
+bool EditJournal::recover (const std::string& path, std::string& text)
+{
+	std::string content;
+	if (!readFile (path + ".checkpoint", content))
+		return false;
+	uint64_t generation = 0;
+	uint64_t length = 0;
+	size_t pos = 12;
+	if (!readHeader (content, CheckpointMagic, generation) || !readUInt64 (content, pos, length))
+		return false;
+	if (content.size () - pos < length)
+		return false;
+	text.assign (content, pos, length);
+
+	uint64_t journalGeneration = 0;
+	if (!readFile (path, content) || !readHeader (content, JournalMagic, journalGeneration) ||
+	    journalGeneration != generation)
+		return true;
+
+	// the last record may be incomplete if the application crashed while writing it
+	pos = 12;
+	while (pos < content.size ())
+	{
+		auto type = content[pos++];
+		uint64_t position, size;
+		if (!readVarInt (content, pos, position) || !readVarInt (content, pos, size))
+			break;
+		if (type == InsertRecord)
+		{
+			if (content.size () - pos < size || position > text.size ())
+				break;
+			text.insert (position, content, pos, size);
+			pos += size;
+		}
+		else if (type == DeleteRecord)
+		{
+			if (position + size > text.size ())
+				break;
+			text.erase (position, size);
+		}
+		else
+			break;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
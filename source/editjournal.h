@@ -0,0 +1,94 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Append-only journal of the edits of a ScintillaEditorView for crash recovery.
+ *
+ *	Every insert and delete is appended as a small binary record to the journal file by a
+ *	background thread. When the journal grows beyond the checkpoint threshold the complete text is
+ *	written as a new checkpoint and the journal starts again. recover() rebuilds the text from the
+ *	last checkpoint and the journal. The view is checkpointed again when it shows another
+ *	document.
+ */
+class EditJournal : public IScintillaListener
+{
+public:
+	/** @param path UTF-8 path of the journal, the checkpoint is written next to it */
+	explicit EditJournal (const std::string& path);
+	~EditJournal () noexcept override;
+
+	/** start journaling the edits of view. A checkpoint of the current text is written first. */
+	void attach (ScintillaEditorView* view);
+	/** stop journaling, the files are kept */
+	void detach ();
+	/** write the current text as new checkpoint and start an empty journal */
+	void checkpoint ();
+	/** stop journaling and remove the files, call this after the text was saved elsewhere */
+	void discard ();
+
+	/** the journal is checkpointed when it grows beyond this size */
+	void setCheckpointThreshold (uint64_t bytes) { checkpointThreshold = bytes; }
+	/** true if writing one of the files failed. The journal is emptied then and edits are not
+	 *	journaled until the next checkpoint was written, recover returns the last checkpoint.
+	 */
+	[[nodiscard]] bool hasFailed () const { return failed; }
+
+	/** rebuild the text from the checkpoint and the journal at path.
+	 *	@return false if there is nothing to recover
+	 */
+	static bool recover (const std::string& path, std::string& text);
+
+private:
+	struct Checkpoint
+	{
+		uint64_t generation;
+		std::shared_ptr<const DocumentSnapshot> snapshot;
+	};
+
+	void onScintillaNotification (SCNotification* notification) override;
+	void onScintillaLoadFinished (ScintillaEditorView* view,
+	                              const ScintillaLoadResult& result) override;
+	void onScintillaDocumentChanged (ScintillaEditorView* view) override;
+
+	void appendRecord (char type, int64_t position, int64_t length, const char* text);
+	void startWriter ();
+	void stopWriter ();
+	void writerLoop ();
+	void writeCheckpoint (const Checkpoint& checkpoint);
+	void abandonJournal ();
+
+	std::string journalPath;
+	std::string checkpointPath;
+	ScintillaEditorView* view {nullptr};
+	uint64_t generation {0};
+	uint64_t journalBytes {0};
+	uint64_t checkpointThreshold {4 * 1024 * 1024};
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::string pendingRecords;
+	std::unique_ptr<Checkpoint> pendingCheckpoint;
+	bool stopRequested {false};
+	FILE* journalFile {nullptr};
+	std::atomic<bool> failed {false};
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,211 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "incrementalsearch.h"
+#include "vstgui/lib/cvstguitimer.h"
+
+#include "Scintilla.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+constexpr uint32_t SupportedFlags = ScintillaEditorView::MatchCase | ScintillaEditorView::WholeWord |
+                                    ScintillaEditorView::WordStart |
+                                    ScintillaEditorView::RegularExpression;
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+IncrementalSearch::IncrementalSearch (ScintillaEditorView* view) : view (view)
+{
+	view->registerListener (this, {{SCN_MODIFIED}, SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT});
+}
+
+//------------------------------------------------------------------------
+IncrementalSearch::~IncrementalSearch () noexcept
+{
+	if (timer)
+		timer->stop ();
+	view->unregisterListener (this);
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::setQuery (const std::string& newQuery, uint32_t searchFlags)
+{
+	searchFlags &= SupportedFlags;
+	if (search && newQuery == query && searchFlags == flags)
+		return;
+
+	// the matches of a longer query are a subset of the matches of the shorter one, unless
+	// matches can overlap (then a skipped position may match now) or whole words are searched
+	auto extends = search && !pending && search->isSupported () && !search->canOverlap () &&
+	               searchFlags == flags && !(flags & ScintillaEditorView::WholeWord) &&
+	               newQuery.size () > query.size () && newQuery.compare (0, query.size (), query) == 0;
+
+	query = newQuery;
+	flags = searchFlags;
+	search.emplace (query, flags);
+	if (flags & (ScintillaEditorView::WholeWord | ScintillaEditorView::WordStart))
+		search->setCharClasses (view->getWordChars (), view->getWhitespaceChars (),
+		                        view->getPunctuationChars ());
+
+	if (query.empty ())
+	{
+		if (timer)
+			timer->stop ();
+		pending = false;
+		matches.clear ();
+		changed ();
+		return;
+	}
+	if (extends && search->isSupported ())
+	{
+		if (timer)
+			timer->stop ();
+		auto text = view->getTextView ();
+		auto length = static_cast<int64_t> (query.size ());
+		matches.erase (std::remove_if (matches.begin (), matches.end (),
+		                               [&] (const auto& match) {
+			                               return !search->matchesAt (text, match.start);
+		                               }),
+		               matches.end ());
+		for (auto& match : matches)
+			match.end = match.start + length;
+		changed ();
+		return;
+	}
+	scheduleScan ();
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::flush ()
+{
+	if (pending)
+		scan ();
+}
+
+//------------------------------------------------------------------------
+int64_t IncrementalSearch::nextMatch (int64_t position) const
+{
+	auto it = std::lower_bound (matches.begin (), matches.end (), position,
+	                            [] (const auto& match, auto pos) { return match.start < pos; });
+	return it == matches.end () ? -1 : static_cast<int64_t> (it - matches.begin ());
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::scheduleScan ()
+{
+	pending = true;
+	notifyScan = true;
+	if (view->getTextView ().size () <= debounceThreshold)
+	{
+		scan ();
+		return;
+	}
+	startTimer ();
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::startTimer ()
+{
+	// a view which is not attached has no timers, its scan is run by flush
+	if (!view->isAttached ())
+		return;
+	if (!timer)
+		timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) { flush (); }, DebounceTime, false);
+	// every change starts the delay again
+	timer->stop ();
+	timer->start ();
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::scan ()
+{
+	if (timer)
+		timer->stop ();
+	pending = false;
+	matches = view->findAll (query.data (), flags);
+	if (std::exchange (notifyScan, false))
+		changed ();
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::update (int64_t position, int64_t inserted, int64_t deleted)
+{
+	if (!search->isSupported ())
+	{
+		// the query can not be searched around the change, the document is scanned again when
+		// the edits paused instead of inside the notification, and silently like other edits
+		pending = true;
+		startTimer ();
+		return;
+	}
+	// remove the matches touching the changed range and move the following ones
+	auto changedEnd = position + deleted;
+	auto first = std::lower_bound (matches.begin (), matches.end (), position,
+	                               [] (const auto& match, auto pos) { return match.end < pos; });
+	auto last = first;
+	while (last != matches.end () && last->start <= changedEnd)
+		++last;
+	auto delta = inserted - deleted;
+	for (auto it = last; it != matches.end (); ++it)
+	{
+		it->start += delta;
+		it->end += delta;
+	}
+	auto it = matches.erase (first, last);
+
+	// and search again around the change, without overlapping the kept matches
+	auto length = static_cast<int64_t> (query.size ());
+	auto from = std::max<int64_t> (position - length, 0);
+	if (it != matches.begin ())
+		from = std::max (from, std::prev (it)->end);
+	auto to = position + inserted + length;
+	auto limit = it != matches.end () ? it->start : std::numeric_limits<int64_t>::max ();
+	std::vector<Range> found;
+	search->findAll (view->getTextView (), from, to, found);
+	found.erase (std::remove_if (found.begin (), found.end (),
+	                             [&] (const auto& match) { return match.end > limit; }),
+	             found.end ());
+	matches.insert (it, found.begin (), found.end ());
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::changed ()
+{
+	if (onChanged)
+		onChanged (*this);
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::onScintillaNotification (SCNotification* notification)
+{
+	if (!search || query.empty () || pending)
+		return;
+	if (notification->modificationType & SC_MOD_INSERTTEXT)
+		update (notification->position, notification->length, 0);
+	else if (notification->modificationType & SC_MOD_DELETETEXT)
+		update (notification->position, 0, notification->length);
+}
+
+//------------------------------------------------------------------------
+void IncrementalSearch::onScintillaLoadFinished (ScintillaEditorView*,
+                                                 const ScintillaLoadResult& result)
+{
+	// the document was exchanged without modification notifications
+	if (result.success && search && !query.empty ())
+		scheduleScan ();
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,91 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+#include "textsearch.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+class CVSTGUITimer;
+
+//------------------------------------------------------------------------
+/** Search as you type for a ScintillaEditorView.
+ *
+ *	The matches of the current query are kept up to date. If the query is extended the known
+ *	matches are filtered instead of scanning the document again, and edits of the document only
+ *	remove and search again the matches around the changed range. Documents larger than the
+ *	debounce threshold are only scanned when the query did not change for a short time.
+ *
+ *	The view must outlive the search.
+ */
+class IncrementalSearch : public IScintillaListener
+{
+public:
+	using Range = ScintillaEditorView::Range;
+	using Callback = std::function<void (const IncrementalSearch&)>;
+
+	/** time without query changes before a large document is scanned */
+	static constexpr uint32_t DebounceTime = 150;
+
+	explicit IncrementalSearch (ScintillaEditorView* view);
+	~IncrementalSearch () noexcept override;
+
+	/** set the query
+	 *	@param query string to find, the matches are cleared if empty
+	 *	@param searchFlags MatchCase, WholeWord, WordStart and RegularExpression of
+	 *	ScintillaEditorView::SearchFlags
+	 */
+	void setQuery (const std::string& query, uint32_t searchFlags);
+	/** called when the matches of a new query are known. Edits of the document update the
+	 *	matches silently, for queries which can not be updated around an edit the document is
+	 *	scanned again after the debounce time.
+	 */
+	void setCallback (Callback&& callback) { onChanged = std::move (callback); }
+	/** documents larger than this are scanned delayed, the default is 4 MB */
+	void setDebounceThreshold (size_t bytes) { debounceThreshold = bytes; }
+	/** run a delayed scan now. The scan of a view which is not attached is only run by this. */
+	void flush ();
+
+	[[nodiscard]] const std::string& getQuery () const { return query; }
+	/** the matches in document order */
+	[[nodiscard]] const std::vector<Range>& getMatches () const { return matches; }
+	/** true while a delayed scan is pending, the matches belong to a previous query then */
+	[[nodiscard]] bool isPending () const { return pending; }
+	/** the index of the first match starting at or after position, or -1 */
+	[[nodiscard]] int64_t nextMatch (int64_t position) const;
+
+private:
+	void onScintillaNotification (SCNotification* notification) override;
+	void onScintillaLoadFinished (ScintillaEditorView* view,
+	                              const ScintillaLoadResult& result) override;
+
+	void scheduleScan ();
+	void startTimer ();
+	void scan ();
+	void update (int64_t position, int64_t inserted, int64_t deleted);
+	void changed ();
+
+	ScintillaEditorView* view;
+	std::optional<TextSearch> search;
+	std::string query;
+	uint32_t flags {0};
+	std::vector<Range> matches;
+	bool pending {false};
+	/** the pending scan belongs to a new query and not only to edits */
+	bool notifyScan {false};
+	size_t debounceThreshold {4 * 1024 * 1024};
+	SharedPointer<CVSTGUITimer> timer;
+	Callback onChanged;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
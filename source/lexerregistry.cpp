@@ -0,0 +1,174 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "lexerregistry.h"
+#include "scintillaeditorview.h"
+
+#include "ILexer.h"
+
+#include <cctype>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** join the words with single spaces, so that setting the same list again is detected early */
+std::string normalizeWords (const std::string& words)
+{
+	std::string result;
+	result.reserve (words.size ());
+	for (auto c : words)
+	{
+		if (std::isspace (static_cast<unsigned char> (c)))
+		{
+			if (!result.empty () && result.back () != ' ')
+				result += ' ';
+		}
+		else
+			result += c;
+	}
+	if (!result.empty () && result.back () == ' ')
+		result.pop_back ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+struct LexerRegistry::Entry
+{
+	explicit Entry (Config&& inConfig) : config (std::move (inConfig)) {}
+	~Entry () noexcept
+	{
+		for (auto lexer : idle)
+			lexer->Release ();
+	}
+
+	/** applying an unchanged word list or property to a reused lexer does not rebuild it */
+	void configure (Scintilla::ILexer5& lexer) const
+	{
+		for (const auto& [index, words] : config.keywords)
+			lexer.WordListSet (index, words.data ());
+		for (const auto& [key, value] : config.properties)
+			lexer.PropertySet (key.data (), value.data ());
+	}
+
+	Scintilla::ILexer5* takeIdle ()
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		if (idle.empty ())
+			return nullptr;
+		auto lexer = idle.back ();
+		idle.pop_back ();
+		return lexer;
+	}
+
+	bool recycle (Scintilla::ILexer5* lexer)
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		if (idle.size () >= MaxIdleLexers)
+			return false;
+		idle.emplace_back (lexer);
+		return true;
+	}
+
+	const Config config;
+	mutable std::mutex mutex;
+	std::vector<Scintilla::ILexer5*> idle;
+};
+
+//------------------------------------------------------------------------
+LexerRegistry::LexerRegistry ()
+{
+	// resolve lexilla before the registry is complete, so that the library is unloaded after the
+	// idle lexers are released
+	ScintillaEditorView::createLexer ("");
+}
+
+//------------------------------------------------------------------------
+LexerRegistry& LexerRegistry::instance ()
+{
+	static LexerRegistry registry;
+	return registry;
+}
+
+//------------------------------------------------------------------------
+void LexerRegistry::add (const std::string& name, Config config)
+{
+	for (auto& [index, words] : config.keywords)
+		words = normalizeWords (words);
+	auto entry = std::make_shared<Entry> (std::move (config));
+	std::lock_guard<std::mutex> guard (mutex);
+	entries[name] = std::move (entry);
+}
+
+//------------------------------------------------------------------------
+void LexerRegistry::remove (const std::string& name)
+{
+	std::lock_guard<std::mutex> guard (mutex);
+	entries.erase (name);
+}
+
+//------------------------------------------------------------------------
+bool LexerRegistry::contains (const std::string& name) const
+{
+	return find (name) != nullptr;
+}
+
+//------------------------------------------------------------------------
+auto LexerRegistry::find (const std::string& name) const -> std::shared_ptr<Entry>
+{
+	std::lock_guard<std::mutex> guard (mutex);
+	auto it = entries.find (name);
+	return it != entries.end () ? it->second : nullptr;
+}
+
+//------------------------------------------------------------------------
+std::shared_ptr<Scintilla::ILexer5> LexerRegistry::create (const std::string& name)
+{
+	auto entry = find (name);
+	if (!entry)
+		return nullptr;
+	auto lexer = entry->takeIdle ();
+	if (!lexer)
+		lexer = ScintillaEditorView::createLexer (entry->config.lexerName.data ());
+	if (!lexer)
+		return nullptr;
+	entry->configure (*lexer);
+	// the lexer goes back to its entry as long as the configuration was not replaced
+	std::weak_ptr<Entry> weakEntry (entry);
+	return std::shared_ptr<Scintilla::ILexer5> (lexer, [weakEntry] (auto released) {
+		auto owner = weakEntry.lock ();
+		if (!owner || !owner->recycle (released))
+			released->Release ();
+	});
+}
+
+//------------------------------------------------------------------------
+bool LexerRegistry::applyStyles (const std::string& name, ScintillaTheme& theme) const
+{
+	auto entry = find (name);
+	if (!entry)
+		return false;
+	for (const auto& [index, style] : entry->config.styles)
+		theme.setStyle (index, style);
+	return true;
+}
+
+//------------------------------------------------------------------------
+size_t LexerRegistry::getNumIdleLexers (const std::string& name) const
+{
+	auto entry = find (name);
+	if (!entry)
+		return 0;
+	std::lock_guard<std::mutex> guard (entry->mutex);
+	return entry->idle.size ();
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,78 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillatheme.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Scintilla {
+class ILexer5;
+}
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Named lexer configurations shared by all views of the process.
+ *
+ *	A configuration is prepared once when it is added. Lexers created for it are configured
+ *	before they are returned and go back to an idle list of the configuration when their last
+ *	user releases them, so views which are created and destroyed constantly reuse the same few
+ *	lexers instead of building their word lists again.
+ */
+class LexerRegistry
+{
+public:
+	struct Config
+	{
+		/** the name of the lexer in lexilla, for example "cpp" */
+		std::string lexerName;
+		/** the word lists by their index, the words are separated by white space */
+		std::map<int, std::string> keywords;
+		std::map<std::string, std::string> properties;
+		/** the styles of the lexer, see applyStyles */
+		ScintillaTheme::StyleMap styles;
+	};
+
+	static constexpr size_t MaxIdleLexers = 8;
+
+	static LexerRegistry& instance ();
+
+	/** add a configuration, a configuration with the same name is replaced. Lexers which were
+	 *	created for the old configuration are released instead of being reused.
+	 */
+	void add (const std::string& name, Config config);
+	void remove (const std::string& name);
+	[[nodiscard]] bool contains (const std::string& name) const;
+
+	/** get a configured lexer, or nullptr if the configuration or the lexer does not exist.
+	 *	Properties which are not part of the configuration keep the values a previous user of a
+	 *	reused lexer gave them.
+	 */
+	std::shared_ptr<Scintilla::ILexer5> create (const std::string& name);
+	/** set the styles of a configuration in theme */
+	bool applyStyles (const std::string& name, ScintillaTheme& theme) const;
+	/** the number of lexers waiting to be reused */
+	[[nodiscard]] size_t getNumIdleLexers (const std::string& name) const;
+
+private:
+	struct Entry;
+
+	LexerRegistry ();
+
+	std::shared_ptr<Entry> find (const std::string& name) const;
+
+	mutable std::mutex mutex;
+	std::map<std::string, std::shared_ptr<Entry>> entries;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
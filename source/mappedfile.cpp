@@ -0,0 +1,108 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "mappedfile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <string>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+#if defined(_WIN32)
+
+//------------------------------------------------------------------------
+std::unique_ptr<MappedFile> MappedFile::open (const char* path)
+{
+	auto numChars = MultiByteToWideChar (CP_UTF8, 0, path, -1, nullptr, 0);
+	if (numChars <= 0)
+		return nullptr;
+	std::wstring widePath (static_cast<size_t> (numChars), L'\0');
+	MultiByteToWideChar (CP_UTF8, 0, path, -1, widePath.data (), numChars);
+
+	auto file = CreateFileW (widePath.data (), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	std::unique_ptr<MappedFile> result (new MappedFile ());
+	result->fileHandle = file;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx (file, &fileSize))
+		return nullptr;
+	if (fileSize.QuadPart == 0)
+		return result;
+	result->mappingHandle = CreateFileMappingW (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!result->mappingHandle)
+		return nullptr;
+	auto ptr = MapViewOfFile (result->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!ptr)
+		return nullptr;
+	result->ptr = static_cast<const char*> (ptr);
+	result->length = static_cast<size_t> (fileSize.QuadPart);
+	return result;
+}
+
+//------------------------------------------------------------------------
+MappedFile::~MappedFile () noexcept
+{
+	if (ptr)
+		UnmapViewOfFile (ptr);
+	if (mappingHandle)
+		CloseHandle (mappingHandle);
+	if (fileHandle)
+		CloseHandle (fileHandle);
+}
+
+#else
+
+//------------------------------------------------------------------------
+std::unique_ptr<MappedFile> MappedFile::open (const char* path)
+{
+	auto fd = ::open (path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return nullptr;
+	struct stat fileStat;
+	if (fstat (fd, &fileStat) != 0 || !S_ISREG (fileStat.st_mode))
+	{
+		close (fd);
+		return nullptr;
+	}
+	std::unique_ptr<MappedFile> result (new MappedFile ());
+	if (fileStat.st_size > 0)
+	{
+		auto size = static_cast<size_t> (fileStat.st_size);
+		auto ptr = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr == MAP_FAILED)
+		{
+			close (fd);
+			return nullptr;
+		}
+		// the mapping is read once from front to back
+		madvise (ptr, size, MADV_SEQUENTIAL);
+		result->ptr = static_cast<const char*> (ptr);
+		result->length = size;
+	}
+	// the mapping stays valid after the descriptor is closed
+	close (fd);
+	return result;
+}
+
+//------------------------------------------------------------------------
+MappedFile::~MappedFile () noexcept
+{
+	if (ptr)
+		munmap (const_cast<char*> (ptr), length);
+}
+
+#endif
+
+//------------------------------------------------------------------------
+} // VSTGUI
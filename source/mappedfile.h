@@ -0,0 +1,45 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** read-only memory mapping of a whole file */
+class MappedFile
+{
+public:
+	/** map the file at path (UTF-8).
+	 *	@return nullptr if the file could not be opened or mapped
+	 */
+	static std::unique_ptr<MappedFile> open (const char* path);
+
+	~MappedFile () noexcept;
+
+	[[nodiscard]] const char* data () const { return ptr; }
+	[[nodiscard]] size_t size () const { return length; }
+	[[nodiscard]] std::string_view view () const { return {ptr, length}; }
+
+	MappedFile (const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+
+private:
+	MappedFile () = default;
+
+	const char* ptr {nullptr};
+	size_t length {0};
+#if defined(_WIN32)
+	void* fileHandle {nullptr};
+	void* mappingHandle {nullptr};
+#endif
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,188 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "multidocumentsearch.h"
+#include "regexsearch.h"
+#include "textsearch.h"
+#include "threadpool.h"
+#include "vstgui/lib/cvstguitimer.h"
+
+#include <atomic>
+#include <mutex>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** about one frame */
+constexpr uint32_t DeliveryInterval = 16;
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+struct MultiDocumentSearch::State
+{
+	struct Result
+	{
+		size_t index;
+		std::vector<Range> matches;
+	};
+
+	std::atomic<bool> cancelled {false};
+	std::atomic<size_t> remaining {0};
+	size_t numMatches {0};
+
+	std::mutex mutex;
+	std::vector<Result> results;
+	/** documents which scintilla must search itself on the UI thread */
+	std::vector<size_t> fallbacks;
+
+	void add (size_t index, std::vector<Range>&& matches)
+	{
+		if (!matches.empty ())
+		{
+			std::lock_guard<std::mutex> guard (mutex);
+			results.push_back ({index, std::move (matches)});
+		}
+		--remaining;
+	}
+};
+
+//------------------------------------------------------------------------
+MultiDocumentSearch::MultiDocumentSearch (bool useTimer) : useTimer (useTimer) {}
+
+//------------------------------------------------------------------------
+MultiDocumentSearch::~MultiDocumentSearch () noexcept
+{
+	cancel ();
+}
+
+//------------------------------------------------------------------------
+void MultiDocumentSearch::start (const std::vector<ScintillaEditorView*>& searchViews,
+                                 const std::string& searchQuery, uint32_t flags,
+                                 ResultFunc&& resultFunc, DoneFunc&& doneFunc)
+{
+	cancel ();
+	onResult = std::move (resultFunc);
+	onDone = std::move (doneFunc);
+	query = searchQuery;
+	searchFlags = flags;
+	state = std::make_shared<State> ();
+	state->remaining = searchViews.size ();
+
+	for (size_t index = 0; index < searchViews.size (); ++index)
+	{
+		auto view = searchViews[index];
+		views.emplace_back (view);
+
+		if (flags & ScintillaEditorView::RegularExpression)
+		{
+			auto snapshot = view->createSnapshot ();
+			ThreadPool::shared ().post (
+			    [shared = state, index, snapshot, query = query, flags] () {
+				    if (shared->cancelled)
+					    return;
+				    auto text = snapshot->getText ();
+				    std::vector<Range> matches;
+				    // the documents are already searched in parallel, a task must not start
+				    // more threads
+				    RegexSearch (query, flags).findAllOnCallingThread ({text, {}}, matches);
+				    shared->add (index, std::move (matches));
+			    });
+			continue;
+		}
+		TextSearch search (query, flags);
+		if (!search.isSupported ())
+		{
+			state->fallbacks.emplace_back (index);
+			continue;
+		}
+		if (flags & (ScintillaEditorView::WholeWord | ScintillaEditorView::WordStart))
+			search.setCharClasses (view->getWordChars (), view->getWhitespaceChars (),
+			                       view->getPunctuationChars ());
+		// the document may change meanwhile, the worker joins the chunks of the snapshot
+		auto snapshot = view->createSnapshot ();
+		ThreadPool::shared ().post (
+		    [shared = state, index, snapshot, search = std::move (search)] () {
+			    if (shared->cancelled)
+				    return;
+			    auto text = snapshot->getText ();
+			    std::vector<Range> matches;
+			    search.findAll ({text, {}}, matches);
+			    shared->add (index, std::move (matches));
+		    });
+	}
+
+	if (useTimer)
+	{
+		if (!timer)
+			timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) { poll (); },
+			                                 DeliveryInterval, false);
+		timer->start ();
+	}
+}
+
+//------------------------------------------------------------------------
+void MultiDocumentSearch::cancel ()
+{
+	if (timer)
+		timer->stop ();
+	if (!state)
+		return;
+	// the workers still hold the state and skip their tasks
+	state->cancelled = true;
+	state = nullptr;
+	views.clear ();
+}
+
+//------------------------------------------------------------------------
+bool MultiDocumentSearch::poll ()
+{
+	if (!state)
+		return true;
+	// keep the state if a callback cancels the search
+	auto current = state;
+
+	std::vector<State::Result> results;
+	{
+		std::lock_guard<std::mutex> guard (current->mutex);
+		results.swap (current->results);
+	}
+	// one document per call is searched by scintilla, its search needs the UI thread
+	if (!current->fallbacks.empty ())
+	{
+		auto index = current->fallbacks.back ();
+		current->fallbacks.pop_back ();
+		auto matches = views[index]->findAll (query.data (), searchFlags);
+		current->add (index, std::move (matches));
+	}
+	for (auto& result : results)
+	{
+		if (current->cancelled)
+			return true;
+		current->numMatches += result.matches.size ();
+		if (onResult)
+			onResult (views[result.index], std::move (result.matches));
+	}
+	if (current->cancelled || current->remaining > 0)
+		return current->cancelled;
+	{
+		std::lock_guard<std::mutex> guard (current->mutex);
+		if (!current->results.empty ())
+			return false;
+	}
+	auto numMatches = current->numMatches;
+	auto done = std::move (onDone);
+	cancel ();
+	if (done)
+		done (numMatches);
+	return true;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,71 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+class CVSTGUITimer;
+
+//------------------------------------------------------------------------
+/** Search the documents of many ScintillaEditorViews in parallel.
+ *
+ *	A snapshot of every document is taken when the search starts, the snapshots are
+ *	searched on the shared ThreadPool and the matches are delivered back on the UI thread as soon
+ *	as a document is done. The views are kept alive until the search ended.
+ */
+class MultiDocumentSearch
+{
+public:
+	using Range = ScintillaEditorView::Range;
+	/** called on the UI thread for every document with at least one match */
+	using ResultFunc = std::function<void (ScintillaEditorView* view, std::vector<Range>&& matches)>;
+	/** called on the UI thread when all documents were searched */
+	using DoneFunc = std::function<void (size_t numMatches)>;
+
+	/** @param useTimer deliver the results on a timer, without it poll must be called */
+	explicit MultiDocumentSearch (bool useTimer = true);
+	/** cancels the search */
+	~MultiDocumentSearch () noexcept;
+
+	/** start searching, a running search is cancelled
+	 *	@param views the views whose documents are searched
+	 *	@param query string to find
+	 *	@param searchFlags MatchCase, WholeWord, WordStart and RegularExpression
+	 */
+	void start (const std::vector<ScintillaEditorView*>& views, const std::string& query,
+	            uint32_t searchFlags, ResultFunc&& onResult, DoneFunc&& onDone);
+	/** stop the search, no callbacks are called afterwards */
+	void cancel ();
+	[[nodiscard]] bool isRunning () const { return state != nullptr; }
+
+	/** deliver the results found so far
+	 *	@return true when the search is finished
+	 */
+	bool poll ();
+
+private:
+	struct State;
+
+	std::shared_ptr<State> state;
+	/** only used on the UI thread, so that the views are never released by a worker */
+	std::vector<SharedPointer<ScintillaEditorView>> views;
+	std::string query;
+	uint32_t searchFlags {0};
+	ResultFunc onResult;
+	DoneFunc onDone;
+	bool useTimer;
+	SharedPointer<CVSTGUITimer> timer;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
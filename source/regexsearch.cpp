@@ -0,0 +1,242 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "regexsearch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** number of compiled patterns kept in the cache */
+constexpr size_t CacheSize = 32;
+
+//------------------------------------------------------------------------
+struct Cache
+{
+	std::mutex mutex;
+	/** most recently used first */
+	std::list<std::pair<std::string, std::shared_ptr<const void>>> entries;
+};
+
+//------------------------------------------------------------------------
+Cache& cache ()
+{
+	static Cache instance;
+	return instance;
+}
+
+//------------------------------------------------------------------------
+/** the position after the next line end at or after position, or the end of the text */
+int64_t nextLineStart (const RegexSearch::TextView& text, int64_t position)
+{
+	int64_t base = 0;
+	for (auto part : {text.first, text.second})
+	{
+		auto partEnd = base + static_cast<int64_t> (part.size ());
+		if (position < partEnd)
+		{
+			auto start = part.data () + std::max<int64_t> (position - base, 0);
+			auto end = part.data () + part.size ();
+			if (auto lineEnd = static_cast<const char*> (std::memchr (start, '\n', end - start)))
+				return base + (lineEnd - part.data ()) + 1;
+		}
+		base = partEnd;
+	}
+	return base;
+}
+
+//------------------------------------------------------------------------
+/** true if the pattern contains ^ or $ outside of a character class */
+bool isLineAnchored (const std::string& pattern)
+{
+	bool inClass = false;
+	for (size_t index = 0; index < pattern.size (); ++index)
+	{
+		auto c = pattern[index];
+		if (c == '\\')
+			++index;
+		else if (inClass)
+		{
+			if (c == ']')
+				inClass = false;
+		}
+		else if (c == '[')
+			inClass = true;
+		else if (c == '^' || c == '$')
+			return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+RegexSearch::RegexSearch (const std::string& pattern, uint32_t searchFlags)
+: compiled (compile (pattern, (searchFlags & ScintillaEditorView::MatchCase) != 0))
+{
+}
+
+//------------------------------------------------------------------------
+std::shared_ptr<const RegexSearch::Compiled> RegexSearch::compile (const std::string& pattern,
+                                                                   bool matchCase)
+{
+	if (pattern.empty ())
+		return nullptr;
+	auto key = pattern;
+	key += matchCase ? '\1' : '\0';
+
+	auto& c = cache ();
+	{
+		std::lock_guard<std::mutex> guard (c.mutex);
+		auto it = std::find_if (c.entries.begin (), c.entries.end (),
+		                        [&] (const auto& entry) { return entry.first == key; });
+		if (it != c.entries.end ())
+		{
+			c.entries.splice (c.entries.begin (), c.entries, it);
+			return std::static_pointer_cast<const Compiled> (it->second);
+		}
+	}
+
+	auto flags = std::regex::ECMAScript | std::regex::optimize;
+	if (!matchCase)
+		flags |= std::regex::icase;
+	auto result = std::make_shared<Compiled> ();
+	try
+	{
+		result->regex.assign (pattern, flags);
+	}
+	catch (const std::regex_error&)
+	{
+		return nullptr;
+	}
+	result->lineAnchored = isLineAnchored (pattern);
+
+	std::lock_guard<std::mutex> guard (c.mutex);
+	c.entries.emplace_front (key, result);
+	if (c.entries.size () > CacheSize)
+		c.entries.pop_back ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+void RegexSearch::clearCache ()
+{
+	auto& c = cache ();
+	std::lock_guard<std::mutex> guard (c.mutex);
+	c.entries.clear ();
+}
+
+//------------------------------------------------------------------------
+void RegexSearch::findInChunk (const TextView& text, int64_t start, int64_t end,
+                               std::vector<Range>& matches) const
+{
+	// the regex needs contiguous memory, only a chunk spanning the gap is copied. The character
+	// before the chunk is part of it, so that \b and \B at its start see the real text.
+	auto from = start > 0 ? start - 1 : start;
+	auto firstSize = static_cast<int64_t> (text.first.size ());
+	std::string copy;
+	const char* data;
+	if (end <= firstSize)
+		data = text.first.data () + from;
+	else if (from >= firstSize)
+		data = text.second.data () + (from - firstSize);
+	else
+	{
+		copy.reserve (static_cast<size_t> (end - from));
+		copy.append (text.first.substr (static_cast<size_t> (from)));
+		copy.append (text.second.substr (0, static_cast<size_t> (end - firstSize)));
+		data = copy.data ();
+	}
+	data += start - from;
+
+	using MatchFlags = std::regex_constants::match_flag_type;
+	auto search = [&] (const char* begin, const char* last, MatchFlags flags) {
+		std::cregex_iterator it (begin, last, compiled->regex, flags);
+		for (std::cregex_iterator itEnd; it != itEnd; ++it)
+		{
+			if (it->length () == 0)
+				continue;
+			auto position = start + ((*it)[0].first - data);
+			matches.push_back ({position, position + it->length ()});
+		}
+	};
+
+	auto chunkEnd = data + (end - start);
+	if (!compiled->lineAnchored)
+	{
+		search (data, chunkEnd,
+		        start > 0 ? std::regex_constants::match_prev_avail
+		                  : std::regex_constants::match_default);
+		return;
+	}
+	for (auto line = data; line < chunkEnd;)
+	{
+		auto next = static_cast<const char*> (std::memchr (line, '\n', chunkEnd - line));
+		auto lineEnd = next ? next : chunkEnd;
+		auto contentEnd = (lineEnd > line && *(lineEnd - 1) == '\r') ? lineEnd - 1 : lineEnd;
+		search (line, contentEnd, std::regex_constants::match_default);
+		line = next ? next + 1 : chunkEnd;
+	}
+}
+
+//------------------------------------------------------------------------
+void RegexSearch::findAll (const TextView& text, std::vector<Range>& matches) const
+{
+	if (!compiled)
+		return;
+	auto size = static_cast<int64_t> (text.size ());
+	auto numChunks = std::min<int64_t> (std::max (std::thread::hardware_concurrency (), 1u),
+	                                    size / static_cast<int64_t> (MinChunkSize));
+	if (numChunks <= 1)
+	{
+		findInChunk (text, 0, size, matches);
+		return;
+	}
+
+	std::vector<int64_t> bounds {0};
+	for (int64_t chunk = 1; chunk < numChunks; ++chunk)
+	{
+		auto bound = nextLineStart (text, size * chunk / numChunks);
+		if (bound > bounds.back () && bound < size)
+			bounds.emplace_back (bound);
+	}
+	bounds.emplace_back (size);
+
+	auto numResults = bounds.size () - 1;
+	std::vector<std::vector<Range>> results (numResults);
+	std::vector<std::thread> threads;
+	threads.reserve (numResults - 1);
+	for (size_t chunk = 1; chunk < numResults; ++chunk)
+	{
+		threads.emplace_back ([&, chunk] () {
+			findInChunk (text, bounds[chunk], bounds[chunk + 1], results[chunk]);
+		});
+	}
+	findInChunk (text, bounds[0], bounds[1], results[0]);
+	for (auto& thread : threads)
+		thread.join ();
+
+	for (const auto& result : results)
+		matches.insert (matches.end (), result.begin (), result.end ());
+}
+
+//------------------------------------------------------------------------
+void RegexSearch::findAllOnCallingThread (const TextView& text, std::vector<Range>& matches) const
+{
+	if (compiled)
+		findInChunk (text, 0, static_cast<int64_t> (text.size ()), matches);
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,66 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** ECMAScript regular expression search on a ScintillaEditorView::TextView.
+ *
+ *	Compiled patterns are cached by pattern and case sensitivity. Large texts are split into line
+ *	aligned chunks which are scanned on multiple threads, the matches are merged in document
+ *	order. Patterns with ^ or $ outside of a character class are matched line by line so that they
+ *	anchor at lines like in scintilla. Other patterns may match across lines, but not across the
+ *	line end at which two chunks meet: a match containing a line break can be missed there.
+ */
+class RegexSearch
+{
+public:
+	using Range = ScintillaEditorView::Range;
+	using TextView = ScintillaEditorView::TextView;
+
+	/** texts are only split into chunks of at least this size */
+	static constexpr size_t MinChunkSize = 1024 * 1024;
+
+	/** @param searchFlags only MatchCase of ScintillaEditorView::SearchFlags is used */
+	RegexSearch (const std::string& pattern, uint32_t searchFlags);
+
+	/** false if the pattern is not a valid regular expression */
+	[[nodiscard]] bool isValid () const { return compiled != nullptr; }
+
+	/** append all non empty matches to matches. The text must not change while searching. */
+	void findAll (const TextView& text, std::vector<Range>& matches) const;
+	/** like findAll, but only on the calling thread. For callers which already run on a worker
+	 *	thread of a pool.
+	 */
+	void findAllOnCallingThread (const TextView& text, std::vector<Range>& matches) const;
+
+	/** remove all cached patterns */
+	static void clearCache ();
+
+private:
+	struct Compiled
+	{
+		std::regex regex;
+		bool lineAnchored {false};
+	};
+	static std::shared_ptr<const Compiled> compile (const std::string& pattern, bool matchCase);
+
+	void findInChunk (const TextView& text, int64_t start, int64_t end,
+	                  std::vector<Range>& matches) const;
+
+	std::shared_ptr<const Compiled> compiled;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
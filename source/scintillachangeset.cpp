@@ -0,0 +1,99 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillachangeset.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** the first range which ends at or after position. Edits usually happen near the end of the
+ *	list (for example replace all works from the start to the end) so only a few ranges follow.
+ */
+auto firstAffected (std::vector<ScintillaChangeSet::Range>& ranges, int64_t position)
+{
+	return std::lower_bound (ranges.begin (), ranges.end (), position,
+	                         [] (const auto& range, auto pos) { return range.end < pos; });
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+void ScintillaChangeSetBuilder::insert (int64_t position, int64_t length, int64_t linesAdded)
+{
+	for (auto it = firstAffected (changes.ranges, position); it != changes.ranges.end (); ++it)
+	{
+		if (it->start >= position)
+			it->start += length;
+		it->end += length;
+	}
+	add (position, position + length);
+	changes.linesDelta += linesAdded;
+	changes.lengthDelta += length;
+	++changes.numModifications;
+}
+
+//------------------------------------------------------------------------
+void ScintillaChangeSetBuilder::remove (int64_t position, int64_t length, int64_t linesAdded)
+{
+	auto map = [&] (int64_t pos) {
+		if (pos <= position)
+			return pos;
+		return pos <= position + length ? position : pos - length;
+	};
+	for (auto it = firstAffected (changes.ranges, position); it != changes.ranges.end (); ++it)
+	{
+		it->start = map (it->start);
+		it->end = map (it->end);
+	}
+	add (position, position);
+	changes.linesDelta += linesAdded;
+	changes.lengthDelta -= length;
+	++changes.numModifications;
+}
+
+//------------------------------------------------------------------------
+void ScintillaChangeSetBuilder::add (int64_t start, int64_t end)
+{
+	auto& ranges = changes.ranges;
+	auto it = std::lower_bound (ranges.begin (), ranges.end (), start,
+	                            [] (const auto& range, auto pos) { return range.start < pos; });
+	it = ranges.insert (it, ScintillaChangeSet::Range {start, end});
+	// merge with the following ranges which overlap or touch the new range
+	auto next = std::next (it);
+	auto last = next;
+	while (last != ranges.end () && last->start <= it->end)
+	{
+		it->end = std::max (it->end, last->end);
+		++last;
+	}
+	it = std::prev (ranges.erase (next, last));
+	// and with the previous range
+	if (it != ranges.begin ())
+	{
+		auto prev = std::prev (it);
+		if (prev->end >= it->start)
+		{
+			prev->end = std::max (prev->end, it->end);
+			ranges.erase (it);
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+ScintillaChangeSet ScintillaChangeSetBuilder::take ()
+{
+	auto result = std::move (changes);
+	changes = {};
+	return result;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
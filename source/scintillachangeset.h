@@ -0,0 +1,57 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** the text changes of a document between two deliveries, merged into a few ranges */
+struct ScintillaChangeSet
+{
+	/** a changed range in positions of the document after all changes. An empty range marks
+	 *	the position where text was deleted.
+	 */
+	struct Range
+	{
+		int64_t start;
+		int64_t end;
+	};
+
+	/** sorted and non overlapping */
+	std::vector<Range> ranges;
+	/** lines added minus lines removed */
+	int64_t linesDelta {0};
+	/** bytes inserted minus bytes deleted */
+	int64_t lengthDelta {0};
+	/** number of inserts and deletes merged into this change set */
+	uint32_t numModifications {0};
+
+	[[nodiscard]] bool empty () const { return numModifications == 0; }
+};
+
+//------------------------------------------------------------------------
+/** collects inserts and deletes into a ScintillaChangeSet */
+class ScintillaChangeSetBuilder
+{
+public:
+	void insert (int64_t position, int64_t length, int64_t linesAdded);
+	void remove (int64_t position, int64_t length, int64_t linesAdded);
+
+	[[nodiscard]] bool empty () const { return changes.empty (); }
+	/** get the collected changes and start a new change set */
+	ScintillaChangeSet take ();
+
+private:
+	void add (int64_t start, int64_t end);
+
+	ScintillaChangeSet changes;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -3,7 +3,14 @@
 // distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
 
 #include "scintillaeditorview.h"
+#include "backgroundlexer.h"
+#include "mappedfile.h"
+#include "regexsearch.h"
+#include "textsearch.h"
+#include "undohistory.h"
 #include "vstgui/lib/cframe.h"
+#include "vstgui/lib/cvstguitimer.h"
+#include "vstgui/lib/dispatchlist.h"
 #include "vstgui/lib/platform/iplatformfont.h"
 #include "vstgui/uidescription/detail/uiviewcreatorattributes.h"
 #include "vstgui/uidescription/iviewcreator.h"
@@ -11,12 +18,20 @@
 #include "vstgui/uidescription/uiviewcreator.h"
 #include "vstgui/uidescription/uiviewfactory.h"
 
+#include "ILexer.h"
+#include "ILoader.h"
 #include "Scintilla.h"
 #include "ScintillaMessages.h"
 #include "ScintillaTypes.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <thread>
 
 //------------------------------------------------------------------------
 namespace VSTGUI {
@@ -28,6 +43,318 @@ using MarkerSymbol = Scintilla::MarkerSymbol;
 using MarkerOutline = Scintilla::MarkerOutline;
 using AutomaticFold = Scintilla::AutomaticFold;
 using WrapVisualFlag = Scintilla::WrapVisualFlag;
+using ModificationFlags = Scintilla::ModificationFlags;
+using DocumentOption = Scintilla::DocumentOption;
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** the document releases its lexer when it is destroyed or gets another lexer. The document only
+ *	gets this reference so that the lexer outlives the document and can be shared by other
+ *	documents shown in the same view.
+ */
+class LexerReference final : public Scintilla::ILexer5
+{
+public:
+	explicit LexerReference (const std::shared_ptr<Scintilla::ILexer5>& lexer) : lexer (lexer) {}
+
+	int SCI_METHOD Version () const override { return lexer->Version (); }
+	void SCI_METHOD Release () override { delete this; }
+	const char* SCI_METHOD PropertyNames () override { return lexer->PropertyNames (); }
+	int SCI_METHOD PropertyType (const char* name) override { return lexer->PropertyType (name); }
+	const char* SCI_METHOD DescribeProperty (const char* name) override
+	{
+		return lexer->DescribeProperty (name);
+	}
+	Sci_Position SCI_METHOD PropertySet (const char* key, const char* val) override
+	{
+		return lexer->PropertySet (key, val);
+	}
+	const char* SCI_METHOD DescribeWordListSets () override
+	{
+		return lexer->DescribeWordListSets ();
+	}
+	Sci_Position SCI_METHOD WordListSet (int n, const char* wl) override
+	{
+		return lexer->WordListSet (n, wl);
+	}
+	void SCI_METHOD Lex (Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	                     Scintilla::IDocument* pAccess) override
+	{
+		lexer->Lex (startPos, lengthDoc, initStyle, pAccess);
+	}
+	void SCI_METHOD Fold (Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	                      Scintilla::IDocument* pAccess) override
+	{
+		lexer->Fold (startPos, lengthDoc, initStyle, pAccess);
+	}
+	void* SCI_METHOD PrivateCall (int operation, void* pointer) override
+	{
+		return lexer->PrivateCall (operation, pointer);
+	}
+	int SCI_METHOD LineEndTypesSupported () override { return lexer->LineEndTypesSupported (); }
+	int SCI_METHOD AllocateSubStyles (int styleBase, int numberStyles) override
+	{
+		return lexer->AllocateSubStyles (styleBase, numberStyles);
+	}
+	int SCI_METHOD SubStylesStart (int styleBase) override
+	{
+		return lexer->SubStylesStart (styleBase);
+	}
+	int SCI_METHOD SubStylesLength (int styleBase) override
+	{
+		return lexer->SubStylesLength (styleBase);
+	}
+	int SCI_METHOD StyleFromSubStyle (int subStyle) override
+	{
+		return lexer->StyleFromSubStyle (subStyle);
+	}
+	int SCI_METHOD PrimaryStyleFromStyle (int style) override
+	{
+		return lexer->PrimaryStyleFromStyle (style);
+	}
+	void SCI_METHOD FreeSubStyles () override { lexer->FreeSubStyles (); }
+	void SCI_METHOD SetIdentifiers (int style, const char* identifiers) override
+	{
+		lexer->SetIdentifiers (style, identifiers);
+	}
+	int SCI_METHOD DistanceToSecondaryStyles () override
+	{
+		return lexer->DistanceToSecondaryStyles ();
+	}
+	const char* SCI_METHOD GetSubStyleBases () override { return lexer->GetSubStyleBases (); }
+	int SCI_METHOD NamedStyles () override { return lexer->NamedStyles (); }
+	const char* SCI_METHOD NameOfStyle (int style) override { return lexer->NameOfStyle (style); }
+	const char* SCI_METHOD TagsOfStyle (int style) override { return lexer->TagsOfStyle (style); }
+	const char* SCI_METHOD DescriptionOfStyle (int style) override
+	{
+		return lexer->DescriptionOfStyle (style);
+	}
+	const char* SCI_METHOD GetName () override { return lexer->GetName (); }
+	int SCI_METHOD GetIdentifier () override { return lexer->GetIdentifier (); }
+	const char* SCI_METHOD PropertyGet (const char* key) override
+	{
+		return lexer->PropertyGet (key);
+	}
+
+private:
+	std::shared_ptr<Scintilla::ILexer5> lexer;
+};
+
+//------------------------------------------------------------------------
+constexpr auto LineNumberStyle = static_cast<uint32_t> (StylesCommon::LineNumber);
+
+//------------------------------------------------------------------------
+/** the theme matching the default style of a freshly created editor */
+ScintillaTheme readThemeFromStyles (const ScintillaEditorView& view)
+{
+	ScintillaTheme::DefaultStyle style;
+	auto length = view.sendMessage (Message::StyleGetFont, StylesCommon::Default);
+	if (length > 0)
+	{
+		style.fontName.resize (length);
+		view.sendMessage (Message::StyleGetFont, StylesCommon::Default, style.fontName.data ());
+	}
+	style.fontSize = static_cast<int32_t> (
+	    view.sendMessage (Message::StyleGetSizeFractional, StylesCommon::Default));
+	style.weight =
+	    static_cast<uint32_t> (view.sendMessage (Message::StyleGetWeight, StylesCommon::Default));
+	style.italic = view.sendMessage (Message::StyleGetItalic, StylesCommon::Default) != 0;
+	style.foreground =
+	    fromScintillaColor (view.sendMessage (Message::StyleGetFore, StylesCommon::Default));
+	style.background =
+	    fromScintillaColor (view.sendMessage (Message::StyleGetBack, StylesCommon::Default));
+	ScintillaTheme theme;
+	theme.setDefaultStyle (style);
+	return theme;
+}
+
+//------------------------------------------------------------------------
+/** diagnostics use one marker, indicator and annotation style per severity */
+constexpr uint32_t NumSeverities = 3;
+constexpr uint32_t FirstDiagnosticMarker = 20;
+constexpr uint32_t FirstDiagnosticIndicator = INDICATOR_CONTAINER;
+/** the indicator for the highlights of findAll */
+constexpr uint32_t FindIndicator = FirstDiagnosticIndicator + NumSeverities;
+/** when more lines were edited the diagnostics are applied again completely */
+constexpr size_t MaxDirtyDiagnosticLines = 1024;
+
+//------------------------------------------------------------------------
+CColor diagnosticColor (uint32_t severity)
+{
+	switch (static_cast<ScintillaDiagnostic::Severity> (severity))
+	{
+		case ScintillaDiagnostic::Severity::Info: return CColor (0, 122, 204);
+		case ScintillaDiagnostic::Severity::Warning: return CColor (230, 160, 0);
+		case ScintillaDiagnostic::Severity::Error: break;
+	}
+	return CColor (220, 40, 40);
+}
+
+//------------------------------------------------------------------------
+Scintilla::FindOption toFindOption (uint32_t searchFlags)
+{
+	auto sciSearchFlags = Scintilla::FindOption::None;
+	if (searchFlags & ScintillaEditorView::MatchCase)
+		sciSearchFlags |= Scintilla::FindOption::MatchCase;
+	if (searchFlags & ScintillaEditorView::WholeWord)
+		sciSearchFlags |= Scintilla::FindOption::WholeWord;
+	if (searchFlags & ScintillaEditorView::WordStart)
+		sciSearchFlags |= Scintilla::FindOption::WordStart;
+	if (searchFlags & ScintillaEditorView::RegularExpression)
+		sciSearchFlags |= Scintilla::FindOption::RegExp | Scintilla::FindOption::Cxx11RegEx;
+	return sciSearchFlags;
+}
+
+//------------------------------------------------------------------------
+/** search with the target of scintilla, used when the case of non ASCII characters must be
+ *	folded. The target is restored afterwards.
+ */
+void findAllInTarget (const ScintillaEditorView& view, UTF8StringPtr searchString,
+                      uint32_t searchFlags, std::vector<ScintillaEditorView::Range>& matches)
+{
+	auto targetStart = view.sendMessage (Message::GetTargetStart);
+	auto targetEnd = view.sendMessage (Message::GetTargetEnd);
+	auto previousFlags = view.sendMessage (Message::GetSearchFlags);
+	auto length = view.sendMessage (Message::GetTextLength);
+	auto searchLength = static_cast<intptr_t> (std::strlen (searchString));
+
+	view.sendMessage (Message::SetSearchFlags, toFindOption (searchFlags));
+	view.sendMessage (Message::SetTargetRange, 0, length);
+	while (view.sendMessage (Message::SearchInTarget, searchLength, searchString) >= 0)
+	{
+		auto start = view.sendMessage (Message::GetTargetStart);
+		auto end = view.sendMessage (Message::GetTargetEnd);
+		matches.push_back ({start, end});
+		view.sendMessage (Message::SetTargetRange, std::max (end, start + 1), length);
+	}
+	view.sendMessage (Message::SetSearchFlags, previousFlags);
+	view.sendMessage (Message::SetTargetRange, targetStart, targetEnd);
+}
+
+//------------------------------------------------------------------------
+/** files are appended in pieces so that scintilla never needs a second copy of the file */
+constexpr size_t LoadChunkSize = 1024 * 1024;
+
+//------------------------------------------------------------------------
+/** documents of the large file mode have no styles and may be larger than 2 GB */
+constexpr auto LargeDocumentOptions =
+    static_cast<DocumentOption> (static_cast<int> (DocumentOption::StylesNone) |
+                                 static_cast<int> (DocumentOption::TextLarge));
+
+//------------------------------------------------------------------------
+/** the indices of the values in the order of less, values which are sorted already are not
+ *	sorted again
+ */
+template <typename T, typename Less>
+std::vector<size_t> sortedOrder (const std::vector<T>& values, Less less)
+{
+	std::vector<size_t> order (values.size ());
+	std::iota (order.begin (), order.end (), 0);
+	if (!std::is_sorted (values.begin (), values.end (), less))
+		std::sort (order.begin (), order.end (),
+		           [&] (size_t a, size_t b) { return less (values[a], values[b]); });
+	return order;
+}
+
+//------------------------------------------------------------------------
+/** counts the code units of the characters of one line. Seeking forward continues from the last
+ *	position, so sorted positions of a line are converted in one pass.
+ */
+class LineWalker
+{
+public:
+	using PositionUnit = ScintillaEditorView::PositionUnit;
+
+	LineWalker (const ScintillaEditorView::TextView& inText, PositionUnit inUnit)
+	: text (inText), unit (inUnit)
+	{
+	}
+
+	void reset (int64_t lineStart, int64_t lineEnd)
+	{
+		start = lineStart;
+		end = lineEnd;
+		position = lineStart;
+		column = 0;
+	}
+
+	/** the byte position of the character which contains the column */
+	int64_t seekColumn (int64_t target)
+	{
+		if (unit == PositionUnit::Bytes)
+			return std::min (start + target, end);
+		if (target < column)
+			reset (start, end);
+		while (position < end)
+		{
+			auto [width, units] = next ();
+			if (column + units > target)
+				break;
+			position += width;
+			column += units;
+		}
+		return position;
+	}
+
+	/** the column of the character which contains the byte position */
+	int64_t seekPosition (int64_t target)
+	{
+		target = std::min (target, end);
+		if (unit == PositionUnit::Bytes)
+			return target - start;
+		if (target < position)
+			reset (start, end);
+		while (position < target)
+		{
+			auto [width, units] = next ();
+			if (position + width > target)
+				break;
+			position += width;
+			column += units;
+		}
+		return column;
+	}
+
+private:
+	uint8_t byteAt (int64_t index) const
+	{
+		auto offset = static_cast<size_t> (index);
+		if (offset < text.first.size ())
+			return static_cast<uint8_t> (text.first[offset]);
+		return static_cast<uint8_t> (text.second[offset - text.first.size ()]);
+	}
+
+	/** the width in bytes and in code units of the character at the position, invalid UTF-8 is
+	 *	counted byte by byte like scintilla does
+	 */
+	std::pair<int64_t, int64_t> next () const
+	{
+		auto lead = byteAt (position);
+		int64_t width = 1;
+		if (lead >= 0xC0 && lead < 0xF8)
+			width = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+		if (position + width > end)
+			width = 1;
+		for (int64_t index = 1; index < width; ++index)
+		{
+			if ((byteAt (position + index) & 0xC0) != 0x80)
+				return {1, 1};
+		}
+		return {width, width == 4 && unit == PositionUnit::UTF16 ? 2 : 1};
+	}
+
+	const ScintillaEditorView::TextView& text;
+	PositionUnit unit;
+	int64_t start {0};
+	int64_t end {0};
+	int64_t position {0};
+	int64_t column {0};
+};
+
+//------------------------------------------------------------------------
+} // anonymous
 
 //------------------------------------------------------------------------
 constexpr AutomaticFold operator| (AutomaticFold a, AutomaticFold b) noexcept
@@ -66,9 +393,20 @@ void ScintillaEditorView::init ()
 {
 	setWantsFocus (true);
 	updateMarginsColumns ();
-	registerListener (this);
+	registerListener (this, {{static_cast<uint32_t> (Notification::Modified),
+	                          static_cast<uint32_t> (Notification::StyleNeeded),
+	                          static_cast<uint32_t> (Notification::Zoom),
+	                          static_cast<uint32_t> (Notification::FocusIn),
+	                          static_cast<uint32_t> (Notification::FocusOut)},
+	                         static_cast<uint32_t> (ModificationFlags::InsertText) |
+	                             static_cast<uint32_t> (ModificationFlags::DeleteText)});
 	sendMessage (Message::SetPhasesDraw, Scintilla::PhasesDraw::Two);
+	theme = ScintillaTheme::intern (readThemeFromStyles (*this));
 	sendMessage (Message::SetSelectionLayer, Scintilla::Layer::UnderText);
+	sendMessage (Message::IndicSetStyle, FindIndicator, Scintilla::IndicatorStyle::FullBox);
+	sendMessage (Message::IndicSetFore, FindIndicator, toScintillaColor (CColor (255, 200, 0)));
+	sendMessage (Message::IndicSetAlpha, FindIndicator, 100);
+	sendMessage (Message::IndicSetUnder, FindIndicator, 1);
 }
 
 //------------------------------------------------------------------------
@@ -84,59 +422,116 @@ void ScintillaEditorView::takeFocus ()
 	sendMessage (Message::GrabFocus);
 }
 
+//------------------------------------------------------------------------
+void ScintillaEditorView::setTheme (const std::shared_ptr<const ScintillaTheme>& newTheme)
+{
+	if (!newTheme || newTheme == theme)
+		return;
+	auto previous = std::move (theme);
+	theme = newTheme;
+	if (*previous == *theme)
+		return;
+
+	const auto& defaultStyle = theme->getDefaultStyle ();
+	if (previous->getDefaultStyle () != defaultStyle)
+	{
+		// all styles are reset to the default style and then only the differences are applied
+		sendMessage (Message::StyleSetFont, StylesCommon::Default, defaultStyle.fontName.data ());
+		sendMessage (Message::StyleSetSizeFractional, StylesCommon::Default, defaultStyle.fontSize);
+		sendMessage (Message::StyleSetWeight, StylesCommon::Default, defaultStyle.weight);
+		sendMessage (Message::StyleSetItalic, StylesCommon::Default, defaultStyle.italic);
+		sendMessage (Message::StyleSetFore, StylesCommon::Default,
+		             toScintillaColor (defaultStyle.foreground));
+		sendMessage (Message::StyleSetBack, StylesCommon::Default,
+		             toScintillaColor (defaultStyle.background));
+		sendMessage (Message::StyleClearAll);
+		auto base = theme->resolve (static_cast<uint32_t> (StylesCommon::Default));
+		for (const auto& style : theme->getStyles ())
+			applyStyle (style.first, theme->resolve (style.first), base);
+		if (previous->getDefaultStyle ().background != defaultStyle.background)
+			platformSetBackgroundColor (defaultStyle.background);
+		if (diagnostics)
+			applyDiagnosticStyles ();
+		updateMarginsColumns ();
+	}
+	else
+	{
+		for (const auto& style : previous->getStyles ())
+			applyStyle (style.first, theme->resolve (style.first), previous->resolve (style.first));
+		for (const auto& style : theme->getStyles ())
+		{
+			if (previous->getStyles ().count (style.first) == 0)
+				applyStyle (style.first, theme->resolve (style.first),
+				            previous->resolve (style.first));
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+const std::shared_ptr<const ScintillaTheme>& ScintillaEditorView::getTheme () const
+{
+	return theme;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::modifyTheme (const std::function<void (ScintillaTheme&)>& proc)
+{
+	auto newTheme = std::make_shared<ScintillaTheme> (*theme);
+	proc (*newTheme);
+	setTheme (newTheme);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::applyStyle (uint32_t index, const ScintillaTheme::ResolvedStyle& style,
+                                      const ScintillaTheme::ResolvedStyle& current)
+{
+	if (style.foreground != current.foreground)
+		sendMessage (Message::StyleSetFore, index, toScintillaColor (style.foreground));
+	if (style.background != current.background)
+		sendMessage (Message::StyleSetBack, index, toScintillaColor (style.background));
+	if (style.weight != current.weight)
+		sendMessage (Message::StyleSetWeight, index, style.weight);
+	if (style.italic != current.italic)
+		sendMessage (Message::StyleSetItalic, index, style.italic);
+}
+
 //------------------------------------------------------------------------
 void ScintillaEditorView::setStyleColor (uint32_t index, const CColor& textColor,
                                          const CColor& backColor)
 {
-	sendMessage (Message::StyleSetFore, index, toScintillaColor (textColor));
-	if (backColor != kTransparentCColor)
-		sendMessage (Message::StyleSetBack, index, toScintillaColor (backColor));
+	modifyTheme ([&] (ScintillaTheme& t) {
+		t.setStyleForeground (index, textColor);
+		if (backColor != kTransparentCColor)
+			t.setStyleBackground (index, backColor);
+	});
 }
 
 //------------------------------------------------------------------------
 void ScintillaEditorView::setStyleFontWeight (uint32_t index, uint32_t weight)
 {
-	sendMessage (Message::StyleSetWeight, index, weight);
+	modifyTheme ([&] (ScintillaTheme& t) { t.setStyleWeight (index, weight); });
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setFont (const SharedPointer<CFontDesc>& _font)
+void ScintillaEditorView::setFont (const SharedPointer<CFontDesc>& font)
 {
-	font = _font;
 	if (!font)
 		return;
-	bool isBold = font->getStyle () & kBoldFace;
-	bool isItalic = font->getStyle () & kItalicFace;
-	const auto& fontName = font->getName ();
-	auto fontSize = font->getSize () * static_cast<CCoord> (Scintilla::FontSizeMultiplier);
-	for (int i = 0; i < 128; i++)
-	{
-		sendMessage (Message::StyleSetFont, i, fontName.data ());
-		sendMessage (Message::StyleSetSizeFractional, i, static_cast<intptr_t> (fontSize));
-		sendMessage (Message::StyleSetBold, i, isBold);
-		sendMessage (Message::StyleSetItalic, i, isItalic);
-	}
-	updateMarginsColumns ();
+	modifyTheme ([&] (ScintillaTheme& t) { t.setFont (font); });
 }
 
 //------------------------------------------------------------------------
 SharedPointer<CFontDesc> ScintillaEditorView::getFont () const
 {
-	return font;
+	return theme->getFont ();
 }
 
 //------------------------------------------------------------------------
 void ScintillaEditorView::setStaticFontColor (const CColor& color)
 {
 	if (color == kTransparentCColor)
-	{
-	}
-	else
-	{
-		auto sc = toScintillaColor (color);
-		for (auto index = 0; index <= STYLE_DEFAULT; ++index)
-			sendMessage (Message::StyleSetFore, index, sc);
-	}
+		return;
+	modifyTheme ([&] (ScintillaTheme& t) { t.setForeground (color); });
 }
 
 //------------------------------------------------------------------------
@@ -148,10 +543,7 @@ CColor ScintillaEditorView::getStaticFontColor () const
 //------------------------------------------------------------------------
 void ScintillaEditorView::setBackgroundColor (const CColor& color)
 {
-	auto sc = toScintillaColor (color);
-	for (auto index = 0; index <= STYLE_DEFAULT; ++index)
-		sendMessage (Message::StyleSetBack, index, sc);
-	platformSetBackgroundColor (color);
+	modifyTheme ([&] (ScintillaTheme& t) { t.setBackground (color); });
 }
 
 //------------------------------------------------------------------------
@@ -253,422 +645,2206 @@ void ScintillaEditorView::setText (UTF8StringPtr text)
 {
 	sendMessage (Message::SetText, 0, text);
 	sendMessage (Message::EmptyUndoBuffer);
+	updateUndoMemoryUsage ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setText (std::string_view text)
+{
+	sendMessage (Message::ClearAll);
+	sendMessage (Message::AppendText, text.size (), text.data ());
+	sendMessage (Message::EmptyUndoBuffer);
+	updateUndoMemoryUsage ();
 }
 
 //------------------------------------------------------------------------
 UTF8String ScintillaEditorView::getText () const
 {
-	std::string str;
-	auto length = sendMessage (Message::GetTextLength);
-	if (length > 0)
-	{
-		str.resize (length);
-		sendMessage (Message::GetText, length + 1, str.data ());
-	}
-	return UTF8String (std::move (str));
+	return getText (Range {0, sendMessage (Message::GetTextLength)});
 }
 
 //------------------------------------------------------------------------
-UTF8String ScintillaEditorView::getText (const Range& range)
+UTF8String ScintillaEditorView::getText (const Range& range) const
 {
-	if (range.start >= range.end)
-		return {};
+	auto view = getTextView (range);
 	std::string str;
-	str.resize ((range.end - range.start));
-	Sci_TextRange textRange;
-	textRange.chrg.cpMin = static_cast<Sci_PositionCR> (range.start);
-	textRange.chrg.cpMax = static_cast<Sci_PositionCR> (range.end);
-	textRange.lpstrText = str.data ();
-	sendMessage (Message::GetTextRange, 0, &textRange);
+	str.reserve (view.size ());
+	view.forEach ([&] (std::string_view part) { str.append (part); });
 	return UTF8String (std::move (str));
 }
 
 //------------------------------------------------------------------------
-auto ScintillaEditorView::getSelection () const -> Range
+auto ScintillaEditorView::getTextView () const -> TextView
 {
-	Range selection {};
-	selection.start = sendMessage (Message::GetSelectionStart);
-	selection.end = sendMessage (Message::GetSelectionEnd);
-	return selection;
+	return getTextView (Range {0, sendMessage (Message::GetTextLength)});
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setSelection (Range selection)
+auto ScintillaEditorView::getTextView (const Range& range) const -> TextView
 {
-	sendMessage (Message::SetSelectionStart, selection.start);
-	sendMessage (Message::SetSelectionEnd, selection.end);
+	auto length = static_cast<int64_t> (sendMessage (Message::GetTextLength));
+	auto start = std::clamp<int64_t> (range.start, 0, length);
+	auto end = std::clamp<int64_t> (range.end, start, length);
+	if (start == end)
+		return {};
+
+	auto rangePointer = [this] (int64_t pos, int64_t size) {
+		auto ptr = sendMessage (Message::GetRangePointer, pos, size);
+		return std::string_view (reinterpret_cast<const char*> (ptr), static_cast<size_t> (size));
+	};
+
+	// a range which does not span the gap can be accessed without moving the gap
+	TextView view;
+	auto gap = static_cast<int64_t> (sendMessage (Message::GetGapPosition));
+	if (gap <= start || gap >= end)
+	{
+		view.first = rangePointer (start, end - start);
+	}
+	else
+	{
+		view.first = rangePointer (start, gap - start);
+		view.second = rangePointer (gap, end - gap);
+	}
+	return view;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::selectAll ()
+std::shared_ptr<const DocumentSnapshot> ScintillaEditorView::createSnapshot ()
 {
-	sendMessage (Message::SelectAll);
+	if (!snapshots)
+		snapshots = std::make_unique<DocumentSnapshotTracker> ();
+	if (!snapshots->isValid ())
+	{
+		auto text = getTextView ();
+		snapshots->reset (text.first, text.second);
+	}
+	return snapshots->snapshot ();
 }
 
 //------------------------------------------------------------------------
-int64_t ScintillaEditorView::findAndSelect (UTF8StringPtr searchString, uint32_t searchFlags)
+auto ScintillaEditorView::openFile (UTF8StringPtr path) -> LoadResult
 {
-	auto sciSearchFlags = Scintilla::FindOption::None;
-	if (searchFlags & MatchCase)
-		sciSearchFlags |= Scintilla::FindOption::MatchCase;
-	if (searchFlags & WholeWord)
-		sciSearchFlags |= Scintilla::FindOption::WholeWord;
-	if (searchFlags & WordStart)
-		sciSearchFlags |= Scintilla::FindOption::WordStart;
-
-	auto selection = getSelection ();
+	if (auto file = MappedFile::open (path))
+		return loadFromMapping (*file);
+	return {};
+}
 
-	if (!(searchFlags & Backwards))
-		sendMessage (Message::SetSelectionStart, selection.end);
-	sendMessage (Message::SearchAnchor);
+//------------------------------------------------------------------------
+auto ScintillaEditorView::loadFromMapping (const MappedFile& file) -> LoadResult
+{
+	// the text is streamed in many parts, the snapshot copy is rebuilt once on demand
+	if (snapshots)
+		snapshots->invalidate ();
+	auto startTime = std::chrono::steady_clock::now ();
 
-	intptr_t result;
-	if (searchFlags & Backwards)
+	auto undoCollection = sendMessage (Message::GetUndoCollection);
+	sendMessage (Message::SetUndoCollection, 0);
+	// a read-only view shows the file too, scintilla would ignore the edits below
+	auto readOnly = sendMessage (Message::GetReadOnly);
+	sendMessage (Message::SetReadOnly, false);
+	// the mode is chosen for the size of the file and not for the text while it is replaced
+	loadingText = true;
+	sendMessage (Message::ClearAll);
+	sendMessage (Message::EmptyUndoBuffer);
+	// the document options can only be chosen when a document is created
+	prepareDocument (file.size ());
+	sendMessage (Message::SetUndoCollection, 0);
+	sendMessage (Message::Allocate, file.size () + 1);
+	for (size_t offset = 0; offset < file.size (); offset += LoadChunkSize)
 	{
-		result = sendMessage (Message::SearchPrev, sciSearchFlags, searchString);
-		if (result < 0 && searchFlags & Wrap)
-		{
-			auto textLength = sendMessage (Message::GetTextLength);
-			sendMessage (Message::SetSelectionStart, textLength);
-			sendMessage (Message::SetSelectionEnd, textLength);
-			sendMessage (Message::SearchAnchor);
-			result = sendMessage (Message::SearchPrev, sciSearchFlags, searchString);
-		}
+		auto length = std::min (LoadChunkSize, file.size () - offset);
+		sendMessage (Message::AppendText, length, file.data () + offset);
 	}
-	else
+	loadingText = false;
+	sendMessage (Message::EmptyUndoBuffer);
+	sendMessage (Message::SetUndoCollection, undoCollection);
+	sendMessage (Message::SetSavePoint);
+	sendMessage (Message::SetReadOnly, readOnly);
+	updateUndoMemoryUsage ();
+
+	LoadResult result;
+	result.bytes = static_cast<uint64_t> (sendMessage (Message::GetTextLength));
+	result.success = result.bytes == file.size ();
+	result.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime)
+	                     .count ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::AsyncLoad
+{
+	/** the interval in milliseconds in which the progress is reported */
+	static constexpr uint32_t PollInterval = 50;
+
+	std::unique_ptr<MappedFile> file;
+	Scintilla::ILoader* loader {nullptr};
+	void* previousDocument {nullptr};
+	bool readOnly {false};
+	std::chrono::steady_clock::time_point startTime;
+	SharedPointer<CVSTGUITimer> timer;
+
+	std::thread thread;
+	std::atomic<uint64_t> bytesLoaded {0};
+	std::atomic<bool> cancel {false};
+	std::atomic<bool> failed {false};
+	std::atomic<bool> finished {false};
+
+	void run ()
 	{
-		result = sendMessage (Message::SearchNext, sciSearchFlags, searchString);
-		if (result < 0 && searchFlags & Wrap)
+		for (size_t offset = 0; offset < file->size () && !cancel; offset += LoadChunkSize)
 		{
-			sendMessage (Message::SetSelectionStart);
-			sendMessage (Message::SetSelectionEnd);
-			sendMessage (Message::SearchAnchor);
-			result = sendMessage (Message::SearchNext, sciSearchFlags, searchString);
+			auto length = std::min (LoadChunkSize, file->size () - offset);
+			auto status = loader->AddData (file->data () + offset, length);
+			if (status != static_cast<int> (Scintilla::Status::Ok))
+			{
+				failed = true;
+				break;
+			}
+			bytesLoaded += length;
 		}
+		finished = true;
 	}
-	if (result >= 0)
+
+	~AsyncLoad () noexcept
 	{
-		if (searchFlags & ScrollTo)
-		{
-			sendMessage (Message::ScrollCaret);
-		}
-		return result;
+		cancel = true;
+		if (thread.joinable ())
+			thread.join ();
+		if (timer)
+			timer->stop ();
+		if (loader)
+			loader->Release ();
 	}
-	setSelection (selection);
-
-	return -1;
-}
+};
 
 //------------------------------------------------------------------------
-[[maybe_unused]] bool ScintillaEditorView::replaceSelection (UTF8StringPtr string)
+void ScintillaEditorView::AsyncLoadDeleter::operator() (AsyncLoad* load) const noexcept
 {
-	sendMessage (Message::ReplaceSel, 0, string);
-	return true;
+	delete load;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setUseTabs (bool state)
+bool ScintillaEditorView::openFileAsync (UTF8StringPtr path)
 {
-	sendMessage (Message::SetUseTabs, state);
+	cancelLoading ();
+
+	auto file = MappedFile::open (path);
+	if (!file)
+		return false;
+	auto documentOptions = sendMessage (Message::GetDocumentOptions);
+	if (isLargeFile (file->size ()))
+		documentOptions |= static_cast<intptr_t> (LargeDocumentOptions);
+	else
+		documentOptions &= ~static_cast<intptr_t> (DocumentOption::StylesNone);
+	auto loader = reinterpret_cast<Scintilla::ILoader*> (
+	    sendMessage (Message::CreateLoader, file->size () + 1, documentOptions));
+	if (!loader)
+		return false;
+
+	auto load = std::unique_ptr<AsyncLoad, AsyncLoadDeleter> (new AsyncLoad);
+	load->file = std::move (file);
+	load->loader = loader;
+	load->readOnly = sendMessage (Message::GetReadOnly) != 0;
+	load->startTime = std::chrono::steady_clock::now ();
+
+	// keep the current document alive, it is shown again if the load is cancelled
+	load->previousDocument = reinterpret_cast<void*> (sendMessage (Message::GetDocPointer));
+	sendMessage (Message::AddRefDocument, 0, load->previousDocument);
+	auto placeholder =
+	    reinterpret_cast<void*> (sendMessage (Message::CreateDocument, 0, documentOptions));
+	switchDocument (placeholder, true);
+	sendMessage (Message::ReleaseDocument, 0, placeholder);
+	sendMessage (Message::SetReadOnly, 1);
+
+	load->thread = std::thread ([load = load.get ()] () { load->run (); });
+	asyncLoad = std::move (load);
+	// timers need a frame, the load of a view which is not attached is polled once it is attached
+	if (isAttached ())
+		startAsyncLoadTimer ();
+	return true;
 }
 
 //------------------------------------------------------------------------
-bool ScintillaEditorView::getUseTabs () const
+void ScintillaEditorView::startAsyncLoadTimer ()
 {
-	return sendMessage (Message::GetUseTabs) != 0;
+	if (!asyncLoad->timer)
+		asyncLoad->timer = makeOwned<CVSTGUITimer> (
+		    [this] (CVSTGUITimer*) { onAsyncLoadTimer (); }, AsyncLoad::PollInterval, false);
+	asyncLoad->timer->start ();
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setTabWidth (uint32_t width)
+void ScintillaEditorView::startPendingTimers ()
 {
-	sendMessage (Message::SetTabWidth, width);
+	if (asyncLoad)
+		startAsyncLoadTimer ();
+	if (changeSets && !changeSets->builder.empty ())
+		startChangeSetTimer ();
+	// the timer stops itself on its first tick if no result is waiting
+	if (backgroundLexing)
+		startLexingTimer ();
+	if (undoTracking && undoTracking->usage > undoTracking->limit)
+		startUndoTrimTimer ();
 }
 
 //------------------------------------------------------------------------
-uint32_t ScintillaEditorView::getTabWidth () const
+void ScintillaEditorView::cancelLoading ()
 {
-	return static_cast<uint32_t> (sendMessage (Message::GetTabWidth));
+	if (asyncLoad)
+		finishAsyncLoad (true);
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLexer (Scintilla::ILexer5* inLexer)
+void ScintillaEditorView::flushLoading ()
 {
-	lexer = inLexer;
-	sendMessage (Message::SetILexer, 0, lexer);
+	// finishing waits for the worker
+	if (asyncLoad)
+		finishAsyncLoad (false);
 }
 
 //------------------------------------------------------------------------
-Scintilla::ILexer5* ScintillaEditorView::getLexer () const
+bool ScintillaEditorView::isLoading () const
 {
-	return lexer;
+	return asyncLoad != nullptr;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineWrap (Scintilla::Wrap mode)
+void ScintillaEditorView::onAsyncLoadTimer ()
 {
-	sendMessage (Message::SetWrapMode, mode);
+	if (asyncLoad->finished)
+	{
+		finishAsyncLoad (false);
+		return;
+	}
+	auto bytesLoaded = asyncLoad->bytesLoaded.load ();
+	auto bytesTotal = static_cast<uint64_t> (asyncLoad->file->size ());
+	forEachListener ([&] (IScintillaListener* listener) {
+		listener->onScintillaLoadProgress (this, bytesLoaded, bytesTotal);
+	});
 }
 
 //------------------------------------------------------------------------
-auto ScintillaEditorView::getLineWrap () const -> Scintilla::Wrap
+void ScintillaEditorView::finishAsyncLoad (bool cancelled)
 {
-	return static_cast<Scintilla::Wrap> (sendMessage (Message::GetWrapMode));
+	auto load = std::move (asyncLoad);
+	load->cancel = cancelled;
+	load->thread.join ();
+	if (load->timer)
+		load->timer->stop ();
+
+	ScintillaLoadResult result;
+	if (!cancelled && !load->failed)
+	{
+		auto document = load->loader->ConvertToDocument ();
+		load->loader = nullptr;
+		// the loaded file replaces the document only in this view
+		leaveSharedDocument ();
+		switchDocument (document, true);
+		sendMessage (Message::ReleaseDocument, 0, document);
+		sendMessage (Message::ReleaseDocument, 0, load->previousDocument);
+		sendMessage (Message::SetReadOnly, load->readOnly);
+		updateLargeFileMode ();
+		result.success = true;
+		result.bytes = static_cast<uint64_t> (sendMessage (Message::GetTextLength));
+	}
+	else
+	{
+		// the previous document did not change, it keeps its undo history
+		switchDocument (load->previousDocument, false);
+		sendMessage (Message::ReleaseDocument, 0, load->previousDocument);
+	}
+	result.seconds =
+	    std::chrono::duration<double> (std::chrono::steady_clock::now () - load->startTime).count ();
+	forEachListener ([&] (IScintillaListener* listener) {
+		listener->onScintillaLoadFinished (this, result);
+	});
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::switchDocument (void* document, bool inheritSettings)
+{
+	if (snapshots)
+		snapshots->invalidate ();
+	if (!inheritSettings)
+	{
+		sendMessage (Message::SetDocPointer, 0, document);
+		updateUndoMemoryUsage ();
+		return;
+	}
+	// these settings are stored in the document and not in the view
+	auto codePage = sendMessage (Message::GetCodePage);
+	auto eolMode = sendMessage (Message::GetEOLMode);
+	auto tabWidth = sendMessage (Message::GetTabWidth);
+	auto indent = sendMessage (Message::GetIndent);
+	auto useTabs = sendMessage (Message::GetUseTabs);
+	sendMessage (Message::SetDocPointer, 0, document);
+	sendMessage (Message::SetCodePage, codePage);
+	sendMessage (Message::SetEOLMode, eolMode);
+	sendMessage (Message::SetTabWidth, tabWidth);
+	sendMessage (Message::SetIndent, indent);
+	sendMessage (Message::SetUseTabs, useTabs);
+	if (lexer)
+		attachLexer ();
+	updateMarginsColumns ();
+	updateUndoMemoryUsage ();
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::isLargeFile (uint64_t size) const
+{
+	if (largeFileThreshold == 0)
+		return false;
+	// the mode is left below three quarters of the threshold, so that it does not toggle while
+	// editing around the threshold
+	return size > (largeFile ? largeFileThreshold / 4 * 3 : largeFileThreshold);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLargeFileThreshold (uint64_t bytes)
+{
+	largeFileThreshold = bytes;
+	prepareDocument (static_cast<uint64_t> (sendMessage (Message::GetTextLength)));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::prepareDocument (uint64_t size)
+{
+	auto large = isLargeFile (size);
+	auto options = sendMessage (Message::GetDocumentOptions);
+	auto stylesNone = static_cast<intptr_t> (DocumentOption::StylesNone);
+	// the undo history or the other views of the document would be lost with the document,
+	// otherwise only the view profile changes
+	if (!sharedDocument && !canUndo () && large != ((options & stylesNone) != 0))
+		exchangeDocument (large ? options | static_cast<intptr_t> (LargeDocumentOptions)
+		                        : options & ~stylesNone);
+	if (large != largeFile.has_value ())
+		setLargeFileMode (large);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::exchangeDocument (intptr_t documentOptions)
+{
+	// the text is moved into the new document silently, for the listeners it does not change
+	auto text = getTextView ();
+	auto previousDocument = reinterpret_cast<void*> (sendMessage (Message::GetDocPointer));
+	sendMessage (Message::AddRefDocument, 0, previousDocument);
+	auto selection = getSelection ();
+	auto firstVisibleLine = sendMessage (Message::GetFirstVisibleLine);
+	auto readOnly = sendMessage (Message::GetReadOnly);
+	auto modified = sendMessage (Message::GetModify);
+
+	auto document = reinterpret_cast<void*> (
+	    sendMessage (Message::CreateDocument, text.size () + 1, documentOptions));
+	switchDocument (document, true);
+	sendMessage (Message::ReleaseDocument, 0, document);
+	sendMessage (Message::SetModEventMask, 0);
+	auto undoCollection = sendMessage (Message::GetUndoCollection);
+	sendMessage (Message::SetUndoCollection, 0);
+	text.forEach ([&] (std::string_view part) {
+		sendMessage (Message::AppendText, part.size (), part.data ());
+	});
+	sendMessage (Message::SetUndoCollection, undoCollection);
+	updateModEventMask ();
+	sendMessage (Message::ReleaseDocument, 0, previousDocument);
+
+	if (!modified)
+		sendMessage (Message::SetSavePoint);
+	sendMessage (Message::SetReadOnly, readOnly);
+	setSelection (selection);
+	sendMessage (Message::SetFirstVisibleLine, firstVisibleLine);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::updateLargeFileMode ()
+{
+	auto large = isLargeFile (static_cast<uint64_t> (sendMessage (Message::GetTextLength)));
+	if (large != largeFile.has_value ())
+		setLargeFileMode (large);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLargeFileMode (bool state)
+{
+	if (state)
+	{
+		largeFile = LargeFileProfile {getFoldingVisible (), getLineWrap (),
+		                              sendMessage (Message::GetLayoutCache)};
+		attachLexer ();
+		setFoldingVisible (false);
+		setLineWrap (Scintilla::Wrap::None);
+		sendMessage (Message::SetLayoutCache, Scintilla::LineCache::Page);
+	}
+	else
+	{
+		auto profile = *largeFile;
+		largeFile.reset ();
+		sendMessage (Message::SetLayoutCache, profile.layoutCache);
+		setLineWrap (profile.wrap);
+		setFoldingVisible (profile.foldingVisible);
+		attachLexer ();
+	}
+	forEachListener (
+	    [&] (IScintillaListener* listener) { listener->onScintillaLargeFileMode (this, state); });
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::beforeDelete ()
+{
+	cancelLoading ();
+	changeSets = nullptr;
+	backgroundLexing = nullptr;
+	undoTracking = nullptr;
+	leaveSharedDocument ();
+	CView::beforeDelete ();
+}
+
+//------------------------------------------------------------------------
+auto ScintillaEditorView::getSelection () const -> Range
+{
+	Range selection {};
+	selection.start = sendMessage (Message::GetSelectionStart);
+	selection.end = sendMessage (Message::GetSelectionEnd);
+	return selection;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setSelection (Range selection)
+{
+	sendMessage (Message::SetSelectionStart, selection.start);
+	sendMessage (Message::SetSelectionEnd, selection.end);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::selectAll ()
+{
+	sendMessage (Message::SelectAll);
+}
+
+//------------------------------------------------------------------------
+auto ScintillaEditorView::columnUnit (PositionUnit unit) const -> PositionUnit
+{
+	// scintilla counts code units only in UTF-8 documents
+	if (sendMessage (Message::GetCodePage) != SC_CP_UTF8)
+		return PositionUnit::Bytes;
+	return unit;
+}
+
+//------------------------------------------------------------------------
+intptr_t ScintillaEditorView::allocateLineCharacterIndex (PositionUnit unit) const
+{
+	auto index = static_cast<intptr_t> (unit == PositionUnit::UTF16
+	                                        ? Scintilla::LineCharacterIndexType::Utf16
+	                                        : Scintilla::LineCharacterIndexType::Utf32);
+	// the document keeps the index once it exists
+	if ((sendMessage (Message::GetLineCharacterIndex) & index) == 0)
+		sendMessage (Message::AllocateLineCharacterIndex, index);
+	return index;
+}
+
+//------------------------------------------------------------------------
+std::vector<int64_t> ScintillaEditorView::toBytePositions (
+    const std::vector<LinePosition>& positions, PositionUnit unit) const
+{
+	std::vector<int64_t> result (positions.size ());
+	if (positions.empty ())
+		return result;
+	auto text = getTextView ();
+	auto length = static_cast<int64_t> (text.size ());
+	auto numLines = static_cast<int64_t> (sendMessage (Message::GetLineCount));
+	auto order = sortedOrder (positions, [] (const LinePosition& a, const LinePosition& b) {
+		return a.line < b.line || (a.line == b.line && a.column < b.column);
+	});
+	LineWalker walker (text, columnUnit (unit));
+	int64_t line = -1;
+	for (auto index : order)
+	{
+		const auto& position = positions[index];
+		if (position.line >= numLines)
+		{
+			result[index] = length;
+			continue;
+		}
+		auto positionLine = std::max<int64_t> (position.line, 0);
+		if (positionLine != line)
+		{
+			line = positionLine;
+			walker.reset (sendMessage (Message::PositionFromLine, line),
+			              sendMessage (Message::GetLineEndPosition, line));
+		}
+		result[index] = walker.seekColumn (std::max<int64_t> (position.column, 0));
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+auto ScintillaEditorView::toLinePositions (const std::vector<int64_t>& positions,
+                                           PositionUnit unit) const -> std::vector<LinePosition>
+{
+	std::vector<LinePosition> result (positions.size ());
+	if (positions.empty ())
+		return result;
+	auto text = getTextView ();
+	auto length = static_cast<int64_t> (text.size ());
+	auto order = sortedOrder (positions, std::less<int64_t> ());
+	LineWalker walker (text, columnUnit (unit));
+	int64_t line = -1;
+	int64_t lineStart = 0;
+	int64_t nextLineStart = 0;
+	for (auto index : order)
+	{
+		auto position = std::clamp<int64_t> (positions[index], 0, length);
+		if (line < 0 || position < lineStart || position >= nextLineStart)
+		{
+			line = sendMessage (Message::LineFromPosition, position);
+			lineStart = sendMessage (Message::PositionFromLine, line);
+			nextLineStart = sendMessage (Message::PositionFromLine, line + 1);
+			if (nextLineStart < lineStart)
+				nextLineStart = length + 1;
+			// the line end characters are counted as well
+			walker.reset (lineStart, std::min (nextLineStart, length));
+		}
+		result[index] = {line, walker.seekPosition (position)};
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+std::vector<int64_t> ScintillaEditorView::indexToBytePositions (
+    const std::vector<int64_t>& positions, PositionUnit unit) const
+{
+	unit = columnUnit (unit);
+	if (unit == PositionUnit::Bytes)
+	{
+		auto length = static_cast<int64_t> (sendMessage (Message::GetTextLength));
+		std::vector<int64_t> result (positions.size ());
+		std::transform (
+		    positions.begin (), positions.end (), result.begin (),
+		    [&] (int64_t position) { return std::clamp<int64_t> (position, 0, length); });
+		return result;
+	}
+	auto index = allocateLineCharacterIndex (unit);
+	std::vector<LinePosition> linePositions;
+	linePositions.reserve (positions.size ());
+	for (auto position : positions)
+	{
+		position = std::max<int64_t> (position, 0);
+		auto line = static_cast<int64_t> (
+		    sendMessage (Message::LineFromIndexPosition, position, index));
+		auto lineStart = sendMessage (Message::IndexPositionFromLine, line, index);
+		linePositions.push_back ({line, position - lineStart});
+	}
+	return toBytePositions (linePositions, unit);
+}
+
+//------------------------------------------------------------------------
+std::vector<int64_t> ScintillaEditorView::byteToIndexPositions (
+    const std::vector<int64_t>& positions, PositionUnit unit) const
+{
+	unit = columnUnit (unit);
+	if (unit == PositionUnit::Bytes)
+		return indexToBytePositions (positions, unit);
+	auto index = allocateLineCharacterIndex (unit);
+	auto linePositions = toLinePositions (positions, unit);
+	std::vector<int64_t> result;
+	result.reserve (linePositions.size ());
+	int64_t line = -1;
+	int64_t lineStart = 0;
+	for (const auto& position : linePositions)
+	{
+		if (position.line != line)
+		{
+			line = position.line;
+			lineStart = sendMessage (Message::IndexPositionFromLine, line, index);
+		}
+		result.emplace_back (lineStart + position.column);
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+int64_t ScintillaEditorView::findAndSelect (UTF8StringPtr searchString, uint32_t searchFlags)
+{
+	auto sciSearchFlags = toFindOption (searchFlags);
+
+	auto selection = getSelection ();
+
+	if (!(searchFlags & Backwards))
+		sendMessage (Message::SetSelectionStart, selection.end);
+	sendMessage (Message::SearchAnchor);
+
+	intptr_t result;
+	if (searchFlags & Backwards)
+	{
+		result = sendMessage (Message::SearchPrev, sciSearchFlags, searchString);
+		if (result < 0 && searchFlags & Wrap)
+		{
+			auto textLength = sendMessage (Message::GetTextLength);
+			sendMessage (Message::SetSelectionStart, textLength);
+			sendMessage (Message::SetSelectionEnd, textLength);
+			sendMessage (Message::SearchAnchor);
+			result = sendMessage (Message::SearchPrev, sciSearchFlags, searchString);
+		}
+	}
+	else
+	{
+		result = sendMessage (Message::SearchNext, sciSearchFlags, searchString);
+		if (result < 0 && searchFlags & Wrap)
+		{
+			sendMessage (Message::SetSelectionStart);
+			sendMessage (Message::SetSelectionEnd);
+			sendMessage (Message::SearchAnchor);
+			result = sendMessage (Message::SearchNext, sciSearchFlags, searchString);
+		}
+	}
+	if (result >= 0)
+	{
+		if (searchFlags & ScrollTo)
+		{
+			sendMessage (Message::ScrollCaret);
+		}
+		return result;
+	}
+	setSelection (selection);
+
+	return -1;
+}
+
+//------------------------------------------------------------------------
+auto ScintillaEditorView::findAll (UTF8StringPtr searchString, uint32_t searchFlags) const
+    -> std::vector<Range>
+{
+	std::vector<Range> matches;
+	if (!searchString || *searchString == 0)
+		return matches;
+	if (searchFlags & RegularExpression)
+	{
+		RegexSearch regex (searchString, searchFlags);
+		regex.findAll (getTextView (), matches);
+		return matches;
+	}
+	TextSearch search (searchString, searchFlags);
+	if (!search.isSupported ())
+	{
+		findAllInTarget (*this, searchString, searchFlags, matches);
+		return matches;
+	}
+	if (searchFlags & (WholeWord | WordStart))
+		search.setCharClasses (getWordChars (), getWhitespaceChars (), getPunctuationChars ());
+	search.findAll (getTextView (), matches);
+	return matches;
+}
+
+//------------------------------------------------------------------------
+size_t ScintillaEditorView::countMatches (UTF8StringPtr searchString, uint32_t searchFlags) const
+{
+	if (!searchString || *searchString == 0)
+		return 0;
+	TextSearch search (searchString, searchFlags);
+	if (!search.isSupported () || (searchFlags & (WholeWord | WordStart)))
+		return findAll (searchString, searchFlags).size ();
+	return search.count (getTextView ());
+}
+
+//------------------------------------------------------------------------
+size_t ScintillaEditorView::replaceAll (UTF8StringPtr searchString, UTF8StringPtr replacement,
+                                       uint32_t searchFlags)
+{
+	if (sendMessage (Message::GetReadOnly))
+		return 0;
+	auto matches = findAll (searchString, searchFlags);
+	if (matches.empty ())
+		return 0;
+	std::string_view replacementView (replacement ? replacement : "");
+	auto start = matches.front ().start;
+	auto end = matches.back ().end;
+	auto text = getTextView ();
+	// append the text in [from, to) which may span the gap
+	auto append = [&] (std::string& str, int64_t from, int64_t to) {
+		auto firstSize = static_cast<int64_t> (text.first.size ());
+		if (from < firstSize)
+			str.append (text.first.substr (static_cast<size_t> (from),
+			                               static_cast<size_t> (std::min (to, firstSize) - from)));
+		if (to > firstSize)
+		{
+			from = std::max (from, firstSize);
+			str.append (text.second.substr (static_cast<size_t> (from - firstSize),
+			                                static_cast<size_t> (to - from)));
+		}
+	};
+
+	int64_t matchedBytes = 0;
+	for (const auto& match : matches)
+		matchedBytes += match.end - match.start;
+	std::string result;
+	result.reserve (static_cast<size_t> (end - start - matchedBytes) +
+	                matches.size () * replacementView.size ());
+	auto position = start;
+	for (const auto& match : matches)
+	{
+		append (result, position, match.start);
+		result.append (replacementView);
+		position = match.end;
+	}
+
+	// only the range from the first to the last changed byte is replaced, so the text around it
+	// keeps its markers, indicators and folds
+	auto firstSize = static_cast<int64_t> (text.first.size ());
+	auto charAt = [&] (int64_t pos) {
+		return pos < firstSize ? text.first[static_cast<size_t> (pos)]
+		                       : text.second[static_cast<size_t> (pos - firstSize)];
+	};
+	auto resultSize = static_cast<int64_t> (result.size ());
+	int64_t prefix = 0;
+	while (prefix < resultSize && start + prefix < end &&
+	       result[static_cast<size_t> (prefix)] == charAt (start + prefix))
+		++prefix;
+	int64_t suffix = 0;
+	while (suffix < resultSize - prefix && end - suffix > start + prefix &&
+	       result[static_cast<size_t> (resultSize - suffix - 1)] == charAt (end - suffix - 1))
+		++suffix;
+	if (prefix + suffix == resultSize && start + prefix == end - suffix)
+		return matches.size ();
+
+	sendMessage (Message::BeginUndoAction);
+	sendMessage (Message::SetTargetRange, start + prefix, end - suffix);
+	sendMessage (Message::ReplaceTarget, resultSize - prefix - suffix, result.data () + prefix);
+	sendMessage (Message::EndUndoAction);
+	return matches.size ();
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaEditorView::getWordChars () const
+{
+	std::string wordChars (static_cast<size_t> (sendMessage (Message::GetWordChars)), 0);
+	sendMessage (Message::GetWordChars, 0, wordChars.data ());
+	return wordChars;
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaEditorView::getWhitespaceChars () const
+{
+	std::string chars (static_cast<size_t> (sendMessage (Message::GetWhitespaceChars)), 0);
+	sendMessage (Message::GetWhitespaceChars, 0, chars.data ());
+	return chars;
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaEditorView::getPunctuationChars () const
+{
+	std::string chars (static_cast<size_t> (sendMessage (Message::GetPunctuationChars)), 0);
+	sendMessage (Message::GetPunctuationChars, 0, chars.data ());
+	return chars;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setFindHighlights (const std::vector<Range>& ranges)
+{
+	clearFindHighlights ();
+	for (const auto& range : ranges)
+		sendMessage (Message::IndicatorFillRange, range.start, range.end - range.start);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::clearFindHighlights ()
+{
+	sendMessage (Message::SetIndicatorCurrent, FindIndicator);
+	sendMessage (Message::IndicatorClearRange, 0, sendMessage (Message::GetTextLength));
+}
+
+//------------------------------------------------------------------------
+[[maybe_unused]] bool ScintillaEditorView::replaceSelection (UTF8StringPtr string)
+{
+	sendMessage (Message::ReplaceSel, 0, string);
+	return true;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setUseTabs (bool state)
+{
+	sendMessage (Message::SetUseTabs, state);
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::getUseTabs () const
+{
+	return sendMessage (Message::GetUseTabs) != 0;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setTabWidth (uint32_t width)
+{
+	sendMessage (Message::SetTabWidth, width);
+}
+
+//------------------------------------------------------------------------
+uint32_t ScintillaEditorView::getTabWidth () const
+{
+	return static_cast<uint32_t> (sendMessage (Message::GetTabWidth));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLexer (Scintilla::ILexer5* inLexer)
+{
+	if (inLexer)
+		setLexer (std::shared_ptr<Scintilla::ILexer5> (inLexer, [] (auto l) { l->Release (); }));
+	else
+		setLexer (std::shared_ptr<Scintilla::ILexer5> {});
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLexer (const std::shared_ptr<Scintilla::ILexer5>& inLexer)
+{
+	lexer = inLexer;
+	if (sharedDocument)
+	{
+		for (auto view : sharedDocument->views)
+			view->lexer = inLexer;
+	}
+	attachLexer ();
+}
+
+//------------------------------------------------------------------------
+Scintilla::ILexer5* ScintillaEditorView::getLexer () const
+{
+	return lexer.get ();
+}
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::BackgroundLexing
+{
+	/** the interval in milliseconds in which results are applied */
+	static constexpr uint32_t Interval = 16;
+	/** a job lexes at most this many bytes */
+	static constexpr int64_t MaxJobSize = 4 * 1024 * 1024;
+	/** bytes lexed beyond the requested position, so that scrolling does not wait */
+	static constexpr int64_t LookAhead = 64 * 1024;
+	/** at most this many styles and lines are applied per interval */
+	static constexpr size_t StylesPerBatch = 1024 * 1024;
+	static constexpr size_t LinesPerBatch = 16 * 1024;
+	/** the styles of the previous line which are copied into a job */
+	static constexpr int64_t MaxPreviousStyles = 1024;
+
+	explicit BackgroundLexing (const std::shared_ptr<Scintilla::ILexer5>& lexer) : worker (lexer)
+	{
+	}
+
+	BackgroundLexer worker;
+	SharedPointer<CVSTGUITimer> timer;
+	/** the result which is currently applied */
+	std::optional<BackgroundLexer::Result> result;
+	size_t appliedStyles {0};
+	size_t appliedLines {0};
+	/** the position up to which scintilla wants the document styled */
+	int64_t target {0};
+};
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::BackgroundLexingDeleter::operator() (
+    BackgroundLexing* lexing) const noexcept
+{
+	if (lexing->timer)
+		lexing->timer->stop ();
+	// waits for the running job
+	delete lexing;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setBackgroundLexing (bool state)
+{
+	if (lexInBackground == state)
+		return;
+	lexInBackground = state;
+	attachLexer ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::attachLexer ()
+{
+	backgroundLexing = nullptr;
+	// a document without styles can not be lexed
+	auto stylesNone = sendMessage (Message::GetDocumentOptions) &
+	                  static_cast<intptr_t> (DocumentOption::StylesNone);
+	if (!lexer || largeFile || stylesNone)
+	{
+		sendMessage (Message::SetILexer, 0, nullptr);
+		return;
+	}
+	// the views of a shared document would run the lexer on several threads
+	if (!lexInBackground || sharedDocument)
+	{
+		sendMessage (Message::SetILexer, 0, new LexerReference (lexer));
+		return;
+	}
+	// without a lexer scintilla asks for styles with the StyleNeeded notification
+	sendMessage (Message::SetILexer, 0, nullptr);
+	backgroundLexing =
+	    std::unique_ptr<BackgroundLexing, BackgroundLexingDeleter> (new BackgroundLexing (lexer));
+	sendMessage (Message::StartStyling, 0);
+}
+
+//------------------------------------------------------------------------
+void* ScintillaEditorView::getDocument () const
+{
+	return reinterpret_cast<void*> (sendMessage (Message::GetDocPointer));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setDocument (void* document, bool inheritSettings)
+{
+	if (document == getDocument ())
+		return;
+	cancelLoading ();
+	leaveSharedDocument ();
+	switchDocument (document, inheritSettings);
+	if (!inheritSettings)
+	{
+		if (lexer)
+			attachLexer ();
+		updateMarginsColumns ();
+	}
+	updateLargeFileMode ();
+	notifyDocumentChanged ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::readDocument (void* document,
+                                        const std::function<void (const TextView&)>& proc)
+{
+	auto current = getDocument ();
+	if (document == current)
+	{
+		proc (getTextView ());
+		return;
+	}
+	// scintilla only reads the text of the document it shows, the document is shown without
+	// being changed, so the view does not need to know about it
+	auto selection = getSelection ();
+	auto firstVisibleLine = sendMessage (Message::GetFirstVisibleLine);
+	auto xOffset = sendMessage (Message::GetXOffset);
+	sendMessage (Message::AddRefDocument, 0, current);
+	sendMessage (Message::SetDocPointer, 0, document);
+	proc (getTextView ());
+	sendMessage (Message::SetDocPointer, 0, current);
+	sendMessage (Message::ReleaseDocument, 0, current);
+	setSelection (selection);
+	sendMessage (Message::SetFirstVisibleLine, firstVisibleLine);
+	sendMessage (Message::SetXOffset, xOffset);
+}
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::SharedDocument
+{
+	std::vector<ScintillaEditorView*> views;
+};
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::attachDocument (ScintillaEditorView& other)
+{
+	if (&other == this || other.isLoading ())
+		return false;
+	if (sharedDocument && sharedDocument == other.sharedDocument)
+		return true;
+	cancelLoading ();
+	leaveSharedDocument ();
+	if (!other.sharedDocument)
+	{
+		other.sharedDocument = std::make_shared<SharedDocument> ();
+		other.sharedDocument->views.emplace_back (&other);
+	}
+	sharedDocument = other.sharedDocument;
+	sharedDocument->views.emplace_back (this);
+
+	// the document keeps its own settings, SetDocPointer adds a reference for this view
+	backgroundLexing = nullptr;
+	auto document = reinterpret_cast<void*> (other.sendMessage (Message::GetDocPointer));
+	switchDocument (document, false);
+	lexer = other.lexer;
+	lexInBackground = other.lexInBackground;
+	other.attachLexer ();
+	updateMarginsColumns ();
+	updateLargeFileMode ();
+	notifyDocumentChanged ();
+	return true;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::detachDocument ()
+{
+	if (!sharedDocument)
+		return;
+	cancelLoading ();
+	leaveSharedDocument ();
+	auto options = sendMessage (Message::GetDocumentOptions) &
+	               ~static_cast<intptr_t> (DocumentOption::StylesNone);
+	auto document = reinterpret_cast<void*> (sendMessage (Message::CreateDocument, 0, options));
+	switchDocument (document, true);
+	sendMessage (Message::ReleaseDocument, 0, document);
+	updateLargeFileMode ();
+	notifyDocumentChanged ();
+}
+
+//------------------------------------------------------------------------
+size_t ScintillaEditorView::getNumDocumentViews () const
+{
+	return sharedDocument ? sharedDocument->views.size () : 1;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::leaveSharedDocument ()
+{
+	if (!sharedDocument)
+		return;
+	auto& views = sharedDocument->views;
+	views.erase (std::remove (views.begin (), views.end (), this), views.end ());
+	// the lexer stays with the document, a last view may run it on its worker thread again
+	lexer = nullptr;
+	backgroundLexing = nullptr;
+	if (views.size () == 1)
+	{
+		auto last = views.front ();
+		last->sharedDocument = nullptr;
+		last->attachLexer ();
+	}
+	sharedDocument = nullptr;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::requestLexing (int64_t position)
+{
+	backgroundLexing->target = std::max (backgroundLexing->target, position);
+	// the next job is started when the current one was applied
+	if (backgroundLexing->worker.isBusy () || backgroundLexing->result)
+		return;
+	startLexJob ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::startLexJob ()
+{
+	auto& lexing = *backgroundLexing;
+	auto length = static_cast<int64_t> (sendMessage (Message::GetTextLength));
+	auto target = std::min (lexing.target, length);
+	auto endStyled = static_cast<int64_t> (sendMessage (Message::GetEndStyled));
+	if (endStyled >= target)
+	{
+		lexing.target = 0;
+		return;
+	}
+
+	// lex whole lines like scintilla does
+	BackgroundLexer::Job job;
+	job.startLine = sendMessage (Message::LineFromPosition, endStyled);
+	job.start = sendMessage (Message::PositionFromLine, job.startLine);
+	auto end = std::min ({length, target + BackgroundLexing::LookAhead,
+	                      job.start + BackgroundLexing::MaxJobSize});
+	auto endLine = static_cast<int64_t> (sendMessage (Message::LineFromPosition, end));
+	job.end = endLine + 1 < sendMessage (Message::GetLineCount)
+	              ? static_cast<int64_t> (sendMessage (Message::PositionFromLine, endLine + 1))
+	              : length;
+	job.initStyle =
+	    job.start > 0 ? static_cast<int> (sendMessage (Message::GetStyleAt, job.start - 1)) : 0;
+	if (job.startLine > 0)
+	{
+		auto previousLine = job.startLine - 1;
+		job.previousLineStart = sendMessage (Message::PositionFromLine, previousLine);
+		auto from =
+		    std::max (job.previousLineStart, job.start - BackgroundLexing::MaxPreviousStyles);
+		for (auto pos = from; pos < job.start; ++pos)
+			job.previousStyles.push_back (
+			    static_cast<char> (sendMessage (Message::GetStyleAt, pos)));
+		job.previousLineState =
+		    static_cast<int> (sendMessage (Message::GetLineState, previousLine));
+		job.previousLevel = static_cast<int> (sendMessage (Message::GetFoldLevel, previousLine));
+	}
+	job.codePage = static_cast<int> (sendMessage (Message::GetCodePage));
+	job.tabWidth = static_cast<int> (sendMessage (Message::GetTabWidth));
+	job.snapshot = createSnapshot ();
+
+	if (job.codePage != 0 && job.codePage != SC_CP_UTF8)
+	{
+		// the snapshot document does not know the lead bytes of double byte code pages
+		lexing.result = BackgroundLexer::run (*lexer, job);
+		lexing.appliedStyles = lexing.appliedLines = 0;
+	}
+	else
+		lexing.worker.post (std::move (job));
+
+	// timers need a frame, the results of a view which is not attached are applied once it is
+	// attached
+	if (isAttached ())
+		startLexingTimer ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::startLexingTimer ()
+{
+	auto& lexing = *backgroundLexing;
+	if (!lexing.timer)
+		lexing.timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) { applyLexResult (); },
+		                                        BackgroundLexing::Interval, false);
+	// does nothing if the timer is already running
+	lexing.timer->start ();
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::applyLexResult ()
+{
+	auto& lexing = *backgroundLexing;
+	if (!lexing.result)
+	{
+		lexing.result = lexing.worker.takeResult ();
+		lexing.appliedStyles = lexing.appliedLines = 0;
+		if (!lexing.result)
+		{
+			if (!lexing.worker.isBusy () && lexing.timer)
+				lexing.timer->stop ();
+			return false;
+		}
+	}
+
+	auto& result = *lexing.result;
+	if (result.version != createSnapshot ()->getVersion ())
+	{
+		// the document changed meanwhile
+		lexing.result.reset ();
+		startLexJob ();
+		return true;
+	}
+
+	auto numStyles = std::min (BackgroundLexing::StylesPerBatch,
+	                           result.styles.size () - lexing.appliedStyles);
+	if (numStyles > 0)
+	{
+		sendMessage (Message::StartStyling, result.start + lexing.appliedStyles);
+		sendMessage (Message::SetStylingEx, numStyles,
+		             result.styles.data () + lexing.appliedStyles);
+		lexing.appliedStyles += numStyles;
+	}
+	auto numLines = std::max (result.levels.size (), result.lineStates.size ());
+	auto lastLine = std::min (numLines, lexing.appliedLines + BackgroundLexing::LinesPerBatch);
+	for (auto index = lexing.appliedLines; index < lastLine; ++index)
+	{
+		auto line = result.startLine + static_cast<int64_t> (index);
+		if (index < result.levels.size () && result.levels[index])
+			sendMessage (Message::SetFoldLevel, line, *result.levels[index]);
+		if (index < result.lineStates.size () && result.lineStates[index])
+			sendMessage (Message::SetLineState, line, *result.lineStates[index]);
+	}
+	lexing.appliedLines = lastLine;
+
+	if (lexing.appliedStyles == result.styles.size () && lexing.appliedLines == numLines)
+	{
+		lexing.result.reset ();
+		// continue if scintilla wants more than this job lexed
+		startLexJob ();
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::flushBackgroundLexing ()
+{
+	if (!backgroundLexing)
+		return;
+	do
+	{
+		backgroundLexing->worker.wait ();
+	} while (applyLexResult ());
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineWrap (Scintilla::Wrap mode)
+{
+	sendMessage (Message::SetWrapMode, mode);
+}
+
+//------------------------------------------------------------------------
+auto ScintillaEditorView::getLineWrap () const -> Scintilla::Wrap
+{
+	return static_cast<Scintilla::Wrap> (sendMessage (Message::GetWrapMode));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineWrapStartIndent (uint32_t amount)
+{
+	sendMessage (Message::SetWrapStartIndent, amount);
+}
+
+//------------------------------------------------------------------------
+uint32_t ScintillaEditorView::getLineWrapStartIndent () const
+{
+	return static_cast<uint32_t> (sendMessage (Message::GetWrapStartIndent));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineWrapIndentMode (Scintilla::WrapIndentMode mode)
+{
+	sendMessage (Message::SetWrapIndentMode, mode);
+}
+
+//------------------------------------------------------------------------
+Scintilla::WrapIndentMode ScintillaEditorView::getLineWrapIndentMode () const
+{
+	return static_cast<Scintilla::WrapIndentMode> (sendMessage (Message::GetWrapIndentMode));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineWrapVisualFlags (WrapVisualFlag flags)
+{
+	sendMessage (Message::SetWrapVisualFlags, flags);
+}
+
+//------------------------------------------------------------------------
+WrapVisualFlag ScintillaEditorView::getLineWrapVisualFlags () const
+{
+	return static_cast<WrapVisualFlag> (sendMessage (Message::GetWrapVisualFlags));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineNumbersVisible (bool state)
+{
+	auto currentState = (marginsCol & (1 << MarginsCol::LineNumber)) != 0;
+	if (currentState == state)
+		return;
+	if (state)
+		marginsCol |= (1 << MarginsCol::LineNumber);
+	else
+		marginsCol &= ~(1 << MarginsCol::LineNumber);
+
+	updateMarginsColumns ();
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineWrapStartIndent (uint32_t amount)
+bool ScintillaEditorView::getLineNumbersVisible () const
 {
-	sendMessage (Message::SetWrapStartIndent, amount);
+	return (marginsCol & (1 << MarginsCol::LineNumber));
 }
 
 //------------------------------------------------------------------------
-uint32_t ScintillaEditorView::getLineWrapStartIndent () const
+void ScintillaEditorView::setLineNumberForegroundColor (const CColor& color)
 {
-	return static_cast<uint32_t> (sendMessage (Message::GetWrapStartIndent));
+	modifyTheme (
+	    [&] (ScintillaTheme& t) { t.setStyleForeground (LineNumberStyle, color); });
+}
+
+//------------------------------------------------------------------------
+CColor ScintillaEditorView::getLineNumberForegroundColor () const
+{
+	return fromScintillaColor (sendMessage (Message::StyleGetFore, StylesCommon::LineNumber));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setLineNumberBackgroundColor (const CColor& color)
+{
+	modifyTheme (
+	    [&] (ScintillaTheme& t) { t.setStyleBackground (LineNumberStyle, color); });
+}
+
+//------------------------------------------------------------------------
+CColor ScintillaEditorView::getLineNumberBackgroundColor () const
+{
+	return fromScintillaColor (sendMessage (Message::StyleGetBack, StylesCommon::LineNumber));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setFoldingVisible (bool state)
+{
+	auto currentState = (marginsCol & (1 << MarginsCol::Folding)) != 0;
+	if (currentState == state)
+		return;
+	if (state)
+	{
+		marginsCol |= (1 << MarginsCol::Folding);
+	}
+	else
+	{
+		marginsCol &= ~(1 << MarginsCol::Folding);
+	}
+
+	updateMarginsColumns ();
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::getFoldingVisible () const
+{
+	return (marginsCol & (1 << MarginsCol::Folding));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setDefaultFoldDisplayText (UTF8StringPtr text)
+{
+	sendMessage (Message::SetDefaultFoldDisplayText, 0, text);
+}
+
+//------------------------------------------------------------------------
+UTF8String ScintillaEditorView::getDefaultFoldDisplayText () const
+{
+	std::string str;
+	auto length = sendMessage (Message::GetDefaultFoldDisplayText);
+	if (length > 0)
+	{
+		str.resize (length);
+		sendMessage (Message::GetDefaultFoldDisplayText, length + 1, str.data ());
+	}
+	return UTF8String (std::move (str));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setFoldDisplayTextStyle (Scintilla::FoldDisplayTextStyle style)
+{
+	sendMessage (Scintilla::Message::FoldDisplayTextSetStyle, style);
+}
+
+//------------------------------------------------------------------------
+Scintilla::FoldDisplayTextStyle ScintillaEditorView::getFoldDisplayTextStyle () const
+{
+	return static_cast<Scintilla::FoldDisplayTextStyle> (
+	    sendMessage (Scintilla::Message::FoldDisplayTextGetStyle));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setFoldMarginColorHi (const CColor& color)
+{
+	foldMarginColorHi = color;
+	sendMessage (Message::SetFoldMarginHiColour, true, toScintillaColor (color));
+}
+
+//------------------------------------------------------------------------
+CColor ScintillaEditorView::getFoldMarginColorHi () const
+{
+	return foldMarginColorHi;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setFoldMarginColor (const CColor& color)
+{
+	foldMarginColor = color;
+	sendMessage (Message::SetFoldMarginColour, true, toScintillaColor (color));
+}
+
+//------------------------------------------------------------------------
+CColor ScintillaEditorView::getFoldMarginColor () const
+{
+	return foldMarginColor;
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::showLineNumberMargin () const
+{
+	return (marginsCol & (1 << MarginsCol::LineNumber));
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::showFoldMargin () const
+{
+	return (marginsCol & (1 << MarginsCol::Folding));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setZoom (int32_t zoom)
+{
+	sendMessage (Message::SetZoom, zoom);
+}
+
+//------------------------------------------------------------------------
+int32_t ScintillaEditorView::getZoom () const
+{
+	return static_cast<int32_t> (sendMessage (Message::GetZoom));
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::updateLineNumberMarginWidth ()
+{
+	if (showLineNumberMargin ())
+	{
+		auto lineCount = static_cast<uint32_t> (sendMessage (Message::GetLineCount));
+		std::string str = "_99";
+		while ((lineCount /= 10) >= 10)
+		{
+			str += "9";
+		}
+		auto width = sendMessage (Message::TextWidth, StylesCommon::LineNumber, str.data ());
+		sendMessage (Message::SetMarginWidthN, 0, width);
+	}
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::updateMarginsColumns ()
+{
+	auto lineNumbers = showLineNumberMargin ();
+	auto folding = showFoldMargin ();
+
+	auto count = 0;
+	if (lineNumbers)
+		++count;
+	if (folding)
+		++count;
+
+	sendMessage (Message::SetMargins, count);
+	uint32_t column = 0;
+	if (lineNumbers)
+	{
+		sendMessage (Message::SetMarginTypeN, column, Scintilla::MarginType::Number);
+		updateLineNumberMarginWidth ();
+		++column;
+	}
+	if (folding)
+	{
+		auto scaleFactor = 1.;
+		if (auto frame = getFrame ())
+			scaleFactor = frame->getZoom ();
+		auto width = static_cast<int32_t> (std::ceil (16. * scaleFactor));
+		sendMessage (Message::SetMarginTypeN, column, Scintilla::MarginType::Symbol);
+		sendMessage (Message::SetMarginMaskN, column, Scintilla::MaskFolders);
+		sendMessage (Message::SetMarginWidthN, column, width + getZoom ());
+		sendMessage (Message::SetMarginSensitiveN, column, 1);
+
+		sendMessage (Message::MarkerDefine, MarkerOutline::Folder, MarkerSymbol::Arrow);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderOpen, MarkerSymbol::ArrowDown);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderEnd, MarkerSymbol::Empty);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderMidTail, MarkerSymbol::Empty);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderOpenMid, MarkerSymbol::Empty);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderSub, MarkerSymbol::Empty);
+		sendMessage (Message::MarkerDefine, MarkerOutline::FolderTail, MarkerSymbol::Empty);
+
+		sendMessage (Message::SetAutomaticFold,
+		             AutomaticFold::Show | AutomaticFold::Change | AutomaticFold::Click);
+	}
+	if (count == 0)
+	{
+		sendMessage (Message::SetMarginWidthN, 0, 0);
+		// the following is a workaround so that the margins are removed immediately on macOS
+		auto size = getViewSize ();
+		size.right--;
+		setViewSize (size, false);
+		size.right++;
+		setViewSize (size, false);
+	}
+}
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::Listeners
+{
+	struct Entry
+	{
+		IScintillaListener* listener;
+		ScintillaNotificationFilter filter;
+		bool active {true};
+	};
+	using EntryPtr = std::shared_ptr<Entry>;
+
+	/** notification codes start at 2000, all other codes share the last slot */
+	static constexpr uint32_t FirstCode = 2000;
+	static constexpr uint32_t NumCodes = 64;
+	using Table = std::array<std::vector<EntryPtr>, NumCodes + 1>;
+
+	static size_t slot (uint32_t code)
+	{
+		return (code >= FirstCode && code < FirstCode + NumCodes) ? code - FirstCode : NumCodes;
+	}
+
+	/** rebuild the per code table. A dispatch in progress keeps using the old table */
+	void rebuild ()
+	{
+		auto newTable = std::make_shared<Table> ();
+		for (const auto& entry : entries)
+		{
+			for (uint32_t index = 0; index < NumCodes; ++index)
+			{
+				if (entry->filter.wantsCode (FirstCode + index))
+					(*newTable)[index].emplace_back (entry);
+			}
+			// codes outside of the known range are only delivered to unfiltered listeners
+			if (entry->filter.codes.empty ())
+				(*newTable)[NumCodes].emplace_back (entry);
+		}
+		table = std::move (newTable);
+	}
+
+	std::vector<EntryPtr> entries;
+	std::shared_ptr<const Table> table;
+};
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::ListenersDeleter::operator() (Listeners* l) const noexcept
+{
+	delete l;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::registerListener (IScintillaListener* listener)
+{
+	registerListener (listener, {});
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::registerListener (IScintillaListener* listener,
+                                            const ScintillaNotificationFilter& filter)
+{
+	if (!listeners)
+		listeners = std::unique_ptr<Listeners, ListenersDeleter> (new Listeners);
+	auto entry = std::make_shared<Listeners::Entry> ();
+	entry->listener = listener;
+	entry->filter = filter;
+	listeners->entries.emplace_back (std::move (entry));
+	listeners->rebuild ();
+	updateModEventMask ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::unregisterListener (IScintillaListener* listener)
+{
+	if (!listeners)
+		return;
+	auto& entries = listeners->entries;
+	auto it = std::find_if (entries.begin (), entries.end (),
+	                        [&] (const auto& entry) { return entry->listener == listener; });
+	if (it == entries.end ())
+		return;
+	(*it)->active = false;
+	entries.erase (it);
+	listeners->rebuild ();
+	updateModEventMask ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::forEachListener (const std::function<void (IScintillaListener*)>& proc)
+{
+	if (!listeners)
+		return;
+	auto entries = listeners->entries;
+	for (const auto& entry : entries)
+	{
+		if (entry->active)
+			proc (entry->listener);
+	}
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::notifyDocumentChanged ()
+{
+	forEachListener (
+	    [this] (IScintillaListener* listener) { listener->onScintillaDocumentChanged (this); });
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::dispatchNotification (SCNotification* notification)
+{
+	if (!listeners)
+		return;
+	auto code = static_cast<uint32_t> (notification->nmhdr.code);
+	auto table = listeners->table;
+	const auto& entries = (*table)[Listeners::slot (code)];
+	if (entries.empty ())
+		return;
+	auto isModified = code == static_cast<uint32_t> (Notification::Modified);
+	auto modificationType = static_cast<uint32_t> (notification->modificationType);
+	for (const auto& entry : entries)
+	{
+		if (!entry->active)
+			continue;
+		if (isModified && (entry->filter.modificationFlags & modificationType) == 0)
+			continue;
+		entry->listener->onScintillaNotification (notification);
+	}
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineWrapIndentMode (Scintilla::WrapIndentMode mode)
+void ScintillaEditorView::updateModEventMask ()
 {
-	sendMessage (Message::SetWrapIndentMode, mode);
+	uint32_t mask = 0;
+	for (const auto& entry : listeners->entries)
+	{
+		if (entry->filter.wantsCode (static_cast<uint32_t> (Notification::Modified)))
+			mask |= entry->filter.modificationFlags;
+	}
+	// scintilla does not create Modified notifications nobody is interested in
+	sendMessage (Message::SetModEventMask, mask);
 }
 
 //------------------------------------------------------------------------
-Scintilla::WrapIndentMode ScintillaEditorView::getLineWrapIndentMode () const
+struct ScintillaEditorView::ChangeSetChannel
 {
-	return static_cast<Scintilla::WrapIndentMode> (sendMessage (Message::GetWrapIndentMode));
-}
+	/** about one frame */
+	static constexpr uint32_t Interval = 16;
+
+	DispatchList<IScintillaChangeSetListener*> listeners;
+	ScintillaChangeSetBuilder builder;
+	SharedPointer<CVSTGUITimer> timer;
+
+	~ChangeSetChannel () noexcept
+	{
+		if (timer)
+			timer->stop ();
+	}
+};
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineWrapVisualFlags (WrapVisualFlag flags)
+void ScintillaEditorView::ChangeSetChannelDeleter::operator() (
+    ChangeSetChannel* channel) const noexcept
 {
-	sendMessage (Message::SetWrapVisualFlags, flags);
+	delete channel;
 }
 
 //------------------------------------------------------------------------
-WrapVisualFlag ScintillaEditorView::getLineWrapVisualFlags () const
+void ScintillaEditorView::registerChangeSetListener (IScintillaChangeSetListener* listener)
 {
-	return static_cast<WrapVisualFlag> (sendMessage (Message::GetWrapVisualFlags));
+	if (!changeSets)
+		changeSets = std::unique_ptr<ChangeSetChannel, ChangeSetChannelDeleter> (
+		    new ChangeSetChannel);
+	changeSets->listeners.add (listener);
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineNumbersVisible (bool state)
+void ScintillaEditorView::unregisterChangeSetListener (IScintillaChangeSetListener* listener)
 {
-	auto currentState = (marginsCol & (1 << MarginsCol::LineNumber)) != 0;
-	if (currentState == state)
+	if (!changeSets)
 		return;
-	if (state)
-		marginsCol |= (1 << MarginsCol::LineNumber);
-	else
-		marginsCol &= ~(1 << MarginsCol::LineNumber);
-
-	updateMarginsColumns ();
+	changeSets->listeners.remove (listener);
+	if (changeSets->listeners.empty ())
+		changeSets = nullptr;
 }
 
 //------------------------------------------------------------------------
-bool ScintillaEditorView::getLineNumbersVisible () const
+void ScintillaEditorView::collectChange (SCNotification* notification)
 {
-	return (marginsCol & (1 << MarginsCol::LineNumber));
+	auto& builder = changeSets->builder;
+	if (notification->modificationType & SC_MOD_INSERTTEXT)
+		builder.insert (notification->position, notification->length, notification->linesAdded);
+	else if (notification->modificationType & SC_MOD_DELETETEXT)
+		builder.remove (notification->position, notification->length, notification->linesAdded);
+	else
+		return;
+	// timers need a frame, the changes of a view which is not attached are delivered once it is
+	// attached
+	if (isAttached ())
+		startChangeSetTimer ();
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineNumberForegroundColor (const CColor& color)
+void ScintillaEditorView::startChangeSetTimer ()
 {
-	sendMessage (Message::StyleSetFore, StylesCommon::LineNumber, toScintillaColor (color));
+	if (!changeSets->timer)
+		changeSets->timer = makeOwned<CVSTGUITimer> (
+		    [this] (CVSTGUITimer*) { flushChangeSet (); }, ChangeSetChannel::Interval, false);
+	// does nothing if the timer is already running
+	changeSets->timer->start ();
 }
 
 //------------------------------------------------------------------------
-CColor ScintillaEditorView::getLineNumberForegroundColor () const
+void ScintillaEditorView::trackSnapshotChange (SCNotification* notification)
 {
-	return fromScintillaColor (sendMessage (Message::StyleGetFore, StylesCommon::LineNumber));
+	auto position = static_cast<size_t> (notification->position);
+	auto length = static_cast<size_t> (notification->length);
+	if (notification->modificationType & SC_MOD_INSERTTEXT)
+	{
+		if (notification->text)
+			snapshots->insert (position, notification->text, length);
+		else
+			snapshots->invalidate ();
+	}
+	else if (notification->modificationType & SC_MOD_DELETETEXT)
+		snapshots->remove (position, length);
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setLineNumberBackgroundColor (const CColor& color)
+void ScintillaEditorView::flushChangeSet ()
 {
-	sendMessage (Message::StyleSetBack, StylesCommon::LineNumber, toScintillaColor (color));
+	if (!changeSets)
+		return;
+	if (changeSets->timer)
+		changeSets->timer->stop ();
+	if (changeSets->builder.empty ())
+		return;
+	auto changeSet = changeSets->builder.take ();
+	changeSets->listeners.forEach (
+	    [&] (auto& listener) { listener->onScintillaChangeSet (this, changeSet); });
 }
 
 //------------------------------------------------------------------------
-CColor ScintillaEditorView::getLineNumberBackgroundColor () const
+struct ScintillaEditorView::Diagnostics
 {
-	return fromScintillaColor (sendMessage (Message::StyleGetBack, StylesCommon::LineNumber));
-}
+	struct Underline
+	{
+		int64_t startColumn;
+		int64_t endColumn;
+		uint32_t severity;
 
-//------------------------------------------------------------------------
-void ScintillaEditorView::setFoldingVisible (bool state)
-{
-	auto currentState = (marginsCol & (1 << MarginsCol::Folding)) != 0;
-	if (currentState == state)
-		return;
-	if (state)
+		bool operator== (const Underline& o) const
+		{
+			return startColumn == o.startColumn && endColumn == o.endColumn &&
+			       severity == o.severity;
+		}
+	};
+
+	/** what is applied to one line */
+	struct Line
 	{
-		marginsCol |= (1 << MarginsCol::Folding);
+		int64_t line {0};
+		/** one bit per severity */
+		uint32_t markers {0};
+		uint32_t annotationSeverity {0};
+		std::string annotation;
+		std::vector<Underline> underlines;
+
+		bool operator== (const Line& o) const
+		{
+			return line == o.line && markers == o.markers &&
+			       annotationSeverity == o.annotationSeverity && annotation == o.annotation &&
+			       underlines == o.underlines;
+		}
+		bool operator!= (const Line& o) const { return !(*this == o); }
+	};
+
+	/** sorted by line */
+	std::vector<Line> lines;
+	/** lines edited since the diagnostics were applied */
+	std::vector<int64_t> dirtyLines;
+	/** too many lines were edited since the diagnostics were applied */
+	bool reapplyAll {false};
+	intptr_t styleOffset {0};
+
+	static std::vector<Line> build (const std::vector<ScintillaDiagnostic>& diagnostics)
+	{
+		std::vector<const ScintillaDiagnostic*> sorted;
+		sorted.reserve (diagnostics.size ());
+		for (const auto& diagnostic : diagnostics)
+			sorted.emplace_back (&diagnostic);
+		auto byLine = [] (auto a, auto b) { return a->line < b->line; };
+		// diagnostics of a compiler are usually sorted already
+		if (!std::is_sorted (sorted.begin (), sorted.end (), byLine))
+			std::stable_sort (sorted.begin (), sorted.end (), byLine);
+
+		std::vector<Line> result;
+		for (auto diagnostic : sorted)
+		{
+			if (diagnostic->line < 0)
+				continue;
+			if (result.empty () || result.back ().line != diagnostic->line)
+			{
+				result.emplace_back ();
+				result.back ().line = diagnostic->line;
+			}
+			auto& line = result.back ();
+			auto severity = static_cast<uint32_t> (diagnostic->severity);
+			line.markers |= 1 << severity;
+			if (!diagnostic->message.empty ())
+			{
+				if (!line.annotation.empty ())
+					line.annotation += "\n";
+				line.annotation += diagnostic->message;
+				line.annotationSeverity = std::max (line.annotationSeverity, severity);
+			}
+			if (diagnostic->endColumn > diagnostic->startColumn)
+				line.underlines.push_back (
+				    {diagnostic->startColumn, diagnostic->endColumn, severity});
+		}
+		return result;
 	}
-	else
+
+	/** line was edited, linesAdded lines were added or removed after it */
+	void edited (int64_t line, int64_t linesAdded)
 	{
-		marginsCol &= ~(1 << MarginsCol::Folding);
+		auto numEdited = static_cast<size_t> (std::max<int64_t> (linesAdded, 0)) + 1;
+		if (dirtyLines.size () + numEdited > MaxDirtyDiagnosticLines)
+		{
+			reapplyAll = true;
+			return;
+		}
+		if (linesAdded != 0)
+		{
+			// markers and annotations move with their lines, the stored line numbers don't. The
+			// markers of removed lines join the edited line, which is cleared as dirty line.
+			auto removedEnd = line - std::min<int64_t> (linesAdded, 0);
+			auto it = std::upper_bound (lines.begin (), lines.end (), line,
+			                            [] (auto l, const Line& entry) { return l < entry.line; });
+			if (linesAdded < 0)
+			{
+				auto last = std::upper_bound (
+				    it, lines.end (), removedEnd,
+				    [] (auto l, const Line& entry) { return l < entry.line; });
+				it = lines.erase (it, last);
+			}
+			for (; it != lines.end (); ++it)
+				it->line += linesAdded;
+			for (auto& dirty : dirtyLines)
+			{
+				if (dirty > removedEnd)
+					dirty += linesAdded;
+				else if (dirty > line)
+					dirty = line;
+			}
+		}
+		// the text of the edited line may be split into the added lines
+		for (size_t i = 0; i < numEdited; ++i)
+			dirtyLines.emplace_back (line + static_cast<int64_t> (i));
 	}
 
-	updateMarginsColumns ();
-}
+	/** remove all diagnostics from a line, also those which moved there with an edit */
+	static void clearLine (ScintillaEditorView& view, int64_t line)
+	{
+		if (line >= view.sendMessage (Message::GetLineCount))
+			return;
+		auto start = view.sendMessage (Message::PositionFromLine, line);
+		auto length = view.sendMessage (Message::LineLength, line);
+		for (uint32_t severity = 0; severity < NumSeverities; ++severity)
+		{
+			view.sendMessage (Message::MarkerDelete, line, FirstDiagnosticMarker + severity);
+			view.sendMessage (Message::SetIndicatorCurrent, FirstDiagnosticIndicator + severity);
+			view.sendMessage (Message::IndicatorClearRange, start, length);
+		}
+		view.sendMessage (Message::AnnotationSetText, line, 0);
+	}
+
+	static void clear (ScintillaEditorView& view, const Line& line)
+	{
+		for (uint32_t severity = 0; severity < NumSeverities; ++severity)
+		{
+			if (line.markers & (1 << severity))
+				view.sendMessage (Message::MarkerDelete, line.line,
+				                  FirstDiagnosticMarker + severity);
+		}
+		if (!line.annotation.empty ())
+			view.sendMessage (Message::AnnotationSetText, line.line, 0);
+		if (!line.underlines.empty ())
+		{
+			auto start = view.sendMessage (Message::PositionFromLine, line.line);
+			auto length = view.sendMessage (Message::LineLength, line.line);
+			for (const auto& underline : line.underlines)
+			{
+				view.sendMessage (Message::SetIndicatorCurrent,
+				                  FirstDiagnosticIndicator + underline.severity);
+				view.sendMessage (Message::IndicatorClearRange, start, length);
+			}
+		}
+	}
+
+	static void apply (ScintillaEditorView& view, const Line& line)
+	{
+		if (line.line >= view.sendMessage (Message::GetLineCount))
+			return;
+		for (uint32_t severity = 0; severity < NumSeverities; ++severity)
+		{
+			if (line.markers & (1 << severity))
+				view.sendMessage (Message::MarkerAdd, line.line, FirstDiagnosticMarker + severity);
+		}
+		if (!line.annotation.empty ())
+		{
+			view.sendMessage (Message::AnnotationSetText, line.line, line.annotation.data ());
+			view.sendMessage (Message::AnnotationSetStyle, line.line, line.annotationSeverity);
+		}
+		if (!line.underlines.empty ())
+		{
+			auto start = view.sendMessage (Message::PositionFromLine, line.line);
+			auto length = view.sendMessage (Message::LineLength, line.line);
+			for (const auto& underline : line.underlines)
+			{
+				auto from = std::min<int64_t> (underline.startColumn, length);
+				auto to = std::min<int64_t> (underline.endColumn, length);
+				if (to <= from)
+					continue;
+				view.sendMessage (Message::SetIndicatorCurrent,
+				                  FirstDiagnosticIndicator + underline.severity);
+				view.sendMessage (Message::IndicatorFillRange, start + from, to - from);
+			}
+		}
+	}
+
+	static void clearAll (ScintillaEditorView& view)
+	{
+		auto length = view.sendMessage (Message::GetTextLength);
+		for (uint32_t severity = 0; severity < NumSeverities; ++severity)
+		{
+			view.sendMessage (Message::MarkerDeleteAll, FirstDiagnosticMarker + severity);
+			view.sendMessage (Message::SetIndicatorCurrent, FirstDiagnosticIndicator + severity);
+			view.sendMessage (Message::IndicatorClearRange, 0, length);
+		}
+		view.sendMessage (Message::AnnotationClearAll);
+	}
+};
 
 //------------------------------------------------------------------------
-bool ScintillaEditorView::getFoldingVisible () const
+void ScintillaEditorView::DiagnosticsDeleter::operator() (Diagnostics* d) const noexcept
 {
-	return (marginsCol & (1 << MarginsCol::Folding));
+	delete d;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setDefaultFoldDisplayText (UTF8StringPtr text)
+void ScintillaEditorView::setupDiagnostics ()
 {
-	sendMessage (Message::SetDefaultFoldDisplayText, 0, text);
+	diagnostics = std::unique_ptr<Diagnostics, DiagnosticsDeleter> (new Diagnostics);
+	for (uint32_t severity = 0; severity < NumSeverities; ++severity)
+	{
+		auto marker = FirstDiagnosticMarker + severity;
+		auto color = diagnosticColor (severity);
+		color.alpha = 40;
+		sendMessage (Message::MarkerDefine, marker, MarkerSymbol::Background);
+		sendMessage (Message::MarkerSetBackTranslucent, marker, toScintillaColor (color));
+		sendMessage (Message::MarkerSetLayer, marker, Scintilla::Layer::OverText);
+
+		auto indicator = FirstDiagnosticIndicator + severity;
+		sendMessage (Message::IndicSetStyle, indicator, Scintilla::IndicatorStyle::Squiggle);
+		sendMessage (Message::IndicSetFore, indicator, toScintillaColor (diagnosticColor (severity)));
+	}
+	diagnostics->styleOffset = sendMessage (Message::AllocateExtendedStyles, NumSeverities);
+	sendMessage (Message::AnnotationSetStyleOffset, diagnostics->styleOffset);
+	sendMessage (Message::AnnotationSetVisible, Scintilla::AnnotationVisible::Boxed);
+	applyDiagnosticStyles ();
 }
 
 //------------------------------------------------------------------------
-UTF8String ScintillaEditorView::getDefaultFoldDisplayText () const
+void ScintillaEditorView::applyDiagnosticStyles ()
 {
-	std::string str;
-	auto length = sendMessage (Message::GetDefaultFoldDisplayText);
-	if (length > 0)
+	auto background = theme->getDefaultStyle ().background;
+	for (uint32_t severity = 0; severity < NumSeverities; ++severity)
 	{
-		str.resize (length);
-		sendMessage (Message::GetDefaultFoldDisplayText, length + 1, str.data ());
+		auto style = diagnostics->styleOffset + severity;
+		sendMessage (Message::StyleSetFore, style, toScintillaColor (diagnosticColor (severity)));
+		sendMessage (Message::StyleSetBack, style, toScintillaColor (background));
 	}
-	return UTF8String (std::move (str));
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setFoldDisplayTextStyle (Scintilla::FoldDisplayTextStyle style)
+void ScintillaEditorView::setDiagnostics (const std::vector<ScintillaDiagnostic>& newDiagnostics)
 {
-	sendMessage (Scintilla::Message::FoldDisplayTextSetStyle, style);
+	if (!diagnostics)
+	{
+		if (newDiagnostics.empty ())
+			return;
+		setupDiagnostics ();
+	}
+	auto next = Diagnostics::build (newDiagnostics);
+	auto& previous = diagnostics->lines;
+	if (diagnostics->reapplyAll)
+	{
+		Diagnostics::clearAll (*this);
+		for (const auto& line : next)
+			Diagnostics::apply (*this, line);
+	}
+	else
+	{
+		auto& dirty = diagnostics->dirtyLines;
+		std::sort (dirty.begin (), dirty.end ());
+		dirty.erase (std::unique (dirty.begin (), dirty.end ()), dirty.end ());
+		for (auto line : dirty)
+			Diagnostics::clearLine (*this, line);
+		auto isDirty = [&] (int64_t line) {
+			return !dirty.empty () && std::binary_search (dirty.begin (), dirty.end (), line);
+		};
+		// both lists are sorted by line, only lines which differ are touched
+		auto oldIt = previous.begin ();
+		auto newIt = next.begin ();
+		while (oldIt != previous.end () || newIt != next.end ())
+		{
+			if (newIt == next.end () || (oldIt != previous.end () && oldIt->line < newIt->line))
+			{
+				if (!isDirty (oldIt->line))
+					Diagnostics::clear (*this, *oldIt);
+				++oldIt;
+			}
+			else if (oldIt == previous.end () || newIt->line < oldIt->line)
+			{
+				Diagnostics::apply (*this, *newIt++);
+			}
+			else
+			{
+				if (isDirty (oldIt->line))
+				{
+					Diagnostics::apply (*this, *newIt);
+				}
+				else if (*oldIt != *newIt)
+				{
+					Diagnostics::clear (*this, *oldIt);
+					Diagnostics::apply (*this, *newIt);
+				}
+				++oldIt;
+				++newIt;
+			}
+		}
+	}
+	previous = std::move (next);
+	diagnostics->dirtyLines.clear ();
+	diagnostics->reapplyAll = false;
 }
 
 //------------------------------------------------------------------------
-Scintilla::FoldDisplayTextStyle ScintillaEditorView::getFoldDisplayTextStyle () const
+void ScintillaEditorView::clearDiagnostics ()
 {
-	return static_cast<Scintilla::FoldDisplayTextStyle> (
-	    sendMessage (Scintilla::Message::FoldDisplayTextGetStyle));
+	setDiagnostics ({});
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setFoldMarginColorHi (const CColor& color)
+struct ScintillaEditorView::UndoTracking
 {
-	foldMarginColorHi = color;
-	sendMessage (Message::SetFoldMarginHiColour, true, toScintillaColor (color));
+	/** the undo history is not trimmed again for every change above the limit */
+	static constexpr uint32_t TrimDelay = 250;
+
+	uint64_t limit {0};
+	/** the memory of the undo history of scintilla. The changes of the user add to it, it is
+	 *	measured again when the history is trimmed or the document changes.
+	 */
+	uint64_t usage {0};
+	SharedPointer<CVSTGUITimer> timer;
+
+	~UndoTracking () noexcept
+	{
+		if (timer)
+			timer->stop ();
+	}
+};
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::UndoTrackingDeleter::operator() (UndoTracking* tracking) const noexcept
+{
+	delete tracking;
 }
 
 //------------------------------------------------------------------------
-CColor ScintillaEditorView::getFoldMarginColorHi () const
+void ScintillaEditorView::setUndoMemoryLimit (uint64_t bytes)
 {
-	return foldMarginColorHi;
+	if (bytes == 0)
+	{
+		undoTracking = nullptr;
+		return;
+	}
+	if (!undoTracking)
+		undoTracking = std::unique_ptr<UndoTracking, UndoTrackingDeleter> (new UndoTracking);
+	undoTracking->limit = bytes;
+	trimUndoHistory ();
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setFoldMarginColor (const CColor& color)
+uint64_t ScintillaEditorView::getUndoMemoryLimit () const
 {
-	foldMarginColor = color;
-	sendMessage (Message::SetFoldMarginColour, true, toScintillaColor (color));
+	return undoTracking ? undoTracking->limit : 0;
 }
 
 //------------------------------------------------------------------------
-CColor ScintillaEditorView::getFoldMarginColor () const
+uint64_t ScintillaEditorView::getUndoMemoryUsage () const
 {
-	return foldMarginColor;
+	uint64_t usage = 0;
+	auto numActions = sendMessage (Message::GetUndoActions);
+	for (intptr_t action = 0; action < numActions; ++action)
+	{
+		usage += UndoHistory::ActionOverhead +
+		         static_cast<uint64_t> (sendMessage (Message::GetUndoActionText, action));
+	}
+	return usage;
 }
 
 //------------------------------------------------------------------------
-bool ScintillaEditorView::showLineNumberMargin () const
+void ScintillaEditorView::trimUndoHistory ()
 {
-	return (marginsCol & (1 << MarginsCol::LineNumber));
+	if (!undoTracking)
+		return;
+	if (undoTracking->timer)
+		undoTracking->timer->stop ();
+	if (isLoading ())
+		return;
+	auto limit = undoTracking->limit;
+	undoTracking->usage = getUndoMemoryUsage ();
+	if (undoTracking->usage <= limit)
+		return;
+	// only the undo history is exchanged, the text and its markers, indicators and folds are
+	// not touched. Trimming below the limit keeps it from being trimmed again for every change.
+	auto history = readUndoHistory ();
+	history.trim (limit / 4 * 3);
+	writeUndoHistory (history);
+	undoTracking->usage = history.getMemoryUsage ();
 }
 
 //------------------------------------------------------------------------
-bool ScintillaEditorView::showFoldMargin () const
+void ScintillaEditorView::startUndoTrimTimer ()
 {
-	return (marginsCol & (1 << MarginsCol::Folding));
+	if (!undoTracking->timer)
+		undoTracking->timer = makeOwned<CVSTGUITimer> (
+		    [this] (CVSTGUITimer*) { trimUndoHistory (); }, UndoTracking::TrimDelay, false);
+	// does nothing if the timer is already running
+	undoTracking->timer->start ();
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::setZoom (int32_t zoom)
+std::string ScintillaEditorView::saveUndoHistory () const
 {
-	sendMessage (Message::SetZoom, zoom);
+	return readUndoHistory ().serialize (getText ().getString ());
 }
 
 //------------------------------------------------------------------------
-int32_t ScintillaEditorView::getZoom () const
+bool ScintillaEditorView::restoreUndoHistory (std::string_view data)
 {
-	return static_cast<int32_t> (sendMessage (Message::GetZoom));
+	if (sharedDocument)
+		return false;
+	UndoHistory history;
+	std::string text;
+	if (!UndoHistory::deserialize (data, text, history))
+		return false;
+	cancelLoading ();
+	// the listeners only see the new text, the history is set silently
+	setText (std::string_view (text));
+	writeUndoHistory (history);
+	updateUndoMemoryUsage ();
+	updateLargeFileMode ();
+	return true;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::updateLineNumberMarginWidth ()
+UndoHistory ScintillaEditorView::readUndoHistory () const
 {
-	if (showLineNumberMargin ())
+	UndoHistory history;
+	auto numActions = sendMessage (Message::GetUndoActions);
+	history.actions.resize (static_cast<size_t> (numActions));
+	for (intptr_t index = 0; index < numActions; ++index)
 	{
-		auto lineCount = static_cast<uint32_t> (sendMessage (Message::GetLineCount));
-		std::string str = "_99";
-		while ((lineCount /= 10) >= 10)
-		{
-			str += "9";
-		}
-		auto width = sendMessage (Message::TextWidth, StylesCommon::LineNumber, str.data ());
-		sendMessage (Message::SetMarginWidthN, 0, width);
+		auto& action = history.actions[static_cast<size_t> (index)];
+		action.type = static_cast<int32_t> (sendMessage (Message::GetUndoActionType, index));
+		action.position = sendMessage (Message::GetUndoActionPosition, index);
+		action.text.resize (
+		    static_cast<size_t> (sendMessage (Message::GetUndoActionText, index)));
+		sendMessage (Message::GetUndoActionText, index, action.text.data ());
 	}
+	history.current = sendMessage (Message::GetUndoCurrent);
+	history.savePoint = sendMessage (Message::GetUndoSavePoint);
+	history.detach = sendMessage (Message::GetUndoDetach);
+	history.tentative = sendMessage (Message::GetUndoTentative);
+	return history;
 }
 
 //------------------------------------------------------------------------
-void ScintillaEditorView::updateMarginsColumns ()
+void ScintillaEditorView::writeUndoHistory (const UndoHistory& history)
 {
-	auto lineNumbers = showLineNumberMargin ();
-	auto folding = showFoldMargin ();
-
-	auto count = 0;
-	if (lineNumbers)
-		++count;
-	if (folding)
-		++count;
-
-	sendMessage (Message::SetMargins, count);
-	uint32_t column = 0;
-	if (lineNumbers)
+	// the actions are added without changing the text, which is the text after the current one
+	sendMessage (Message::EmptyUndoBuffer);
+	for (const auto& action : history.actions)
 	{
-		sendMessage (Message::SetMarginTypeN, column, Scintilla::MarginType::Number);
-		updateLineNumberMarginWidth ();
-		++column;
+		sendMessage (Message::PushUndoActionType, action.type, action.position);
+		sendMessage (Message::ChangeLastUndoActionText, action.text.size (), action.text.data ());
 	}
-	if (folding)
-	{
-		auto scaleFactor = 1.;
-		if (auto frame = getFrame ())
-			scaleFactor = frame->getZoom ();
-		auto width = static_cast<int32_t> (std::ceil (16. * scaleFactor));
-		sendMessage (Message::SetMarginTypeN, column, Scintilla::MarginType::Symbol);
-		sendMessage (Message::SetMarginMaskN, column, Scintilla::MaskFolders);
-		sendMessage (Message::SetMarginWidthN, column, width + getZoom ());
-		sendMessage (Message::SetMarginSensitiveN, column, 1);
+	sendMessage (Message::SetUndoSavePoint, history.savePoint);
+	sendMessage (Message::SetUndoDetach, history.detach);
+	sendMessage (Message::SetUndoTentative, history.tentative);
+	sendMessage (Message::SetUndoCurrent, history.current);
+}
 
-		sendMessage (Message::MarkerDefine, MarkerOutline::Folder, MarkerSymbol::Arrow);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderOpen, MarkerSymbol::ArrowDown);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderEnd, MarkerSymbol::Empty);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderMidTail, MarkerSymbol::Empty);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderOpenMid, MarkerSymbol::Empty);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderSub, MarkerSymbol::Empty);
-		sendMessage (Message::MarkerDefine, MarkerOutline::FolderTail, MarkerSymbol::Empty);
+//------------------------------------------------------------------------
+void ScintillaEditorView::recordUndoChange (SCNotification* notification)
+{
+	auto type = notification->modificationType;
+	if (!(type & SC_PERFORMED_USER) || !(type & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)))
+		return;
+	// an estimate, scintilla may merge the change into its last action
+	undoTracking->usage +=
+	    UndoHistory::ActionOverhead + static_cast<uint64_t> (notification->length);
+	// timers need a frame, the limit of a view which is not attached is applied once it is
+	// attached
+	if (undoTracking->usage > undoTracking->limit && isAttached ())
+		startUndoTrimTimer ();
+}
 
-		sendMessage (Message::SetAutomaticFold,
-		             AutomaticFold::Show | AutomaticFold::Change | AutomaticFold::Click);
-	}
-	if (count == 0)
-	{
-		sendMessage (Message::SetMarginWidthN, 0, 0);
-		// the following is a workaround so that the margins are removed immediately on macOS
-		auto size = getViewSize ();
-		size.right--;
-		setViewSize (size, false);
-		size.right++;
-		setViewSize (size, false);
-	}
+//------------------------------------------------------------------------
+void ScintillaEditorView::updateUndoMemoryUsage ()
+{
+	if (undoTracking)
+		undoTracking->usage = getUndoMemoryUsage ();
 }
 
 //------------------------------------------------------------------------
@@ -681,6 +2857,28 @@ void ScintillaEditorView::onScintillaNotification (SCNotification* notification)
 		{
 			if (notification->linesAdded != 0)
 				updateLineNumberMarginWidth ();
+			if (changeSets)
+				collectChange (notification);
+			// only the view profile changes, the document is not exchanged while it is modified
+			if (largeFileThreshold != 0 && !loadingText)
+				updateLargeFileMode ();
+			if (snapshots)
+				trackSnapshotChange (notification);
+			if (undoTracking)
+				recordUndoChange (notification);
+			// only text changes move the diagnostics, not the markers setDiagnostics changes
+			if (diagnostics && !diagnostics->lines.empty () && !diagnostics->reapplyAll &&
+			    (notification->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)))
+			{
+				auto line = sendMessage (Message::LineFromPosition, notification->position);
+				diagnostics->edited (line, notification->linesAdded);
+			}
+			break;
+		}
+		case Notification::StyleNeeded:
+		{
+			if (backgroundLexing)
+				requestLexing (notification->position);
 			break;
 		}
 		case Notification::Zoom:
@@ -741,6 +2939,7 @@ static const std::string kAttrFoldDisplayTextStyle = "fold-display-text-style";
 static const std::string kAttrDefaultFoldDisplayText = "default-fold-display-text";
 static const std::string kAttrUseTabs = "use-tabs";
 static const std::string kAttrTabWidth = "tab-width";
+static const std::string kAttrLargeFileThreshold = "large-file-threshold-mb";
 static const std::string kAttrLineWrapMode = "line-wrap-mode";
 static const std::string kAttrLineWrapIndentMode = "line-wrap-indent-mode";
 static const std::string kAttrLineWrapStartIndent = "line-wrap-start-indent";
@@ -794,6 +2993,8 @@ public:
 		// tabs
 		attributeNames.push_back (kAttrUseTabs);
 		attributeNames.push_back (kAttrTabWidth);
+		// large files
+		attributeNames.push_back (kAttrLargeFileThreshold);
 		return true;
 	}
 	AttrType getAttributeType (const std::string& attributeName) const override
@@ -846,6 +3047,8 @@ public:
 			return kBooleanType;
 		if (attributeName == kAttrTabWidth)
 			return kIntegerType;
+		if (attributeName == kAttrLargeFileThreshold)
+			return kIntegerType;
 		return kUnknownType;
 	}
 	bool apply (CView* view, const UIAttributes& attr, const IUIDescription* desc) const override
@@ -853,11 +3056,14 @@ public:
 		auto sev = dynamic_cast<ScintillaEditorView*> (view);
 		if (!sev)
 			return false;
+		// all style attributes are collected into one theme which is shared by all views with the
+		// same attributes
+		ScintillaTheme theme (*sev->getTheme ());
 		CColor color;
 		if (stringToColor (attr.getAttributeValue (UIViewCreator::kAttrBackgroundColor), color,
 		                   desc))
 		{
-			sev->setBackgroundColor (color);
+			theme.setBackground (color);
 		}
 		if (stringToColor (attr.getAttributeValue (kAttrSelectionBackgroundColor), color, desc))
 		{
@@ -879,24 +3085,26 @@ public:
 		}
 		if (stringToColor (attr.getAttributeValue (kAttrLineNumberFontColor), color, desc))
 		{
-			sev->setLineNumberForegroundColor (color);
+			theme.setStyleForeground (LineNumberStyle, color);
 		}
 		if (stringToColor (attr.getAttributeValue (kAttrLineNumberBackgroundColor), color, desc))
 		{
-			sev->setLineNumberBackgroundColor (color);
+			theme.setStyleBackground (LineNumberStyle, color);
 		}
 		if (auto fontName = attr.getAttributeValue (kAttrEditorFont))
 		{
 			if (auto font = desc->getFont (fontName->data ()))
 			{
-				sev->setFont (font);
+				theme.setFont (font);
 			}
 		}
 		if (stringToColor (attr.getAttributeValue (UIViewCreator::kAttrFontColor), color, desc))
 		{
-			sev->setStaticFontColor (color);
+			if (color != kTransparentCColor)
+				theme.setForeground (color);
 			sev->setCaretColor (color);
 		}
+		sev->setTheme (ScintillaTheme::intern (theme));
 		bool b;
 		if (attr.getBooleanAttribute (kAttrUseTabs, b))
 		{
@@ -939,6 +3147,10 @@ public:
 		{
 			sev->setTabWidth (static_cast<uint32_t> (i));
 		}
+		if (attr.getIntegerAttribute (kAttrLargeFileThreshold, i) && i >= 0)
+		{
+			sev->setLargeFileThreshold (static_cast<uint64_t> (i) * 1024 * 1024);
+		}
 		CPoint p;
 		if (attr.getPointAttribute (kAttrEditorMargin, p))
 		{
@@ -1100,6 +3312,12 @@ public:
 			stringValue = UIAttributes::integerToString (sev->getTabWidth ());
 			return true;
 		}
+		if (attName == kAttrLargeFileThreshold)
+		{
+			auto megabytes = sev->getLargeFileThreshold () / (1024 * 1024);
+			stringValue = UIAttributes::integerToString (static_cast<int32_t> (megabytes));
+			return true;
+		}
 		if (attName == kAttrLineWrapMode)
 		{
 			auto index = static_cast<size_t> (sev->getLineWrap ());
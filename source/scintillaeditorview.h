@@ -2,10 +2,21 @@
 // in the LICENSE file found in the top-level directory of this
 // distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
 
+#pragma once
+
+#include "documentsnapshot.h"
+#include "scintillachangeset.h"
+#include "scintillatheme.h"
 #include "vstgui/lib/ccolor.h"
 #include "vstgui/lib/cfont.h"
 #include "vstgui/lib/cview.h"
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 struct SCNotification; // forward
 
@@ -20,15 +31,91 @@ enum class FoldDisplayTextStyle;
 //------------------------------------------------------------------------
 namespace VSTGUI {
 
+class MappedFile;
+class UndoHistory;
+class ScintillaEditorView;
+
+//------------------------------------------------------------------------
+struct ScintillaLoadResult
+{
+	bool success {false};
+	uint64_t bytes {0};
+	double seconds {0.};
+
+	[[nodiscard]] double bytesPerSecond () const { return seconds > 0. ? bytes / seconds : 0.; }
+};
+
+//------------------------------------------------------------------------
+/** a message of a compiler or checker for one line */
+struct ScintillaDiagnostic
+{
+	enum class Severity : uint32_t
+	{
+		Info,
+		Warning,
+		Error
+	};
+
+	/** zero based line */
+	int64_t line {0};
+	/** zero based byte columns of the range to underline, nothing is underlined if empty */
+	int64_t startColumn {0};
+	int64_t endColumn {0};
+	Severity severity {Severity::Error};
+	/** shown as annotation below the line, no annotation if empty */
+	std::string message;
+};
+
+//------------------------------------------------------------------------
+/** the notifications a listener subscribes to */
+struct ScintillaNotificationFilter
+{
+	/** notification codes (Scintilla::Notification), empty for all notifications */
+	std::vector<uint32_t> codes;
+	/** the modification types (Scintilla::ModificationFlags) of the Modified notifications */
+	uint32_t modificationFlags {0x7FFFFF};
+
+	[[nodiscard]] bool wantsCode (uint32_t code) const
+	{
+		return codes.empty () || std::find (codes.begin (), codes.end (), code) != codes.end ();
+	}
+};
+
 //------------------------------------------------------------------------
 class IScintillaListener
 {
 public:
 	virtual void onScintillaNotification (SCNotification* notification) = 0;
 
+	/** progress of an asynchronous load, called on the UI thread */
+	virtual void onScintillaLoadProgress (ScintillaEditorView* view, uint64_t bytesLoaded,
+	                                      uint64_t bytesTotal)
+	{
+	}
+	/** an asynchronous load has ended, result.success is false if it failed or was cancelled */
+	virtual void onScintillaLoadFinished (ScintillaEditorView* view,
+	                                      const ScintillaLoadResult& result)
+	{
+	}
+	/** the view switched into or out of the large file mode */
+	virtual void onScintillaLargeFileMode (ScintillaEditorView* view, bool state) {}
+	/** the view shows another document after setDocument, attachDocument or detachDocument */
+	virtual void onScintillaDocumentChanged (ScintillaEditorView* view) {}
+
 	virtual ~IScintillaListener () noexcept = default;
 };
 
+//------------------------------------------------------------------------
+class IScintillaChangeSetListener
+{
+public:
+	/** the text changes since the last call, called at most once per frame on the UI thread */
+	virtual void onScintillaChangeSet (ScintillaEditorView* view,
+	                                   const ScintillaChangeSet& changeSet) = 0;
+
+	virtual ~IScintillaChangeSetListener () noexcept = default;
+};
+
 //------------------------------------------------------------------------
 class ScintillaEditorView : public CView, public IScintillaListener
 {
@@ -39,15 +126,133 @@ public:
 		int64_t end;
 	};
 
+	/** non-owning view of the document text. The gap buffer of the document is exposed as at most
+	 *	two contiguous parts. It is only valid until the next modification of the document.
+	 */
+	struct TextView
+	{
+		std::string_view first;
+		std::string_view second;
+
+		[[nodiscard]] size_t size () const { return first.size () + second.size (); }
+		[[nodiscard]] bool empty () const { return first.empty () && second.empty (); }
+		[[nodiscard]] bool equals (std::string_view text) const
+		{
+			return size () == text.size () && text.substr (0, first.size ()) == first &&
+			       text.substr (first.size ()) == second;
+		}
+
+		/** call proc with every non empty part */
+		template <typename Proc>
+		void forEach (Proc proc) const
+		{
+			if (!first.empty ())
+				proc (first);
+			if (!second.empty ())
+				proc (second);
+		}
+	};
+
+	/** a position given as line and column, as language servers and compilers report them */
+	struct LinePosition
+	{
+		/** zero based */
+		int64_t line;
+		/** zero based, counted in the unit of the conversion */
+		int64_t column;
+	};
+
+	/** the unit in which columns and index positions are counted */
+	enum class PositionUnit
+	{
+		Bytes,
+		UTF16,
+		UTF32
+	};
+
 	ScintillaEditorView ();
 	~ScintillaEditorView () noexcept override;
 
 	/** set current text */
 	void setText (UTF8StringPtr text);
+	/** set current text of the given length, it may contain NUL bytes */
+	void setText (std::string_view text);
 	/** get current text */
 	[[nodiscard]] UTF8String getText () const;
 	/** get part of the text  */
-	[[nodiscard]] UTF8String getText (const Range& range);
+	[[nodiscard]] UTF8String getText (const Range& range) const;
+	/** get the current text without copying it (the gap of the buffer is not moved) */
+	[[nodiscard]] TextView getTextView () const;
+	/** get part of the text without copying it (the gap of the buffer is not moved) */
+	[[nodiscard]] TextView getTextView (const Range& range) const;
+	/** get an immutable copy of the current text which can be read from any thread. The first
+	 *	call copies the text, afterwards the copy is kept in sync with the document and a snapshot
+	 *	only copies the modified parts of it.
+	 */
+	std::shared_ptr<const DocumentSnapshot> createSnapshot ();
+
+	// ------------------------------------
+	// File loading
+	using LoadResult = ScintillaLoadResult;
+	/** replace the text with the content of a file. The file is memory mapped and streamed into
+	 *	the document, the undo history is cleared and the document is marked as saved. A read-only
+	 *	document is loaded as well and stays read-only.
+	 *	@param path UTF-8 path of the file
+	 */
+	LoadResult openFile (UTF8StringPtr path);
+	/** replace the text with the content of a mapped file, see openFile */
+	LoadResult loadFromMapping (const MappedFile& file);
+	/** load a file on a worker thread. While loading an empty read-only placeholder document is
+	 *	shown, progress and the result are reported to the listeners.
+	 *	@param path UTF-8 path of the file
+	 *	@return false if the file could not be opened
+	 */
+	bool openFileAsync (UTF8StringPtr path);
+	/** cancel an asynchronous load, the previous document is shown again with its undo history */
+	void cancelLoading ();
+	/** wait for the worker of an asynchronous load and show the loaded document now. A load is
+	 *	only polled while the view is attached, this finishes it for a view without a frame.
+	 */
+	void flushLoading ();
+	[[nodiscard]] bool isLoading () const;
+
+	// ------------------------------------
+	// Documents
+	/** the scintilla document which is shown */
+	[[nodiscard]] void* getDocument () const;
+	/** show a scintilla document, the view adds a reference to it. A shared document is left.
+	 *	@param inheritSettings the document gets the code page, end of line mode and
+	 *	indentation of the current document
+	 */
+	void setDocument (void* document, bool inheritSettings);
+	/** call proc with the text of a document which is not shown, without notifying anyone. The
+	 *	selection and the scroll position are kept.
+	 */
+	void readDocument (void* document, const std::function<void (const TextView&)>& proc);
+
+	/** show the document of another view, for example in a second pane. The views edit one text
+	 *	with one undo history and share the lexer of the other view, which lexes on the UI thread
+	 *	while more than one view shows the document. The document lives as long as one of the
+	 *	views shows it. A view which leaves the document with detachDocument or a successful
+	 *	openFileAsync has no lexer afterwards, the lexer stays with the document.
+	 *	@return false if the other view is loading a file
+	 */
+	bool attachDocument (ScintillaEditorView& other);
+	/** show a new empty document if the document is shared with other views */
+	void detachDocument ();
+	/** the number of views which show the document of this view */
+	[[nodiscard]] size_t getNumDocumentViews () const;
+
+	/** documents larger than the threshold are shown with a fast profile. Loaded files get a
+	 *	document without styles, the lexer is detached, the fold margin and line wrap are turned
+	 *	off and only the lines of the visible page are kept in the layout cache. The view switches
+	 *	back when the document shrinks below three quarters of the threshold, a document without
+	 *	styles is only exchanged if this does not lose undo history. Zero turns the mode off, the
+	 *	default is 64 MB.
+	 */
+	void setLargeFileThreshold (uint64_t bytes);
+	[[nodiscard]] uint64_t getLargeFileThreshold () const { return largeFileThreshold; }
+	[[nodiscard]] bool isLargeFileMode () const { return largeFile.has_value (); }
 
 	/** set font for all styles.
 	 *	@param font font
@@ -85,6 +290,32 @@ public:
 	void setInactiveSelectionForegroundColor (const CColor& color);
 	[[nodiscard]] CColor getInactiveSelectionForegroundColor () const;
 
+	// ------------------------------------
+	// Position Conversion
+	/** convert many line positions into byte positions in one call. The result has the order of
+	 *	the input, which is walked sorted by line and column, so every line is visited once. A
+	 *	line past the end maps to the end of the text, a column past the end of its line to the
+	 *	end of the line and a column inside of a character to the start of the character. In
+	 *	documents which are not UTF-8 every unit is a byte.
+	 */
+	[[nodiscard]] std::vector<int64_t> toBytePositions (const std::vector<LinePosition>& positions,
+	                                                    PositionUnit unit) const;
+	/** convert many byte positions into line positions, see toBytePositions */
+	[[nodiscard]] std::vector<LinePosition> toLinePositions (const std::vector<int64_t>& positions,
+	                                                         PositionUnit unit) const;
+	/** convert many positions counted in code units from the start of the text into byte
+	 *	positions. For UTF-16 and UTF-32 the document keeps an index of the line starts in this
+	 *	unit after the first call (AllocateLineCharacterIndex), which scintilla updates with every
+	 *	change.
+	 */
+	[[nodiscard]] std::vector<int64_t> indexToBytePositions (const std::vector<int64_t>& positions,
+	                                                         PositionUnit unit) const;
+	/** convert many byte positions into positions counted in code units from the start of the
+	 *	text, see indexToBytePositions
+	 */
+	[[nodiscard]] std::vector<int64_t> byteToIndexPositions (const std::vector<int64_t>& positions,
+	                                                         PositionUnit unit) const;
+
 	// ------------------------------------
 	// Search
 	enum SearchFlags
@@ -94,7 +325,9 @@ public:
 		WordStart = 1 << 2,
 		ScrollTo = 1 << 3,
 		Wrap = 1 << 4,
-		Backwards = 1 << 5
+		Backwards = 1 << 5,
+		/** the search string is an ECMAScript regular expression */
+		RegularExpression = 1 << 6
 	};
 	/** find a string and select it.
 	 *	@param searchString string to find
@@ -102,6 +335,36 @@ public:
 	 *	@return -1 if not found otherwise index of searchString
 	 */
 	int64_t findAndSelect (UTF8StringPtr searchString, uint32_t searchFlags);
+	/** find all matches of a string without changing the selection.
+	 *	@param searchString string to find
+	 *	@param searchFlags MatchCase, WholeWord, WordStart and RegularExpression of SearchFlags. A
+	 *	regular expression is compiled once, cached and large documents are searched on multiple
+	 *	threads.
+	 *	@return the non overlapping matches in document order
+	 */
+	[[nodiscard]] std::vector<Range> findAll (UTF8StringPtr searchString,
+	                                          uint32_t searchFlags) const;
+	/** replace all matches of a string as one undo action. The new text is built in one pass and
+	 *	replaces the range from the first to the last changed byte in one edit. The text outside
+	 *	of this range is not touched, but markers of the lines inside of it move to its first line
+	 *	and indicators and folds inside of it are lost, which is the price of a single edit.
+	 *	@param searchString string to find, see findAll
+	 *	@param replacement the literal replacement text
+	 *	@param searchFlags flags see findAll
+	 *	@return the number of replacements, 0 if the document is read-only
+	 */
+	size_t replaceAll (UTF8StringPtr searchString, UTF8StringPtr replacement,
+	                   uint32_t searchFlags);
+	/** count the matches of a string, see findAll */
+	[[nodiscard]] size_t countMatches (UTF8StringPtr searchString, uint32_t searchFlags) const;
+	/** the characters which are part of words for WholeWord and WordStart */
+	[[nodiscard]] std::string getWordChars () const;
+	/** the characters which scintilla treats as whitespace and as punctuation at word bounds */
+	[[nodiscard]] std::string getWhitespaceChars () const;
+	[[nodiscard]] std::string getPunctuationChars () const;
+	/** highlight the ranges with the find indicator, previous highlights are removed */
+	void setFindHighlights (const std::vector<Range>& ranges);
+	void clearFindHighlights ();
 
 	// ------------------------------------
 	// Undo/Redo
@@ -109,6 +372,22 @@ public:
 	[[nodiscard]] bool canRedo () const;
 	void undo ();
 	void redo ();
+	/** the maximum memory of the undo history, zero for no limit. When it is exceeded the oldest
+	 *	steps of the undo history of scintilla are dropped, the text is not touched. The limit is
+	 *	applied by a timer while the view is attached, otherwise by trimUndoHistory.
+	 */
+	void setUndoMemoryLimit (uint64_t bytes);
+	[[nodiscard]] uint64_t getUndoMemoryLimit () const;
+	/** the memory of the undo history of scintilla, measured on every call */
+	[[nodiscard]] uint64_t getUndoMemoryUsage () const;
+	/** apply the memory limit now instead of on the next timer tick */
+	void trimUndoHistory ();
+	/** the text together with the undo history, see restoreUndoHistory */
+	[[nodiscard]] std::string saveUndoHistory () const;
+	/** replace the text and the undo history with what saveUndoHistory returned. Fails for a
+	 *	document which is shared with other views.
+	 */
+	bool restoreUndoHistory (std::string_view data);
 
 	// ------------------------------------
 	// Tabs/Indentation
@@ -158,11 +437,44 @@ public:
 
 	// ------------------------------------
 	// Lexer
+	/** set the lexer. The view takes ownership of the lexer and keeps it when the document is
+	 *	exchanged (for example after openFileAsync)
+	 */
 	void setLexer (Scintilla::ILexer5* lexer);
+	/** set a lexer which is shared with its creator, for example a lexer of the LexerRegistry */
+	void setLexer (const std::shared_ptr<Scintilla::ILexer5>& lexer);
 	[[nodiscard]] Scintilla::ILexer5* getLexer () const;
+	/** run the lexer on a worker thread against a snapshot of the document instead of on the UI
+	 *	thread. Its styles and fold levels are applied in batches when they are ready, results for
+	 *	an older version of the document are discarded. The properties and keywords of the lexer
+	 *	must be set on the lexer itself, the lexer messages of scintilla do not reach it.
+	 */
+	void setBackgroundLexing (bool state);
+	[[nodiscard]] bool isBackgroundLexing () const { return lexInBackground; }
+	/** wait for the background lexer and apply all of its results now */
+	void flushBackgroundLexing ();
 
 	static Scintilla::ILexer5* createLexer (const char* name);
 
+	// ------------------------------------
+	// Diagnostics
+	/** mark the lines of the diagnostics with a background color, underline their ranges and
+	 *	show their messages as annotations. Only the lines whose diagnostics differ from the
+	 *	previous call and the lines which were edited since are changed, the lines of the
+	 *	previous call follow added and removed lines.
+	 */
+	void setDiagnostics (const std::vector<ScintillaDiagnostic>& diagnostics);
+	void clearDiagnostics ();
+
+	// ------------------------------------
+	// Theme
+	/** set font and colors of all styles. Only the styles which differ from the current theme are
+	 *	sent to scintilla, and if the default style changes all styles are reset via StyleClearAll.
+	 */
+	void setTheme (const std::shared_ptr<const ScintillaTheme>& theme);
+	/** get the current theme, it includes changes made via setFont, setStyleColor, ... */
+	[[nodiscard]] const std::shared_ptr<const ScintillaTheme>& getTheme () const;
+
 	/** set style color */
 	void setStyleColor (uint32_t index, const CColor& textColor,
 	                    const CColor& backColor = kTransparentCColor);
@@ -189,9 +501,25 @@ public:
 			                    reinterpret_cast<intptr_t> (lParam));
 	}
 
+	/** register a listener for all notifications */
 	void registerListener (IScintillaListener* listener);
+	/** register a listener only for the notifications matching the filter. The modification
+	 *	event mask of scintilla is the union of the modification flags of all listeners.
+	 */
+	void registerListener (IScintillaListener* listener, const ScintillaNotificationFilter& filter);
 	void unregisterListener (IScintillaListener* listener);
 
+	/** register a listener for the coalesced changes of the document. Changes are only collected
+	 *	while at least one change set listener is registered.
+	 */
+	void registerChangeSetListener (IScintillaChangeSetListener* listener);
+	void unregisterChangeSetListener (IScintillaChangeSetListener* listener);
+	/** deliver the collected changes now instead of on the next timer tick. Changes are only
+	 *	delivered by a timer while the view is attached, this delivers them for a view without a
+	 *	frame.
+	 */
+	void flushChangeSet ();
+
 	// ------------------------------------
 	bool attached (CView* parent) override;
 	bool removed (CView* parent) override;
@@ -199,11 +527,91 @@ public:
 	void setMouseEnabled (bool bEnable) override;
 	void looseFocus () override;
 	void takeFocus () override;
+#if !defined(_WIN32) && !defined(__APPLE__)
+	// the native views of the other platforms handle the input themselves
+	CMouseEventResult onMouseDown (CPoint& where, const CButtonState& buttons) override;
+	CMouseEventResult onMouseUp (CPoint& where, const CButtonState& buttons) override;
+	CMouseEventResult onMouseMoved (CPoint& where, const CButtonState& buttons) override;
+	bool onWheel (const CPoint& where, const CMouseWheelAxis& axis, const float& distance,
+	              const CButtonState& buttons) override;
+	int32_t onKeyDown (VstKeyCode& keyCode) override;
+#endif
+	void beforeDelete () override;
 
 	struct Impl;
 
 private:
+	struct AsyncLoad;
+	struct AsyncLoadDeleter
+	{
+		void operator() (AsyncLoad* load) const noexcept;
+	};
+	struct BackgroundLexing;
+	struct BackgroundLexingDeleter
+	{
+		void operator() (BackgroundLexing* lexing) const noexcept;
+	};
+	struct ChangeSetChannel;
+	struct ChangeSetChannelDeleter
+	{
+		void operator() (ChangeSetChannel* channel) const noexcept;
+	};
+	struct Diagnostics;
+	struct DiagnosticsDeleter
+	{
+		void operator() (Diagnostics* diagnostics) const noexcept;
+	};
+	struct Listeners;
+	struct ListenersDeleter
+	{
+		void operator() (Listeners* listeners) const noexcept;
+	};
+	struct SharedDocument;
+	struct UndoTracking;
+	struct UndoTrackingDeleter
+	{
+		void operator() (UndoTracking* tracking) const noexcept;
+	};
+
 	void init ();
+	void modifyTheme (const std::function<void (ScintillaTheme&)>& proc);
+	void applyStyle (uint32_t index, const ScintillaTheme::ResolvedStyle& style,
+	                 const ScintillaTheme::ResolvedStyle& current);
+	void forEachListener (const std::function<void (IScintillaListener*)>& proc);
+	void notifyDocumentChanged ();
+	void dispatchNotification (SCNotification* notification);
+	void updateModEventMask ();
+	void collectChange (SCNotification* notification);
+	void startChangeSetTimer ();
+	void trackSnapshotChange (SCNotification* notification);
+	void setupDiagnostics ();
+	void applyDiagnosticStyles ();
+	void switchDocument (void* document, bool inheritSettings);
+	void attachLexer ();
+	void leaveSharedDocument ();
+	[[nodiscard]] bool isLargeFile (uint64_t size) const;
+	void prepareDocument (uint64_t size);
+	void exchangeDocument (intptr_t documentOptions);
+	void updateLargeFileMode ();
+	void setLargeFileMode (bool state);
+	void requestLexing (int64_t position);
+	void startLexJob ();
+	void startLexingTimer ();
+	bool applyLexResult ();
+	void startAsyncLoadTimer ();
+	void onAsyncLoadTimer ();
+	void finishAsyncLoad (bool cancelled);
+	/** timers need a frame, the backends call this when the view was attached to start the
+	 *	timers of the work which is still pending
+	 */
+	void startPendingTimers ();
+	[[nodiscard]] PositionUnit columnUnit (PositionUnit unit) const;
+	intptr_t allocateLineCharacterIndex (PositionUnit unit) const;
+	void recordUndoChange (SCNotification* notification);
+	void updateUndoMemoryUsage ();
+	void startUndoTrimTimer ();
+	[[nodiscard]] UndoHistory readUndoHistory () const;
+	void writeUndoHistory (const UndoHistory& history);
 
 	void onScintillaNotification (SCNotification* notification) override;
 	void draw (CDrawContext* pContext) override;
@@ -220,12 +628,32 @@ private:
 		Folding
 	};
 
-	SharedPointer<CFontDesc> font;
-	Scintilla::ILexer5* lexer {nullptr};
+	std::shared_ptr<const ScintillaTheme> theme;
+	std::shared_ptr<Scintilla::ILexer5> lexer;
 	uint32_t marginsCol {0};
 	CColor foldMarginColorHi {kBlackCColor};
 	CColor foldMarginColor {kWhiteCColor};
 
+	std::unique_ptr<Listeners, ListenersDeleter> listeners;
+	std::unique_ptr<ChangeSetChannel, ChangeSetChannelDeleter> changeSets;
+	std::unique_ptr<Diagnostics, DiagnosticsDeleter> diagnostics;
+	std::unique_ptr<AsyncLoad, AsyncLoadDeleter> asyncLoad;
+	std::unique_ptr<DocumentSnapshotTracker> snapshots;
+	std::unique_ptr<BackgroundLexing, BackgroundLexingDeleter> backgroundLexing;
+	bool lexInBackground {false};
+	std::shared_ptr<SharedDocument> sharedDocument;
+	std::unique_ptr<UndoTracking, UndoTrackingDeleter> undoTracking;
+
+	/** the settings which the large file mode changed */
+	struct LargeFileProfile
+	{
+		bool foldingVisible;
+		Scintilla::Wrap wrap;
+		intptr_t layoutCache;
+	};
+	std::optional<LargeFileProfile> largeFile;
+	uint64_t largeFileThreshold {64 * 1024 * 1024};
+	bool loadingText {false};
 	std::unique_ptr<Impl> impl;
 };
 
@@ -0,0 +1,342 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillaeditorview.h"
+#include "scintillamessagestats.h"
+#include "scintillaplatform.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Lexilla.h"
+
+//------------------------------------------------------------------------
+namespace Scintilla::Internal {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** font metrics derived from the font size, every character has the same advance */
+class FontHeadless final : public Font
+{
+public:
+	explicit FontHeadless (const FontParameters& fp) : size (fp.size > 0. ? fp.size : 10.) {}
+
+	XYPOSITION ascent () const { return std::ceil (size * 0.8); }
+	XYPOSITION descent () const { return std::ceil (size * 0.2); }
+	XYPOSITION advance () const { return std::round (size * 0.6); }
+
+private:
+	XYPOSITION size;
+};
+
+//------------------------------------------------------------------------
+inline const FontHeadless* toFont (const Font* font)
+{
+	return static_cast<const FontHeadless*> (font);
+}
+
+//------------------------------------------------------------------------
+/** a surface which can only measure, all drawing is ignored */
+class SurfaceHeadless final : public Surface
+{
+public:
+	void Init (WindowID wid) override {}
+	void Init (SurfaceID sid, WindowID wid) override {}
+	std::unique_ptr<Surface> AllocatePixMap (int width, int height) override
+	{
+		return std::make_unique<SurfaceHeadless> ();
+	}
+	void SetMode (SurfaceMode mode) override {}
+	void Release () noexcept override {}
+	int SupportsFeature (Supports feature) noexcept override { return 0; }
+	bool Initialised () override { return true; }
+	int LogPixelsY () override { return 72; }
+	int PixelDivisions () override { return 1; }
+	int DeviceHeightFont (int points) override { return points; }
+	void LineDraw (Point start, Point end, Stroke stroke) override {}
+	void PolyLine (const Point* pts, size_t npts, Stroke stroke) override {}
+	void Polygon (const Point* pts, size_t npts, FillStroke fillStroke) override {}
+	void RectangleDraw (PRectangle rc, FillStroke fillStroke) override {}
+	void RectangleFrame (PRectangle rc, Stroke stroke) override {}
+	void FillRectangle (PRectangle rc, Fill fill) override {}
+	void FillRectangleAligned (PRectangle rc, Fill fill) override {}
+	void FillRectangle (PRectangle rc, Surface& surfacePattern) override {}
+	void RoundedRectangle (PRectangle rc, FillStroke fillStroke) override {}
+	void AlphaRectangle (PRectangle rc, XYPOSITION cornerSize, FillStroke fillStroke) override {}
+	void GradientRectangle (PRectangle rc, const std::vector<ColourStop>& stops,
+	                        GradientOptions options) override
+	{
+	}
+	void DrawRGBAImage (PRectangle rc, int width, int height,
+	                    const unsigned char* pixelsImage) override
+	{
+	}
+	void Ellipse (PRectangle rc, FillStroke fillStroke) override {}
+	void Stadium (PRectangle rc, FillStroke fillStroke, Ends ends) override {}
+	void Copy (PRectangle rc, Point from, Surface& surfaceSource) override {}
+	std::unique_ptr<IScreenLineLayout> Layout (const IScreenLine* screenLine) override
+	{
+		return nullptr;
+	}
+	void DrawTextNoClip (PRectangle rc, const Font* font_, XYPOSITION ybase, std::string_view text,
+	                     ColourRGBA fore, ColourRGBA back) override
+	{
+	}
+	void DrawTextClipped (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                      std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+	}
+	void DrawTextTransparent (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                          std::string_view text, ColourRGBA fore) override
+	{
+	}
+	void MeasureWidths (const Font* font_, std::string_view text, XYPOSITION* positions) override
+	{
+		auto advance = toFont (font_)->advance ();
+		XYPOSITION x = 0.;
+		for (size_t pos = 0; pos < text.size (); ++pos)
+		{
+			// continuation bytes of an UTF-8 sequence share the position of the lead byte
+			if ((static_cast<uint8_t> (text[pos]) & 0xC0) != 0x80)
+				x += advance;
+			positions[pos] = x;
+		}
+	}
+	XYPOSITION WidthText (const Font* font_, std::string_view text) override
+	{
+		XYPOSITION characters = 0.;
+		for (auto c : text)
+		{
+			if ((static_cast<uint8_t> (c) & 0xC0) != 0x80)
+				characters += 1.;
+		}
+		return characters * toFont (font_)->advance ();
+	}
+	void DrawTextNoClipUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                         std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+	}
+	void DrawTextClippedUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                          std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+	}
+	void DrawTextTransparentUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                              std::string_view text, ColourRGBA fore) override
+	{
+	}
+	void MeasureWidthsUTF8 (const Font* font_, std::string_view text,
+	                        XYPOSITION* positions) override
+	{
+		MeasureWidths (font_, text, positions);
+	}
+	XYPOSITION WidthTextUTF8 (const Font* font_, std::string_view text) override
+	{
+		return WidthText (font_, text);
+	}
+	XYPOSITION Ascent (const Font* font_) override { return toFont (font_)->ascent (); }
+	XYPOSITION Descent (const Font* font_) override { return toFont (font_)->descent (); }
+	XYPOSITION InternalLeading (const Font* font_) override { return 0.; }
+	XYPOSITION Height (const Font* font_) override
+	{
+		return toFont (font_)->ascent () + toFont (font_)->descent ();
+	}
+	XYPOSITION AverageCharWidth (const Font* font_) override { return toFont (font_)->advance (); }
+	void SetClip (PRectangle rc) override {}
+	void PopClip () override {}
+	void FlushCachedState () override {}
+	void FlushDrawing () override {}
+};
+
+//------------------------------------------------------------------------
+/** scintilla editor without any window, timers are not available so the caret does not blink and
+ *	idle work is done synchronously */
+class ScintillaHeadless final : public ScintillaEditorBase
+{
+public:
+	explicit ScintillaHeadless (NotifyFunc&& notify) : ScintillaEditorBase (std::move (notify)) {}
+
+	~ScintillaHeadless () noexcept override { Finalise (); }
+
+	void setClientSize (XYPOSITION width, XYPOSITION height)
+	{
+		clientSize = PRectangle (0., 0., width, height);
+		resized ();
+	}
+
+	// IWindowHost
+	PRectangle getPosition () const override { return clientSize; }
+	void invalidate (PRectangle rc) override {}
+	void invalidateAll () override {}
+	void setCursor (Window::Cursor cursor) override {}
+
+private:
+	void Copy () override
+	{
+		if (sel.Empty ())
+			return;
+		SelectionText selectedText;
+		CopySelectionRange (&selectedText);
+		CopyToClipboard (selectedText);
+	}
+
+	void CopyToClipboard (const SelectionText& selectedText) override
+	{
+		clipboard.assign (selectedText.Data (), selectedText.Length ());
+	}
+
+	void Paste () override
+	{
+		if (clipboard.empty ())
+			return;
+		UndoGroup undoGroup (pdoc);
+		ClearSelection (multiPasteMode == MultiPaste::Each);
+		InsertPasteShape (clipboard.data (), static_cast<Sci::Position> (clipboard.size ()),
+		                  PasteShape::stream);
+		EnsureCaretVisible ();
+	}
+
+	bool FineTickerRunning (TickReason reason) override { return false; }
+	void FineTickerStart (TickReason reason, int millis, int tolerance) override {}
+	void FineTickerCancel (TickReason reason) override {}
+
+	PRectangle clientSize {0., 0., 800., 600.};
+	std::string clipboard;
+};
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+std::shared_ptr<Font> Font::Allocate (const FontParameters& fp)
+{
+	return std::make_shared<FontHeadless> (fp);
+}
+
+//------------------------------------------------------------------------
+std::unique_ptr<Surface> Surface::Allocate (Technology)
+{
+	return std::make_unique<SurfaceHeadless> ();
+}
+
+//------------------------------------------------------------------------
+} // Scintilla::Internal
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+using Scintilla::Internal::ScintillaHeadless;
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::Impl
+{
+	std::unique_ptr<ScintillaHeadless> editor;
+};
+
+//------------------------------------------------------------------------
+ScintillaEditorView::ScintillaEditorView () : CView (CRect (0, 0, 0, 0))
+{
+	impl = std::make_unique<Impl> ();
+	impl->editor = std::make_unique<ScintillaHeadless> (
+	    [this] (SCNotification* notification) { dispatchNotification (notification); });
+	init ();
+}
+
+//------------------------------------------------------------------------
+ScintillaEditorView::~ScintillaEditorView () noexcept
+{
+	if (impl)
+		impl->editor = nullptr;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::draw (CDrawContext* pContext)
+{
+	setDirty (false);
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::attached (CView* parent)
+{
+	// there are no timers, pending work is finished by the flush methods of the view
+	return CView::attached (parent);
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::removed (CView* parent)
+{
+	return CView::removed (parent);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setViewSize (const CRect& rect, bool invalid)
+{
+	CView::setViewSize (rect, invalid);
+	// an empty view still behaves like a visible editor of a reasonable size
+	if (impl && impl->editor && !rect.isEmpty ())
+		impl->editor->setClientSize (rect.getWidth (), rect.getHeight ());
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setMouseEnabled (bool enable)
+{
+	CView::setMouseEnabled (enable);
+	sendMessage (SCI_SETREADONLY, !enable);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::platformSetBackgroundColor (const CColor& color)
+{
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseDown (CPoint& where, const CButtonState& buttons)
+{
+	return CView::onMouseDown (where, buttons);
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseUp (CPoint& where, const CButtonState& buttons)
+{
+	return CView::onMouseUp (where, buttons);
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseMoved (CPoint& where, const CButtonState& buttons)
+{
+	return CView::onMouseMoved (where, buttons);
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::onWheel (const CPoint& where, const CMouseWheelAxis& axis,
+                                   const float& distance, const CButtonState& buttons)
+{
+	return CView::onWheel (where, axis, distance, buttons);
+}
+
+//------------------------------------------------------------------------
+int32_t ScintillaEditorView::onKeyDown (VstKeyCode& keyCode)
+{
+	return CView::onKeyDown (keyCode);
+}
+
+//------------------------------------------------------------------------
+intptr_t ScintillaEditorView::sendMessage (uint32_t message, uintptr_t wParam,
+                                           intptr_t lParam) const
+{
+	SCINTILLA_RECORD_MESSAGE (message);
+	return (impl && impl->editor) ? impl->editor->send (message, wParam, lParam) : 0;
+}
+
+//------------------------------------------------------------------------
+Scintilla::ILexer5* ScintillaEditorView::createLexer (const char* name)
+{
+	return CreateLexer (name);
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
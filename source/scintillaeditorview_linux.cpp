@@ -0,0 +1,1032 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillaeditorview.h"
+#include "scintillamessagestats.h"
+#include "scintillaplatform.h"
+#include "vstgui/lib/cbitmap.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/cdropsource.h"
+#include "vstgui/lib/cframe.h"
+#include "vstgui/lib/cgradient.h"
+#include "vstgui/lib/cgraphicspath.h"
+#include "vstgui/lib/cgraphicstransform.h"
+#include "vstgui/lib/coffscreencontext.h"
+#include "vstgui/lib/cvstguitimer.h"
+#include "vstgui/lib/platform/iplatformfactory.h"
+#include "vstgui/lib/platform/iplatformfont.h"
+#include "vstgui/lib/platform/iplatformstring.h"
+#include "vstgui/lib/platform/platformfactory.h"
+
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Lexilla.h"
+
+//------------------------------------------------------------------------
+namespace Scintilla::Internal {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+inline VSTGUI::CColor toCColor (ColourRGBA c)
+{
+	return {static_cast<uint8_t> (c.GetRed ()), static_cast<uint8_t> (c.GetGreen ()),
+	        static_cast<uint8_t> (c.GetBlue ()), static_cast<uint8_t> (c.GetAlpha ())};
+}
+
+//------------------------------------------------------------------------
+inline VSTGUI::CRect toCRect (PRectangle rc)
+{
+	return {rc.left, rc.top, rc.right, rc.bottom};
+}
+
+//------------------------------------------------------------------------
+inline VSTGUI::CPoint toCPoint (Point p)
+{
+	return {p.x, p.y};
+}
+
+//------------------------------------------------------------------------
+class FontVSTGUI final : public Font
+{
+public:
+	explicit FontVSTGUI (const FontParameters& fp)
+	{
+		int32_t style = 0;
+		if (static_cast<int> (fp.weight) >= static_cast<int> (FontWeight::SemiBold))
+			style |= VSTGUI::kBoldFace;
+		if (fp.italic)
+			style |= VSTGUI::kItalicFace;
+		desc = VSTGUI::makeOwned<VSTGUI::CFontDesc> (fp.faceName, fp.size, style);
+		if (auto platformFont = desc->getPlatformFont ())
+		{
+			ascent = platformFont->getAscent ();
+			descent = platformFont->getDescent ();
+			leading = platformFont->getLeading ();
+		}
+		asciiWidths.fill (-1.);
+		averageCharWidth = measure ("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ") / 52.;
+	}
+
+	/** measure the width of the UTF-8 character or string */
+	XYPOSITION measure (std::string_view text) const
+	{
+		auto platformFont = desc->getPlatformFont ();
+		if (!platformFont || !platformFont->getPainter ())
+			return static_cast<XYPOSITION> (text.size ()) * desc->getSize () * 0.6;
+		auto string = VSTGUI::getPlatformFactory ().createString (std::string (text).data ());
+		return platformFont->getPainter ()->getStringWidth (nullptr, string, true);
+	}
+
+	/** measure a single UTF-8 character, ASCII characters are cached */
+	XYPOSITION measureCharacter (std::string_view character) const
+	{
+		if (character.size () == 1 && static_cast<uint8_t> (character[0]) < asciiWidths.size ())
+		{
+			auto& width = asciiWidths[static_cast<uint8_t> (character[0])];
+			if (width < 0.)
+				width = measure (character);
+			return width;
+		}
+		return measure (character);
+	}
+
+	VSTGUI::SharedPointer<VSTGUI::CFontDesc> desc;
+	XYPOSITION ascent {0.};
+	XYPOSITION descent {0.};
+	XYPOSITION leading {0.};
+	XYPOSITION averageCharWidth {1.};
+
+private:
+	mutable std::array<XYPOSITION, 128> asciiWidths;
+};
+
+//------------------------------------------------------------------------
+inline const FontVSTGUI* toFont (const Font* font)
+{
+	return static_cast<const FontVSTGUI*> (font);
+}
+
+//------------------------------------------------------------------------
+inline size_t utf8CharacterLength (std::string_view text, size_t pos)
+{
+	auto c = static_cast<uint8_t> (text[pos]);
+	size_t length = 1;
+	if (c >= 0xF0)
+		length = 4;
+	else if (c >= 0xE0)
+		length = 3;
+	else if (c >= 0xC0)
+		length = 2;
+	return std::min (length, text.size () - pos);
+}
+
+//------------------------------------------------------------------------
+/** Scintilla Surface implementation drawing into a VSTGUI CDrawContext
+ *
+ *	When initialized with a window only (no draw context) the surface can only be used for
+ *	measuring text.
+ */
+class SurfaceVSTGUI final : public Surface
+{
+public:
+	~SurfaceVSTGUI () noexcept override { Release (); }
+
+	void Init (WindowID wid) override
+	{
+		Release ();
+		window = wid;
+	}
+
+	void Init (SurfaceID sid, WindowID wid) override
+	{
+		Release ();
+		context = static_cast<VSTGUI::CDrawContext*> (sid);
+		window = wid;
+		if (context)
+			context->setDrawMode (VSTGUI::kAntiAliasing | VSTGUI::kNonIntegralMode);
+	}
+
+	std::unique_ptr<Surface> AllocatePixMap (int width, int height) override
+	{
+		auto surface = std::make_unique<SurfaceVSTGUI> ();
+		surface->window = window;
+		surface->mode = mode;
+		surface->offscreen = VSTGUI::COffscreenContext::create (
+		    {static_cast<VSTGUI::CCoord> (std::max (width, 1)),
+		     static_cast<VSTGUI::CCoord> (std::max (height, 1))});
+		if (surface->offscreen)
+		{
+			surface->offscreen->beginDraw ();
+			surface->context = surface->offscreen;
+			surface->context->setDrawMode (VSTGUI::kAntiAliasing | VSTGUI::kNonIntegralMode);
+		}
+		return surface;
+	}
+
+	void SetMode (SurfaceMode inMode) override { mode = inMode; }
+
+	void Release () noexcept override
+	{
+		if (context)
+		{
+			while (clipDepth > 0)
+				PopClip ();
+		}
+		if (offscreen)
+		{
+			offscreen->endDraw ();
+			offscreen = nullptr;
+		}
+		context = nullptr;
+	}
+
+	int SupportsFeature (Supports feature) noexcept override
+	{
+		switch (feature)
+		{
+			case Supports::FractionalStrokeWidth:
+			case Supports::TranslucentStroke: return 1;
+			default: return 0;
+		}
+	}
+
+	bool Initialised () override { return context != nullptr; }
+	int LogPixelsY () override { return 72; }
+	int PixelDivisions () override { return 1; }
+	int DeviceHeightFont (int points) override { return points; }
+
+	void LineDraw (Point start, Point end, Stroke stroke) override
+	{
+		if (!context)
+			return;
+		setStroke (stroke);
+		context->drawLine (toCPoint (start), toCPoint (end));
+	}
+
+	void PolyLine (const Point* pts, size_t npts, Stroke stroke) override
+	{
+		if (!context || npts < 2)
+			return;
+		auto path = VSTGUI::owned (context->createGraphicsPath ());
+		if (!path)
+			return;
+		path->beginSubpath (toCPoint (pts[0]));
+		for (auto i = 1u; i < npts; ++i)
+			path->addLine (toCPoint (pts[i]));
+		setStroke (stroke);
+		context->drawGraphicsPath (path, VSTGUI::CDrawContext::kPathStroked);
+	}
+
+	void Polygon (const Point* pts, size_t npts, FillStroke fillStroke) override
+	{
+		if (!context || npts < 3)
+			return;
+		VSTGUI::CDrawContext::PointList points;
+		points.reserve (npts);
+		for (auto i = 0u; i < npts; ++i)
+			points.emplace_back (toCPoint (pts[i]));
+		setFillStroke (fillStroke);
+		context->drawPolygon (points, VSTGUI::kDrawFilledAndStroked);
+	}
+
+	void RectangleDraw (PRectangle rc, FillStroke fillStroke) override
+	{
+		if (!context)
+			return;
+		setFillStroke (fillStroke);
+		auto r = toCRect (rc);
+		auto halfWidth = fillStroke.stroke.width / 2.;
+		r.inset (halfWidth, halfWidth);
+		context->drawRect (r, VSTGUI::kDrawFilledAndStroked);
+	}
+
+	void RectangleFrame (PRectangle rc, Stroke stroke) override
+	{
+		if (!context)
+			return;
+		setStroke (stroke);
+		auto r = toCRect (rc);
+		r.inset (stroke.width / 2., stroke.width / 2.);
+		context->drawRect (r, VSTGUI::kDrawStroked);
+	}
+
+	void FillRectangle (PRectangle rc, Fill fill) override
+	{
+		if (!context)
+			return;
+		context->setFillColor (toCColor (fill.colour));
+		context->drawRect (toCRect (rc), VSTGUI::kDrawFilled);
+	}
+
+	void FillRectangleAligned (PRectangle rc, Fill fill) override
+	{
+		FillRectangle (PRectangle (std::round (rc.left), std::round (rc.top), std::round (rc.right),
+		                           std::round (rc.bottom)),
+		               fill);
+	}
+
+	void FillRectangle (PRectangle rc, Surface& surfacePattern) override
+	{
+		if (!context)
+			return;
+		auto& pattern = static_cast<SurfaceVSTGUI&> (surfacePattern);
+		auto bitmap = pattern.getBitmap ();
+		if (!bitmap)
+		{
+			// something is better than nothing
+			FillRectangle (rc, Fill (ColourRGBA (0xd0, 0xd0, 0xd0)));
+			return;
+		}
+		auto size = bitmap->getSize ();
+		context->fillRectWithBitmap (bitmap, VSTGUI::CRect (0, 0, size.x, size.y), toCRect (rc),
+		                             1.f);
+	}
+
+	void RoundedRectangle (PRectangle rc, FillStroke fillStroke) override
+	{
+		drawRoundRect (rc, 3., fillStroke);
+	}
+
+	void AlphaRectangle (PRectangle rc, XYPOSITION cornerSize, FillStroke fillStroke) override
+	{
+		if (cornerSize <= 0.)
+		{
+			RectangleDraw (rc, fillStroke);
+			return;
+		}
+		drawRoundRect (rc, cornerSize, fillStroke);
+	}
+
+	void GradientRectangle (PRectangle rc, const std::vector<ColourStop>& stops,
+	                        GradientOptions options) override
+	{
+		if (!context || stops.empty ())
+			return;
+		VSTGUI::CGradient::ColorStopMap colorStops;
+		for (const auto& stop : stops)
+			colorStops.emplace (stop.position, toCColor (stop.colour));
+		auto gradient = VSTGUI::owned (VSTGUI::CGradient::create (colorStops));
+		auto path = VSTGUI::owned (context->createGraphicsPath ());
+		if (!gradient || !path)
+			return;
+		auto r = toCRect (rc);
+		path->addRect (r);
+		auto end = options == GradientOptions::leftToRight ? r.getTopRight () : r.getBottomLeft ();
+		context->fillLinearGradient (path, *gradient, r.getTopLeft (), end);
+	}
+
+	void DrawRGBAImage (PRectangle rc, int width, int height,
+	                    const unsigned char* pixelsImage) override
+	{
+		if (!context || width <= 0 || height <= 0)
+			return;
+		auto bitmap = VSTGUI::makeOwned<VSTGUI::CBitmap> (
+		    VSTGUI::CPoint (static_cast<VSTGUI::CCoord> (width), static_cast<VSTGUI::CCoord> (height)));
+		{
+			// the pixels are written back to the bitmap when the access is released
+			auto access = VSTGUI::owned (VSTGUI::CBitmapPixelAccess::create (bitmap, false));
+			if (!access)
+				return;
+			for (auto y = 0; y < height; ++y)
+			{
+				for (auto x = 0; x < width; ++x, pixelsImage += 4)
+				{
+					access->setPosition (static_cast<uint32_t> (x), static_cast<uint32_t> (y));
+					access->setColor (VSTGUI::CColor (pixelsImage[0], pixelsImage[1],
+					                                  pixelsImage[2], pixelsImage[3]));
+				}
+			}
+		}
+		auto x = rc.left + std::floor ((rc.Width () - width) / 2.);
+		auto y = rc.top + std::floor ((rc.Height () - height) / 2.);
+		context->drawBitmap (bitmap, VSTGUI::CRect (x, y, x + width, y + height));
+	}
+
+	void Ellipse (PRectangle rc, FillStroke fillStroke) override
+	{
+		if (!context)
+			return;
+		setFillStroke (fillStroke);
+		context->drawEllipse (toCRect (rc), VSTGUI::kDrawFilledAndStroked);
+	}
+
+	void Stadium (PRectangle rc, FillStroke fillStroke, Ends ends) override
+	{
+		drawRoundRect (rc, rc.Height () / 2., fillStroke);
+	}
+
+	void Copy (PRectangle rc, Point from, Surface& surfaceSource) override
+	{
+		if (!context)
+			return;
+		auto& source = static_cast<SurfaceVSTGUI&> (surfaceSource);
+		source.FlushDrawing ();
+		if (auto bitmap = source.getBitmap ())
+			context->drawBitmap (bitmap, toCRect (rc), toCPoint (from));
+	}
+
+	std::unique_ptr<IScreenLineLayout> Layout (const IScreenLine* screenLine) override
+	{
+		return nullptr;
+	}
+
+	void DrawTextNoClip (PRectangle rc, const Font* font_, XYPOSITION ybase, std::string_view text,
+	                     ColourRGBA fore, ColourRGBA back) override
+	{
+		FillRectangle (rc, Fill (back));
+		drawText (rc, font_, ybase, text, fore);
+	}
+
+	void DrawTextClipped (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                      std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+		SetClip (rc);
+		DrawTextNoClip (rc, font_, ybase, text, fore, back);
+		PopClip ();
+	}
+
+	void DrawTextTransparent (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                          std::string_view text, ColourRGBA fore) override
+	{
+		drawText (rc, font_, ybase, text, fore);
+	}
+
+	void MeasureWidths (const Font* font_, std::string_view text, XYPOSITION* positions) override
+	{
+		auto font = toFont (font_);
+		XYPOSITION x = 0.;
+		for (size_t pos = 0; pos < text.size ();)
+		{
+			auto length = utf8CharacterLength (text, pos);
+			x += font->measureCharacter (text.substr (pos, length));
+			for (auto i = 0u; i < length; ++i)
+				positions[pos++] = x;
+		}
+	}
+
+	XYPOSITION WidthText (const Font* font_, std::string_view text) override
+	{
+		auto font = toFont (font_);
+		XYPOSITION width = 0.;
+		for (size_t pos = 0; pos < text.size ();)
+		{
+			auto length = utf8CharacterLength (text, pos);
+			width += font->measureCharacter (text.substr (pos, length));
+			pos += length;
+		}
+		return width;
+	}
+
+	void DrawTextNoClipUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                         std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+		DrawTextNoClip (rc, font_, ybase, text, fore, back);
+	}
+
+	void DrawTextClippedUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                          std::string_view text, ColourRGBA fore, ColourRGBA back) override
+	{
+		DrawTextClipped (rc, font_, ybase, text, fore, back);
+	}
+
+	void DrawTextTransparentUTF8 (PRectangle rc, const Font* font_, XYPOSITION ybase,
+	                              std::string_view text, ColourRGBA fore) override
+	{
+		DrawTextTransparent (rc, font_, ybase, text, fore);
+	}
+
+	void MeasureWidthsUTF8 (const Font* font_, std::string_view text,
+	                        XYPOSITION* positions) override
+	{
+		MeasureWidths (font_, text, positions);
+	}
+
+	XYPOSITION WidthTextUTF8 (const Font* font_, std::string_view text) override
+	{
+		return WidthText (font_, text);
+	}
+
+	XYPOSITION Ascent (const Font* font_) override { return toFont (font_)->ascent; }
+	XYPOSITION Descent (const Font* font_) override { return toFont (font_)->descent; }
+	XYPOSITION InternalLeading (const Font* font_) override { return toFont (font_)->leading; }
+	XYPOSITION Height (const Font* font_) override
+	{
+		return toFont (font_)->ascent + toFont (font_)->descent;
+	}
+	XYPOSITION AverageCharWidth (const Font* font_) override
+	{
+		return toFont (font_)->averageCharWidth;
+	}
+
+	void SetClip (PRectangle rc) override
+	{
+		if (!context)
+			return;
+		context->saveGlobalState ();
+		VSTGUI::CRect clip;
+		context->getClipRect (clip);
+		context->setClipRect (clip.bound (toCRect (rc)));
+		++clipDepth;
+	}
+
+	void PopClip () override
+	{
+		if (!context || clipDepth == 0)
+			return;
+		context->restoreGlobalState ();
+		--clipDepth;
+	}
+
+	void FlushCachedState () override {}
+
+	void FlushDrawing () override
+	{
+		if (offscreen)
+		{
+			offscreen->endDraw ();
+			offscreen->beginDraw ();
+		}
+	}
+
+private:
+	VSTGUI::CBitmap* getBitmap () const { return offscreen ? offscreen->getBitmap () : nullptr; }
+
+	void setStroke (const Stroke& stroke)
+	{
+		context->setFrameColor (toCColor (stroke.colour));
+		context->setLineWidth (stroke.width);
+	}
+
+	void setFillStroke (const FillStroke& fillStroke)
+	{
+		context->setFillColor (toCColor (fillStroke.fill.colour));
+		setStroke (fillStroke.stroke);
+	}
+
+	void drawRoundRect (PRectangle rc, XYPOSITION radius, const FillStroke& fillStroke)
+	{
+		if (!context)
+			return;
+		auto path = VSTGUI::owned (context->createRoundRectGraphicsPath (toCRect (rc), radius));
+		if (!path)
+			return;
+		setFillStroke (fillStroke);
+		context->drawGraphicsPath (path, VSTGUI::CDrawContext::kPathFilled);
+		context->drawGraphicsPath (path, VSTGUI::CDrawContext::kPathStroked);
+	}
+
+	void drawText (PRectangle rc, const Font* font_, XYPOSITION ybase, std::string_view text,
+	               ColourRGBA fore)
+	{
+		if (!context || text.empty ())
+			return;
+		context->setFont (toFont (font_)->desc);
+		context->setFontColor (toCColor (fore));
+		context->drawString (std::string (text).data (), VSTGUI::CPoint (rc.left, ybase), true);
+	}
+
+	VSTGUI::CDrawContext* context {nullptr};
+	VSTGUI::SharedPointer<VSTGUI::COffscreenContext> offscreen;
+	WindowID window {nullptr};
+	SurfaceMode mode;
+	uint32_t clipDepth {0};
+};
+
+//------------------------------------------------------------------------
+using Clock = std::chrono::steady_clock;
+
+//------------------------------------------------------------------------
+inline unsigned int currentTimeMS ()
+{
+	return static_cast<unsigned int> (
+	    std::chrono::duration_cast<std::chrono::milliseconds> (Clock::now ().time_since_epoch ())
+	        .count ());
+}
+
+//------------------------------------------------------------------------
+class ScintillaVSTGUI final : public ScintillaEditorBase
+{
+public:
+	ScintillaVSTGUI (VSTGUI::CView* hostView, NotifyFunc&& notify)
+	: ScintillaEditorBase (std::move (notify)), hostView (hostView)
+	{
+	}
+
+	~ScintillaVSTGUI () noexcept override
+	{
+		Finalise ();
+		for (auto index = 0u; index < tickers.size (); ++index)
+			FineTickerCancel (static_cast<TickReason> (index));
+	}
+
+	void paint (VSTGUI::CDrawContext* context, PRectangle area)
+	{
+		paintState = PaintState::painting;
+		rcPaint = area;
+		paintingAllText = rcPaint.Contains (GetClientRectangle ());
+		auto surface = Surface::Allocate (technology);
+		surface->Init (context, wMain.GetID ());
+		Paint (surface.get (), rcPaint);
+		surface->Release ();
+		if (paintState == PaintState::abandoned)
+			Redraw ();
+		paintState = PaintState::notPainting;
+	}
+
+	void mouseDown (Point pt, KeyMod modifiers, bool rightButton)
+	{
+		if (rightButton)
+			RightButtonDownWithModifiers (pt, currentTimeMS (), modifiers);
+		else
+			ButtonDownWithModifiers (pt, currentTimeMS (), modifiers);
+	}
+
+	void mouseMoved (Point pt, KeyMod modifiers)
+	{
+		ButtonMoveWithModifiers (pt, currentTimeMS (), modifiers);
+	}
+
+	void mouseUp (Point pt, KeyMod modifiers)
+	{
+		ButtonUpWithModifiers (pt, currentTimeMS (), modifiers);
+	}
+
+	bool keyDown (Keys key, KeyMod modifiers)
+	{
+		bool consumed = false;
+		auto added = KeyDownWithModifiers (key, modifiers, &consumed) != 0;
+		return consumed || added;
+	}
+
+	void insertCharacter (std::string_view utf8)
+	{
+		InsertCharacter (utf8, CharacterSource::DirectInput);
+	}
+
+	// IWindowHost
+	PRectangle getPosition () const override
+	{
+		auto r = hostView->getViewSize ();
+		return PRectangle (0., 0., r.getWidth (), r.getHeight ());
+	}
+
+	void invalidate (PRectangle rc) override
+	{
+		auto r = toCRect (rc);
+		r.offset (hostView->getViewSize ().left, hostView->getViewSize ().top);
+		hostView->invalidRect (r);
+	}
+
+	void invalidateAll () override { hostView->invalid (); }
+
+	void setCursor (Window::Cursor cursor) override
+	{
+		auto frame = hostView->getFrame ();
+		if (!frame)
+			return;
+		switch (cursor)
+		{
+			case Window::Cursor::text: frame->setCursor (VSTGUI::kCursorIBeam); break;
+			case Window::Cursor::hand: frame->setCursor (VSTGUI::kCursorHand); break;
+			case Window::Cursor::wait: frame->setCursor (VSTGUI::kCursorWait); break;
+			case Window::Cursor::horizontal: frame->setCursor (VSTGUI::kCursorHSize); break;
+			case Window::Cursor::vertical: frame->setCursor (VSTGUI::kCursorVSize); break;
+			default: frame->setCursor (VSTGUI::kCursorDefault); break;
+		}
+	}
+
+private:
+	void Copy () override
+	{
+		if (sel.Empty ())
+			return;
+		SelectionText selectedText;
+		CopySelectionRange (&selectedText);
+		CopyToClipboard (selectedText);
+	}
+
+	void CopyToClipboard (const SelectionText& selectedText) override
+	{
+		if (auto frame = hostView->getFrame ())
+		{
+			frame->setClipboard (VSTGUI::CDropSource::create (
+			    selectedText.Data (), static_cast<uint32_t> (selectedText.Length ()),
+			    VSTGUI::IDataPackage::kText));
+		}
+	}
+
+	void Paste () override
+	{
+		auto frame = hostView->getFrame ();
+		if (!frame)
+			return;
+		auto clipboard = frame->getClipboard ();
+		if (!clipboard)
+			return;
+		for (auto index = 0u; index < clipboard->getCount (); ++index)
+		{
+			const void* buffer = nullptr;
+			VSTGUI::IDataPackage::Type type;
+			auto size = clipboard->getData (index, buffer, type);
+			if (type != VSTGUI::IDataPackage::kText || size == 0 || buffer == nullptr)
+				continue;
+			std::string_view text (static_cast<const char*> (buffer), size);
+			if (text.back () == 0)
+				text.remove_suffix (1);
+			UndoGroup undoGroup (pdoc);
+			ClearSelection (multiPasteMode == MultiPaste::Each);
+			InsertPasteShape (text.data (), static_cast<Sci::Position> (text.size ()),
+			                  PasteShape::stream);
+			EnsureCaretVisible ();
+			break;
+		}
+	}
+
+	bool FineTickerRunning (TickReason reason) override
+	{
+		return tickers[static_cast<size_t> (reason)] != nullptr;
+	}
+
+	void FineTickerStart (TickReason reason, int millis, int tolerance) override
+	{
+		FineTickerCancel (reason);
+		tickers[static_cast<size_t> (reason)] = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer> (
+		    [this, reason] (VSTGUI::CVSTGUITimer* timer) {
+			    VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> guard (timer);
+			    TickFor (reason);
+		    },
+		    static_cast<uint32_t> (std::max (millis, 1)));
+	}
+
+	void FineTickerCancel (TickReason reason) override
+	{
+		auto& ticker = tickers[static_cast<size_t> (reason)];
+		if (ticker)
+		{
+			ticker->stop ();
+			ticker = nullptr;
+		}
+	}
+
+	bool SetIdle (bool on) override
+	{
+		if (on && !idler.state)
+		{
+			idler.state = true;
+			idleTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer> (
+			    [this] (VSTGUI::CVSTGUITimer* timer) {
+				    VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> guard (timer);
+				    if (!Idle ())
+					    SetIdle (false);
+			    },
+			    10);
+		}
+		else if (!on && idler.state)
+		{
+			idler.state = false;
+			if (idleTimer)
+				idleTimer->stop ();
+			idleTimer = nullptr;
+		}
+		return true;
+	}
+
+	VSTGUI::CView* hostView;
+	std::array<VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer>, 5> tickers;
+	VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> idleTimer;
+};
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+std::shared_ptr<Font> Font::Allocate (const FontParameters& fp)
+{
+	return std::make_shared<FontVSTGUI> (fp);
+}
+
+//------------------------------------------------------------------------
+std::unique_ptr<Surface> Surface::Allocate (Technology)
+{
+	return std::make_unique<SurfaceVSTGUI> ();
+}
+
+//------------------------------------------------------------------------
+} // Scintilla::Internal
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+using Scintilla::Internal::ScintillaVSTGUI;
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+Scintilla::KeyMod toKeyMod (int32_t modifierState)
+{
+	int modifiers = 0;
+	if (modifierState & kShift)
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Shift);
+	if (modifierState & (kControl | kApple))
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Ctrl);
+	if (modifierState & kAlt)
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Alt);
+	return static_cast<Scintilla::KeyMod> (modifiers);
+}
+
+//------------------------------------------------------------------------
+Scintilla::KeyMod toKeyMod (const VstKeyCode& keyCode)
+{
+	int modifiers = 0;
+	if (keyCode.modifier & MODIFIER_SHIFT)
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Shift);
+	if (keyCode.modifier & (MODIFIER_CONTROL | MODIFIER_COMMAND))
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Ctrl);
+	if (keyCode.modifier & MODIFIER_ALTERNATE)
+		modifiers |= static_cast<int> (Scintilla::KeyMod::Alt);
+	return static_cast<Scintilla::KeyMod> (modifiers);
+}
+
+//------------------------------------------------------------------------
+bool toScintillaKey (unsigned char virt, Scintilla::Keys& key)
+{
+	using Keys = Scintilla::Keys;
+	switch (virt)
+	{
+		case VKEY_BACK: key = Keys::Back; return true;
+		case VKEY_TAB: key = Keys::Tab; return true;
+		case VKEY_RETURN:
+		case VKEY_ENTER: key = Keys::Return; return true;
+		case VKEY_ESCAPE: key = Keys::Escape; return true;
+		case VKEY_END: key = Keys::End; return true;
+		case VKEY_HOME: key = Keys::Home; return true;
+		case VKEY_LEFT: key = Keys::Left; return true;
+		case VKEY_UP: key = Keys::Up; return true;
+		case VKEY_RIGHT: key = Keys::Right; return true;
+		case VKEY_DOWN: key = Keys::Down; return true;
+		case VKEY_PAGEUP: key = Keys::Prior; return true;
+		case VKEY_PAGEDOWN: key = Keys::Next; return true;
+		case VKEY_INSERT: key = Keys::Insert; return true;
+		case VKEY_DELETE: key = Keys::Delete; return true;
+		case VKEY_ADD: key = Keys::Add; return true;
+		case VKEY_SUBTRACT: key = Keys::Subtract; return true;
+		case VKEY_DIVIDE: key = Keys::Divide; return true;
+		default: break;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+std::string toUTF8 (char32_t c)
+{
+	std::string result;
+	if (c < 0x80)
+		result += static_cast<char> (c);
+	else if (c < 0x800)
+	{
+		result += static_cast<char> (0xC0 | (c >> 6));
+		result += static_cast<char> (0x80 | (c & 0x3F));
+	}
+	else if (c < 0x10000)
+	{
+		result += static_cast<char> (0xE0 | (c >> 12));
+		result += static_cast<char> (0x80 | ((c >> 6) & 0x3F));
+		result += static_cast<char> (0x80 | (c & 0x3F));
+	}
+	else
+	{
+		result += static_cast<char> (0xF0 | (c >> 18));
+		result += static_cast<char> (0x80 | ((c >> 12) & 0x3F));
+		result += static_cast<char> (0x80 | ((c >> 6) & 0x3F));
+		result += static_cast<char> (0x80 | (c & 0x3F));
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+struct ScintillaEditorView::Impl
+{
+	std::unique_ptr<ScintillaVSTGUI> editor;
+};
+
+//------------------------------------------------------------------------
+ScintillaEditorView::ScintillaEditorView () : CView (CRect (0, 0, 0, 0))
+{
+	impl = std::make_unique<Impl> ();
+	impl->editor =
+	    std::make_unique<ScintillaVSTGUI> (this, [this] (SCNotification* notification) {
+		    dispatchNotification (notification);
+	    });
+	init ();
+}
+
+//------------------------------------------------------------------------
+ScintillaEditorView::~ScintillaEditorView () noexcept
+{
+	if (impl)
+		impl->editor = nullptr;
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::draw (CDrawContext* pContext)
+{
+	if (impl && impl->editor)
+	{
+		const auto& viewSize = getViewSize ();
+		CRect updateRect;
+		pContext->getClipRect (updateRect);
+		updateRect.bound (viewSize);
+		updateRect.offset (-viewSize.left, -viewSize.top);
+		if (!updateRect.isEmpty ())
+		{
+			CDrawContext::Transform transform (
+			    *pContext, CGraphicsTransform ().translate (viewSize.left, viewSize.top));
+			impl->editor->paint (pContext, {updateRect.left, updateRect.top, updateRect.right,
+			                                updateRect.bottom});
+		}
+	}
+	setDirty (false);
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::attached (CView* parent)
+{
+	if (CView::attached (parent))
+	{
+		impl->editor->resized ();
+		startPendingTimers ();
+		return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::removed (CView* parent)
+{
+	return CView::removed (parent);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setViewSize (const CRect& rect, bool invalid)
+{
+	CView::setViewSize (rect, invalid);
+	if (impl && impl->editor)
+		impl->editor->resized ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::setMouseEnabled (bool enable)
+{
+	CView::setMouseEnabled (enable);
+	sendMessage (SCI_SETREADONLY, !enable);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorView::platformSetBackgroundColor (const CColor& color)
+{
+	invalid ();
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseDown (CPoint& where, const CButtonState& buttons)
+{
+	if (!impl || !getMouseEnabled ())
+		return kMouseEventNotHandled;
+	auto pos = where - getViewSize ().getTopLeft ();
+	impl->editor->mouseDown ({pos.x, pos.y}, toKeyMod (buttons.getModifierState ()),
+	                         buttons.isRightButton ());
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseUp (CPoint& where, const CButtonState& buttons)
+{
+	if (!impl)
+		return kMouseEventNotHandled;
+	auto pos = where - getViewSize ().getTopLeft ();
+	impl->editor->mouseUp ({pos.x, pos.y}, toKeyMod (buttons.getModifierState ()));
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaEditorView::onMouseMoved (CPoint& where, const CButtonState& buttons)
+{
+	if (!impl)
+		return kMouseEventNotHandled;
+	auto pos = where - getViewSize ().getTopLeft ();
+	impl->editor->mouseMoved ({pos.x, pos.y}, toKeyMod (buttons.getModifierState ()));
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+bool ScintillaEditorView::onWheel (const CPoint& where, const CMouseWheelAxis& axis,
+                                   const float& distance, const CButtonState& buttons)
+{
+	if (!impl)
+		return false;
+	auto amount = static_cast<intptr_t> (std::lround (-distance * 3.f));
+	if (axis == kMouseWheelAxisX)
+		sendMessage (SCI_LINESCROLL, amount, 0);
+	else
+		sendMessage (SCI_LINESCROLL, 0, amount);
+	return true;
+}
+
+//------------------------------------------------------------------------
+int32_t ScintillaEditorView::onKeyDown (VstKeyCode& keyCode)
+{
+	if (!impl || !getMouseEnabled ())
+		return -1;
+	auto modifiers = toKeyMod (keyCode);
+	Scintilla::Keys key;
+	if (keyCode.virt != 0 && keyCode.virt != VKEY_SPACE)
+	{
+		if (toScintillaKey (keyCode.virt, key))
+			return impl->editor->keyDown (key, modifiers) ? 1 : -1;
+		return -1;
+	}
+	auto character = static_cast<char32_t> (keyCode.virt == VKEY_SPACE ? ' ' : keyCode.character);
+	if (character == 0)
+		return -1;
+	if (keyCode.modifier & (MODIFIER_CONTROL | MODIFIER_COMMAND))
+	{
+		key = static_cast<Scintilla::Keys> (std::toupper (static_cast<int> (character)));
+		return impl->editor->keyDown (key, modifiers) ? 1 : -1;
+	}
+	impl->editor->insertCharacter (toUTF8 (character));
+	return 1;
+}
+
+//------------------------------------------------------------------------
+intptr_t ScintillaEditorView::sendMessage (uint32_t message, uintptr_t wParam,
+                                           intptr_t lParam) const
+{
+	SCINTILLA_RECORD_MESSAGE (message);
+	return (impl && impl->editor) ? impl->editor->send (message, wParam, lParam) : 0;
+}
+
+//------------------------------------------------------------------------
+Scintilla::ILexer5* ScintillaEditorView::createLexer (const char* name)
+{
+	return CreateLexer (name);
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
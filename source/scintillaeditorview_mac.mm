@@ -4,7 +4,6 @@
 
 #import "scintillaeditorview.h"
 #import "vstgui/lib/cframe.h"
-#import "vstgui/lib/dispatchlist.h"
 #import "vstgui/lib/platform/platform_macos.h"
 #import "Lexilla.h"
 #import <Scintilla/ScintillaView.h>
@@ -38,7 +37,12 @@ struct ScintillaEditorView::Impl
 {
 	ScintillaView* view {nil};
 	VSTGUI_ScintillaView_Delegate* delegate {nil};
-	DispatchList<IScintillaListener*> listeners;
+	ScintillaEditorView* editorView {nullptr};
+
+	void dispatchNotification (SCNotification* notification)
+	{
+		editorView->dispatchNotification (notification);
+	}
 };
 
 //------------------------------------------------------------------------
@@ -46,6 +50,7 @@ ScintillaEditorView::ScintillaEditorView () : CView (CRect (0, 0, 0, 0))
 {
 	impl = std::make_unique<Impl> ();
 	impl->delegate = [VSTGUI_ScintillaView_Delegate new];
+	impl->editorView = this;
 	impl->delegate.impl = impl.get ();
 	impl->view = [[ScintillaView alloc] initWithFrame:NSMakeRect (0, 0, 10, 10)];
 	impl->view.delegate = impl->delegate;
@@ -84,6 +89,7 @@ bool ScintillaEditorView::attached (CView* parent)
 	{
 		setViewSize (getViewSize (), false);
 		[cocoaFrame->getNSView () addSubview:impl->view];
+		startPendingTimers ();
 		return true;
 	}
 	return false;
@@ -134,21 +140,10 @@ void ScintillaEditorView::platformSetBackgroundColor (const CColor& color)
 intptr_t ScintillaEditorView::sendMessage (uint32_t message, uintptr_t wParam,
                                            intptr_t lParam) const
 {
+	SCINTILLA_RECORD_MESSAGE (message);
 	return [impl->view message:message wParam:wParam lParam:lParam];
 }
 
-//------------------------------------------------------------------------
-void ScintillaEditorView::registerListener (IScintillaListener* listener)
-{
-	impl->listeners.add (listener);
-}
-
-//------------------------------------------------------------------------
-void ScintillaEditorView::unregisterListener (IScintillaListener* listener)
-{
-	impl->listeners.remove (listener);
-}
-
 //------------------------------------------------------------------------
 Scintilla::ILexer5* ScintillaEditorView::createLexer (const char* name)
 {
@@ -164,8 +159,7 @@ Scintilla::ILexer5* ScintillaEditorView::createLexer (const char* name)
 //------------------------------------------------------------------------
 - (void)notification:(SCNotification*)notification
 {
-	self.impl->listeners.forEach (
-	    [&] (auto& listener) { listener->onScintillaNotification (notification); });
+	self.impl->dispatchNotification (notification);
 }
 
 @end
@@ -4,8 +4,8 @@
 
 #include "Scintilla.h"
 #include "scintillaeditorview.h"
+#include "scintillamessagestats.h"
 #include "vstgui/lib/cframe.h"
-#include "vstgui/lib/dispatchlist.h"
 #include "vstgui/lib/iscalefactorchangedlistener.h"
 #include "vstgui/lib/platform/platform_win32.h"
 #include "vstgui/lib/platform/win32/win32factory.h"
@@ -188,7 +188,6 @@ struct ScintillaEditorView::Impl
 {
 	using DirectFunc = int (__cdecl*) (void*, UINT, WPARAM, LPARAM);
 
-	DispatchList<IScintillaListener*> listeners;
 	HWND control;
 	std::unique_ptr<HWNDWrapper> window;
 	std::unique_ptr<HWNDWrapper> invisibleWindow;
@@ -241,8 +240,7 @@ ScintillaEditorView::ScintillaEditorView () : CView (CRect (0, 0, 0, 0))
 		if (message == WM_NOTIFY)
 		{
 			auto notification = reinterpret_cast<SCNotification*> (lParam);
-			impl->listeners.forEach (
-			    [&] (auto& listener) { listener->onScintillaNotification (notification); });
+			dispatchNotification (notification);
 		}
 		return DefWindowProc (hwnd, message, wParam, lParam);
 	});
@@ -286,6 +284,7 @@ bool ScintillaEditorView::attached (CView* parent)
 		setViewSize (getViewSize (), false);
 		SetParent (impl->control, impl->window->getHWND ());
 		getFrame ()->registerScaleFactorChangedListeneer (&impl->scaleFactorChangeListener);
+		startPendingTimers ();
 		return true;
 	}
 	return false;
@@ -334,21 +333,10 @@ void ScintillaEditorView::platformSetBackgroundColor (const CColor& color)
 intptr_t ScintillaEditorView::sendMessage (uint32_t message, uintptr_t wParam,
                                            intptr_t lParam) const
 {
+	SCINTILLA_RECORD_MESSAGE (message);
 	return (impl && impl->directFn) ? impl->directFn (impl->directPtr, message, wParam, lParam) : 0;
 }
 
-//------------------------------------------------------------------------
-void ScintillaEditorView::registerListener (IScintillaListener* listener)
-{
-	impl->listeners.add (listener);
-}
-
-//------------------------------------------------------------------------
-void ScintillaEditorView::unregisterListener (IScintillaListener* listener)
-{
-	impl->listeners.remove (listener);
-}
-
 //------------------------------------------------------------------------
 Scintilla::ILexer5* ScintillaEditorView::createLexer (const char* name)
 {
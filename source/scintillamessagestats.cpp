@@ -0,0 +1,133 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillamessagestats.h"
+
+#include <memory>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** scintilla messages start at 2000, the lexer messages end below 6096 */
+constexpr uint32_t FirstMessage = 2000;
+constexpr uint32_t NumMessages = 4096;
+
+//------------------------------------------------------------------------
+struct AtomicEntry
+{
+	std::atomic<uint64_t> count {0};
+	std::atomic<uint64_t> totalNanoseconds {0};
+	std::atomic<uint64_t> maxNanoseconds {0};
+	std::array<std::atomic<uint64_t>, ScintillaMessageStats::NumBuckets> histogram {};
+};
+
+//------------------------------------------------------------------------
+/** one entry per message plus one for all messages outside of the known range */
+using Table = std::array<AtomicEntry, NumMessages + 1>;
+
+//------------------------------------------------------------------------
+Table& table ()
+{
+	static auto instance = std::make_unique<Table> ();
+	return *instance;
+}
+
+//------------------------------------------------------------------------
+size_t bucketIndex (uint64_t nanoseconds)
+{
+	constexpr auto LastBucket = ScintillaMessageStats::NumBuckets - 1;
+	size_t index = 0;
+	for (auto bound = uint64_t {128}; nanoseconds >= bound && index < LastBucket; bound <<= 1)
+		++index;
+	return index;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+void ScintillaMessageStats::record (uint32_t message, uint64_t nanoseconds)
+{
+	auto index = (message >= FirstMessage && message < FirstMessage + NumMessages)
+	                 ? message - FirstMessage
+	                 : NumMessages;
+	auto& entry = table ()[index];
+	entry.count.fetch_add (1, std::memory_order_relaxed);
+	entry.totalNanoseconds.fetch_add (nanoseconds, std::memory_order_relaxed);
+	entry.histogram[bucketIndex (nanoseconds)].fetch_add (1, std::memory_order_relaxed);
+	auto max = entry.maxNanoseconds.load (std::memory_order_relaxed);
+	while (nanoseconds > max &&
+	       !entry.maxNanoseconds.compare_exchange_weak (max, nanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+//------------------------------------------------------------------------
+auto ScintillaMessageStats::snapshot () -> Snapshot
+{
+	Snapshot result;
+	auto& entries = table ();
+	for (uint32_t index = 0; index < entries.size (); ++index)
+	{
+		const auto& entry = entries[index];
+		auto count = entry.count.load (std::memory_order_relaxed);
+		if (count == 0)
+			continue;
+		Entry e;
+		// messages outside of the known range are reported as message 0
+		e.message = index < NumMessages ? FirstMessage + index : 0;
+		e.count = count;
+		e.totalNanoseconds = entry.totalNanoseconds.load (std::memory_order_relaxed);
+		e.maxNanoseconds = entry.maxNanoseconds.load (std::memory_order_relaxed);
+		for (size_t bucket = 0; bucket < NumBuckets; ++bucket)
+			e.histogram[bucket] = entry.histogram[bucket].load (std::memory_order_relaxed);
+		result.emplace_back (e);
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+void ScintillaMessageStats::reset ()
+{
+	for (auto& entry : table ())
+	{
+		entry.count = 0;
+		entry.totalNanoseconds = 0;
+		entry.maxNanoseconds = 0;
+		for (auto& bucket : entry.histogram)
+			bucket = 0;
+	}
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaMessageStats::toCSV (const Snapshot& snapshot)
+{
+	std::string csv = "message,count,total_ns,mean_ns,max_ns";
+	for (size_t bucket = 0; bucket < NumBuckets; ++bucket)
+	{
+		if (bucket == NumBuckets - 1)
+			csv += ",>=" + std::to_string (uint64_t {128} << (bucket - 1)) + "ns";
+		else
+			csv += ",<" + std::to_string (uint64_t {128} << bucket) + "ns";
+	}
+	csv += "\n";
+	for (const auto& e : snapshot)
+	{
+		csv += std::to_string (e.message) + "," + std::to_string (e.count) + "," +
+		       std::to_string (e.totalNanoseconds) + "," +
+		       std::to_string (e.count ? e.totalNanoseconds / e.count : 0) + "," +
+		       std::to_string (e.maxNanoseconds);
+		for (auto value : e.histogram)
+			csv += "," + std::to_string (value);
+		csv += "\n";
+	}
+	return csv;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
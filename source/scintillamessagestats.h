@@ -0,0 +1,80 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef SCINTILLA_MESSAGE_STATS
+#define SCINTILLA_MESSAGE_STATS 0
+#endif
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Call counts and latency histograms of the messages sent via ScintillaEditorView::sendMessage.
+ *
+ *	Messages are only recorded if the project is configured with the cmake option
+ *	SCINTILLA_MESSAGE_STATS, otherwise all snapshots are empty.
+ */
+class ScintillaMessageStats
+{
+public:
+	/** bucket i counts calls faster than 128ns << i, the last bucket counts all slower calls */
+	static constexpr size_t NumBuckets = 16;
+
+	struct Entry
+	{
+		uint32_t message {0};
+		uint64_t count {0};
+		uint64_t totalNanoseconds {0};
+		uint64_t maxNanoseconds {0};
+		std::array<uint64_t, NumBuckets> histogram {};
+	};
+	using Snapshot = std::vector<Entry>;
+
+	static constexpr bool enabled () { return SCINTILLA_MESSAGE_STATS != 0; }
+
+	static void record (uint32_t message, uint64_t nanoseconds);
+	/** all messages which were sent at least once, sorted by message */
+	static Snapshot snapshot ();
+	static void reset ();
+	/** one line per message with count, total, mean, max and the histogram buckets */
+	static std::string toCSV (const Snapshot& snapshot);
+
+	/** records the time from construction to destruction */
+	struct Scope
+	{
+		explicit Scope (uint32_t message)
+		: message (message), start (std::chrono::steady_clock::now ())
+		{
+		}
+		~Scope () noexcept
+		{
+			auto duration = std::chrono::steady_clock::now () - start;
+			record (message, static_cast<uint64_t> (
+			                     std::chrono::duration_cast<std::chrono::nanoseconds> (duration)
+			                         .count ()));
+		}
+
+		uint32_t message;
+		std::chrono::steady_clock::time_point start;
+	};
+};
+
+#if SCINTILLA_MESSAGE_STATS
+#define SCINTILLA_RECORD_MESSAGE(message) \
+	ScintillaMessageStats::Scope scintillaMessageStatsScope (message)
+#else
+#define SCINTILLA_RECORD_MESSAGE(message)
+#endif
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,521 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillaminimapview.h"
+#include "vstgui/lib/cbitmap.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/cframe.h"
+#include "vstgui/lib/coffscreencontext.h"
+#include "vstgui/uidescription/detail/uiviewcreatorattributes.h"
+#include "vstgui/uidescription/iviewcreator.h"
+#include "vstgui/uidescription/uiattributes.h"
+#include "vstgui/uidescription/uiviewcreator.h"
+#include "vstgui/uidescription/uiviewfactory.h"
+
+#include "Scintilla.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+/** the part of a long line which is summarized, a minimap is never wider */
+constexpr intptr_t MaxSummaryBytes = 1024;
+constexpr int64_t NoDirtyLine = std::numeric_limits<int64_t>::max ();
+
+//------------------------------------------------------------------------
+uint16_t clampColumns (uint32_t columns)
+{
+	constexpr uint32_t maxColumns = std::numeric_limits<uint16_t>::max ();
+	return static_cast<uint16_t> (std::min (columns, maxColumns));
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+ScintillaMinimapView::ScintillaMinimapView (const CRect& size) : CView (size) {}
+
+//------------------------------------------------------------------------
+ScintillaMinimapView::~ScintillaMinimapView () noexcept = default;
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::setEditor (ScintillaEditorView* inEditor)
+{
+	if (editor == inEditor)
+		return;
+	if (editor)
+	{
+		editor->unregisterListener (this);
+		editor->unregisterViewListener (this);
+	}
+	editor = inEditor;
+	if (editor)
+	{
+		// styling progress arrives as style changes of the lexed ranges
+		constexpr uint32_t modificationFlags =
+		    SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_CHANGESTYLE;
+		editor->registerListener (this, {{SCN_MODIFIED, SCN_UPDATEUI}, modificationFlags});
+		editor->registerViewListener (this);
+	}
+	resetSummaries ();
+	invalid ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::setLineHeight (CCoord height)
+{
+	lineHeight = std::max (height, 1.);
+	bitmapTopLine = -1;
+	invalid ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::setVisibleAreaColor (const CColor& color)
+{
+	visibleAreaColor = color;
+	invalid ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::resetSummaries ()
+{
+	document = editor ? editor->getDocument () : nullptr;
+	summaries.assign (editor ? static_cast<size_t> (editor->sendMessage (SCI_GETLINECOUNT)) : 0,
+	                  {});
+	bitmapTopLine = -1;
+	dirtyFirst = NoDirtyLine;
+	dirtyLast = -1;
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::syncDocument ()
+{
+	// scintilla does not notify about a document which is shown instead
+	if (editor && editor->getDocument () != document)
+		resetSummaries ();
+}
+
+//------------------------------------------------------------------------
+auto ScintillaMinimapView::getLineSummary (int64_t line) -> LineSummary
+{
+	syncDocument ();
+	if (line < 0 || line >= static_cast<int64_t> (summaries.size ()))
+		return {};
+	return summaryOf (line);
+}
+
+//------------------------------------------------------------------------
+auto ScintillaMinimapView::summaryOf (int64_t line) -> const LineSummary&
+{
+	auto& summary = summaries[static_cast<size_t> (line)];
+	if (!summary.valid)
+		computeSummary (line, summary);
+	return summary.line;
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::computeSummary (int64_t line, Summary& summary)
+{
+	auto start = editor->sendMessage (SCI_POSITIONFROMLINE, line);
+	auto end = editor->sendMessage (SCI_GETLINEENDPOSITION, line);
+	auto length = std::min (end - start, MaxSummaryBytes);
+	styledText.resize (static_cast<size_t> (length) * 2 + 2);
+	Sci_TextRange range;
+	range.chrg.cpMin = static_cast<Sci_PositionCR> (start);
+	range.chrg.cpMax = static_cast<Sci_PositionCR> (start + length);
+	range.lpstrText = styledText.data ();
+	editor->sendMessage (SCI_GETSTYLEDTEXT, 0, &range);
+
+	auto tabWidth = std::max<uint32_t> (editor->getTabWidth (), 1);
+	std::array<uint32_t, 256> styleCounts {};
+	uint32_t column = 0;
+	uint32_t indent = 0;
+	bool leading = true;
+	for (intptr_t index = 0; index < length; ++index)
+	{
+		auto c = static_cast<uint8_t> (styledText[index * 2]);
+		// only the first byte of a character is a column
+		if ((c & 0xC0) == 0x80)
+			continue;
+		if (c == '\t')
+			column = (column / tabWidth + 1) * tabWidth;
+		else
+		{
+			if (c != ' ')
+			{
+				leading = false;
+				++styleCounts[static_cast<uint8_t> (styledText[index * 2 + 1])];
+			}
+			++column;
+		}
+		if (leading)
+			indent = column;
+	}
+	column += static_cast<uint32_t> (end - start - length);
+
+	auto dominant = std::max_element (styleCounts.begin (), styleCounts.end ());
+	summary.line.style = static_cast<uint8_t> (std::distance (styleCounts.begin (), dominant));
+	summary.line.indent = clampColumns (indent);
+	summary.line.length = clampColumns (column);
+	summary.valid = true;
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::onScintillaNotification (SCNotification* notification)
+{
+	switch (notification->nmhdr.code)
+	{
+		case SCN_MODIFIED:
+		{
+			if (editor->getDocument () != document)
+			{
+				resetSummaries ();
+				invalid ();
+				break;
+			}
+			auto line = static_cast<int64_t> (
+			    editor->sendMessage (SCI_LINEFROMPOSITION, notification->position));
+			if (notification->modificationType & SC_MOD_CHANGESTYLE)
+			{
+				auto last = static_cast<int64_t> (editor->sendMessage (
+				    SCI_LINEFROMPOSITION, notification->position + notification->length));
+				invalidateLines (line, last);
+				break;
+			}
+			auto linesAdded = static_cast<int64_t> (notification->linesAdded);
+			auto numLines = static_cast<int64_t> (summaries.size ());
+			if (line >= numLines || (linesAdded < 0 && line + 1 - linesAdded > numLines))
+			{
+				resetSummaries ();
+				invalid ();
+				break;
+			}
+			// the summaries of the lines below move with their lines
+			auto next = summaries.begin () + line + 1;
+			if (linesAdded > 0)
+				summaries.insert (next, static_cast<size_t> (linesAdded), Summary {});
+			else if (linesAdded < 0)
+				summaries.erase (next, next - linesAdded);
+			invalidateLines (line, line + std::max<int64_t> (linesAdded, 0));
+			// but their bars are drawn at other rows
+			if (linesAdded != 0)
+				markDirty (line, NoDirtyLine);
+			break;
+		}
+		case SCN_UPDATEUI:
+		{
+			if (notification->updated & SC_UPDATE_V_SCROLL)
+				invalid ();
+			break;
+		}
+		default: break;
+	}
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::invalidateLines (int64_t first, int64_t last)
+{
+	last = std::min (last, static_cast<int64_t> (summaries.size ()) - 1);
+	for (auto line = std::max<int64_t> (first, 0); line <= last; ++line)
+		summaries[static_cast<size_t> (line)].valid = false;
+	markDirty (first, last);
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::markDirty (int64_t first, int64_t last)
+{
+	if (last < first)
+		return;
+	dirtyFirst = std::min (dirtyFirst, first);
+	dirtyLast = std::max (dirtyLast, last);
+	if (bitmapTopLine < 0)
+	{
+		invalid ();
+		return;
+	}
+	// only the rows of the lines are drawn again
+	const auto& viewSize = getViewSize ();
+	auto rows = static_cast<int64_t> (std::ceil (viewSize.getHeight () / lineHeight));
+	first = std::max (first, bitmapTopLine);
+	last = std::min (last, bitmapTopLine + rows - 1);
+	if (last < first)
+		return;
+	CRect band (viewSize.left, viewSize.top + (first - bitmapTopLine) * lineHeight,
+	            viewSize.right, viewSize.top + (last - bitmapTopLine + 1) * lineHeight);
+	band.bound (viewSize);
+	invalidRect (band);
+}
+
+//------------------------------------------------------------------------
+int64_t ScintillaMinimapView::getTopLine () const
+{
+	auto numLines = static_cast<int64_t> (summaries.size ());
+	auto rows = static_cast<int64_t> (getViewSize ().getHeight () / lineHeight);
+	if (!editor || numLines <= rows)
+		return 0;
+	// the overview scrolls proportionally, its last row is reached with the last page
+	auto firstVisible = static_cast<int64_t> (editor->sendMessage (
+	    SCI_DOCLINEFROMVISIBLE, editor->sendMessage (SCI_GETFIRSTVISIBLELINE)));
+	auto linesOnScreen = static_cast<int64_t> (editor->sendMessage (SCI_LINESONSCREEN));
+	auto scrollRange = std::max<int64_t> (numLines - linesOnScreen, 1);
+	return std::clamp<int64_t> (firstVisible * (numLines - rows) / scrollRange, 0,
+	                            numLines - rows);
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::renderLines (int64_t first, int64_t last)
+{
+	if (last < first)
+		return;
+	auto width = bitmap->getWidth ();
+	auto height = bitmap->getHeight ();
+	CRect band (0, (first - bitmapTopLine) * lineHeight, width,
+	            (last - bitmapTopLine + 1) * lineHeight);
+	band.bound (CRect (0, 0, width, height));
+
+	bitmap->beginDraw ();
+	bitmap->setDrawMode (kAliasing);
+	bitmap->setFillColor (editor->getBackgroundColor ());
+	bitmap->drawRect (band, kDrawFilled);
+
+	// the colors are looked up once per style and band
+	std::array<CColor, 256> colors;
+	std::array<bool, 256> knownColors {};
+	auto columnWidth = lineHeight / 2.;
+	auto barHeight = lineHeight > 1. ? lineHeight - 1. : lineHeight;
+	last = std::min (last, static_cast<int64_t> (summaries.size ()) - 1);
+	for (auto line = first; line <= last; ++line)
+	{
+		const auto& summary = summaryOf (line);
+		if (summary.length <= summary.indent)
+			continue;
+		if (!knownColors[summary.style])
+		{
+			colors[summary.style] =
+			    fromScintillaColor (editor->sendMessage (SCI_STYLEGETFORE, summary.style));
+			colors[summary.style].alpha = 160;
+			knownColors[summary.style] = true;
+		}
+		auto top = (line - bitmapTopLine) * lineHeight;
+		CRect bar (summary.indent * columnWidth, top, summary.length * columnWidth,
+		           top + barHeight);
+		bar.bound (band);
+		if (bar.isEmpty ())
+			continue;
+		bitmap->setFillColor (colors[summary.style]);
+		bitmap->drawRect (bar, kDrawFilled);
+	}
+	bitmap->endDraw ();
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::draw (CDrawContext* context)
+{
+	const auto& viewSize = getViewSize ();
+	if (!editor)
+	{
+		setDirty (false);
+		return;
+	}
+	syncDocument ();
+	auto scaleFactor = getFrame () ? getFrame ()->getScaleFactor () : 1.;
+	if (!bitmap || bitmap->getWidth () != viewSize.getWidth () ||
+	    bitmap->getHeight () != viewSize.getHeight () || bitmap->getScaleFactor () != scaleFactor)
+	{
+		bitmap = COffscreenContext::create (viewSize.getSize (), scaleFactor);
+		bitmapTopLine = -1;
+	}
+	if (!bitmap)
+	{
+		setDirty (false);
+		return;
+	}
+
+	auto topLine = getTopLine ();
+	auto rows = static_cast<int64_t> (std::ceil (viewSize.getHeight () / lineHeight));
+	const auto& theme = editor->getTheme ();
+	if (topLine != bitmapTopLine || theme != bitmapTheme)
+	{
+		// scrolling draws all rows, which are only as many lines as fit into the view
+		bitmapTopLine = topLine;
+		bitmapTheme = theme;
+		renderLines (topLine, topLine + rows - 1);
+	}
+	else if (dirtyFirst <= dirtyLast)
+	{
+		renderLines (std::max (dirtyFirst, topLine), std::min (dirtyLast, topLine + rows - 1));
+	}
+	dirtyFirst = NoDirtyLine;
+	dirtyLast = -1;
+	if (auto image = bitmap->getBitmap ())
+		image->draw (context, viewSize);
+
+	auto firstVisible = static_cast<int64_t> (editor->sendMessage (
+	    SCI_DOCLINEFROMVISIBLE, editor->sendMessage (SCI_GETFIRSTVISIBLELINE)));
+	auto linesOnScreen = static_cast<int64_t> (editor->sendMessage (SCI_LINESONSCREEN));
+	CRect visibleArea (viewSize.left, viewSize.top + (firstVisible - topLine) * lineHeight,
+	                   viewSize.right,
+	                   viewSize.top + (firstVisible - topLine + linesOnScreen) * lineHeight);
+	visibleArea.bound (viewSize);
+	if (!visibleArea.isEmpty ())
+	{
+		context->setFillColor (visibleAreaColor);
+		context->drawRect (visibleArea, kDrawFilled);
+	}
+	setDirty (false);
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::scrollEditorTo (const CPoint& where)
+{
+	auto numLines = static_cast<int64_t> (summaries.size ());
+	if (numLines == 0)
+		return;
+	auto row = static_cast<int64_t> ((where.y - getViewSize ().top) / lineHeight);
+	auto line = std::clamp<int64_t> (getTopLine () + row, 0, numLines - 1);
+	auto visibleLine = editor->sendMessage (SCI_VISIBLEFROMDOCLINE, line);
+	auto linesOnScreen = editor->sendMessage (SCI_LINESONSCREEN);
+	editor->sendMessage (SCI_SETFIRSTVISIBLELINE,
+	                     std::max<intptr_t> (visibleLine - linesOnScreen / 2, 0));
+	invalid ();
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaMinimapView::onMouseDown (CPoint& where, const CButtonState& buttons)
+{
+	if (!editor || !buttons.isLeftButton ())
+		return kMouseEventNotHandled;
+	dragging = true;
+	scrollEditorTo (where);
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaMinimapView::onMouseMoved (CPoint& where, const CButtonState& buttons)
+{
+	if (!dragging)
+		return kMouseEventNotHandled;
+	if (editor && buttons.isLeftButton ())
+		scrollEditorTo (where);
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult ScintillaMinimapView::onMouseUp (CPoint& where, const CButtonState& buttons)
+{
+	if (!dragging)
+		return kMouseEventNotHandled;
+	dragging = false;
+	return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::setViewSize (const CRect& rect, bool invalid)
+{
+	CView::setViewSize (rect, invalid);
+	bitmap = nullptr;
+}
+
+//------------------------------------------------------------------------
+bool ScintillaMinimapView::removed (CView* parent)
+{
+	bitmap = nullptr;
+	return CView::removed (parent);
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::viewWillDelete (CView* view)
+{
+	if (view == editor)
+		setEditor (nullptr);
+}
+
+//------------------------------------------------------------------------
+void ScintillaMinimapView::beforeDelete ()
+{
+	setEditor (nullptr);
+	CView::beforeDelete ();
+}
+
+//------------------------------------------------------------------------
+//------------------------------------------------------------------------
+//------------------------------------------------------------------------
+using UIViewCreator::stringToColor;
+using UIViewCreator::colorToString;
+
+static const std::string kAttrMinimapLineHeight = "minimap-line-height";
+static const std::string kAttrVisibleAreaColor = "visible-area-color";
+
+//-----------------------------------------------------------------------------
+class ScintillaMinimapViewCreator : public ViewCreatorAdapter
+{
+public:
+	ScintillaMinimapViewCreator () { UIViewFactory::registerViewCreator (*this); }
+	IdStringPtr getViewName () const override { return "ScintillaMinimapView"; }
+	IdStringPtr getBaseViewName () const override { return UIViewCreator::kCView; }
+	UTF8StringPtr getDisplayName () const override { return "Scintilla Minimap View"; }
+	CView* create (const UIAttributes& attributes, const IUIDescription* description) const override
+	{
+		return new ScintillaMinimapView (CRect (0, 0, 0, 0));
+	}
+	bool getAttributeNames (std::list<std::string>& attributeNames) const override
+	{
+		attributeNames.push_back (kAttrMinimapLineHeight);
+		attributeNames.push_back (kAttrVisibleAreaColor);
+		return true;
+	}
+	AttrType getAttributeType (const std::string& attributeName) const override
+	{
+		if (attributeName == kAttrMinimapLineHeight)
+			return kFloatType;
+		if (attributeName == kAttrVisibleAreaColor)
+			return kColorType;
+		return kUnknownType;
+	}
+	bool apply (CView* view, const UIAttributes& attr, const IUIDescription* desc) const override
+	{
+		auto minimap = dynamic_cast<ScintillaMinimapView*> (view);
+		if (!minimap)
+			return false;
+		double d;
+		if (attr.getDoubleAttribute (kAttrMinimapLineHeight, d))
+		{
+			minimap->setLineHeight (d);
+		}
+		CColor color;
+		if (stringToColor (attr.getAttributeValue (kAttrVisibleAreaColor), color, desc))
+		{
+			minimap->setVisibleAreaColor (color);
+		}
+		return true;
+	}
+	bool getAttributeValue (CView* view, const std::string& attName, std::string& stringValue,
+	                        const IUIDescription* desc) const override
+	{
+		auto minimap = dynamic_cast<ScintillaMinimapView*> (view);
+		if (!minimap)
+			return false;
+		if (attName == kAttrMinimapLineHeight)
+		{
+			stringValue = UIAttributes::doubleToString (minimap->getLineHeight ());
+			return true;
+		}
+		if (attName == kAttrVisibleAreaColor)
+		{
+			return colorToString (minimap->getVisibleAreaColor (), stringValue, desc);
+		}
+		return false;
+	}
+};
+ScintillaMinimapViewCreator __gScintillaMinimapViewCreator;
+
+//------------------------------------------------------------------------
+} // VSTGUI
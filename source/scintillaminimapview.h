@@ -0,0 +1,108 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+#include "vstgui/lib/iviewlistener.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+class COffscreenContext;
+
+//------------------------------------------------------------------------
+/** A scaled overview of the document of a ScintillaEditorView, usually shown next to it.
+ *
+ *	Every line is drawn as a bar from its indentation to its end in the color of the style which
+ *	covers most of it. The summaries of the lines are cached and only the lines which were edited
+ *	or styled again are summarized anew, when they become visible. The bars are kept in a bitmap
+ *	in which only the bands of changed lines are drawn again.
+ *
+ *	When the document does not fit, the overview scrolls proportionally with the editor. Clicking
+ *	or dragging scrolls the editor so that the line below the mouse is in the middle.
+ */
+class ScintillaMinimapView : public CView, public IScintillaListener, public ViewListenerAdapter
+{
+public:
+	struct LineSummary
+	{
+		/** the style which covers most of the line, whitespace is not counted */
+		uint8_t style {0};
+		/** columns of the leading whitespace, tabs are expanded */
+		uint16_t indent {0};
+		/** columns of the line without the line end */
+		uint16_t length {0};
+	};
+
+	explicit ScintillaMinimapView (const CRect& size);
+	~ScintillaMinimapView () noexcept override;
+
+	/** show the overview of an editor, nullptr to show nothing */
+	void setEditor (ScintillaEditorView* editor);
+	[[nodiscard]] ScintillaEditorView* getEditor () const { return editor; }
+
+	/** the height of one line in pixels */
+	void setLineHeight (CCoord height);
+	[[nodiscard]] CCoord getLineHeight () const { return lineHeight; }
+	/** the color of the part of the document which is visible in the editor */
+	void setVisibleAreaColor (const CColor& color);
+	[[nodiscard]] CColor getVisibleAreaColor () const { return visibleAreaColor; }
+
+	/** the summary of a line of the document, it is computed if the line changed */
+	[[nodiscard]] LineSummary getLineSummary (int64_t line);
+
+	void draw (CDrawContext* context) override;
+	void setViewSize (const CRect& rect, bool invalid = true) override;
+	bool removed (CView* parent) override;
+	CMouseEventResult onMouseDown (CPoint& where, const CButtonState& buttons) override;
+	CMouseEventResult onMouseMoved (CPoint& where, const CButtonState& buttons) override;
+	CMouseEventResult onMouseUp (CPoint& where, const CButtonState& buttons) override;
+	void beforeDelete () override;
+
+private:
+	struct Summary
+	{
+		LineSummary line;
+		bool valid {false};
+	};
+
+	void onScintillaNotification (SCNotification* notification) override;
+	void viewWillDelete (CView* view) override;
+
+	void resetSummaries ();
+	void syncDocument ();
+	void invalidateLines (int64_t first, int64_t last);
+	void markDirty (int64_t first, int64_t last);
+	const LineSummary& summaryOf (int64_t line);
+	void computeSummary (int64_t line, Summary& summary);
+	[[nodiscard]] int64_t getTopLine () const;
+	void renderLines (int64_t first, int64_t last);
+	void scrollEditorTo (const CPoint& where);
+
+	ScintillaEditorView* editor {nullptr};
+	void* document {nullptr};
+	std::vector<Summary> summaries;
+	/** the buffer of SCI_GETSTYLEDTEXT, text and styles interleaved */
+	std::vector<char> styledText;
+
+	SharedPointer<COffscreenContext> bitmap;
+	/** the first line of the document drawn into the bitmap */
+	int64_t bitmapTopLine {-1};
+	/** the lines which need to be drawn into the bitmap again */
+	int64_t dirtyFirst {std::numeric_limits<int64_t>::max ()};
+	int64_t dirtyLast {-1};
+	std::shared_ptr<const ScintillaTheme> bitmapTheme;
+
+	CCoord lineHeight {2.};
+	CColor visibleAreaColor {255, 255, 255, 40};
+	bool dragging {false};
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
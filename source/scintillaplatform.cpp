@@ -0,0 +1,284 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillaplatform.h"
+
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Scintilla::Internal {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+inline IWindowHost* windowHost (WindowID wid)
+{
+	return static_cast<IWindowHost*> (wid);
+}
+
+//------------------------------------------------------------------------
+/** the autocompletion list is not displayed by these backends, it only keeps the list items */
+class ListBoxModel final : public ListBox
+{
+public:
+	void SetFont (const Font* font) override {}
+	void Create (Window& parent, int ctrlID, Point location, int lineHeight, bool unicodeMode,
+	             Technology technology) override
+	{
+	}
+	void SetAverageCharWidth (int width) override {}
+	void SetVisibleRows (int rows) override { visibleRows = rows; }
+	int GetVisibleRows () const override { return visibleRows; }
+	PRectangle GetDesiredRect () override { return {}; }
+	int CaretFromEdge () override { return 0; }
+	void Clear () noexcept override { items.clear (); }
+	void Append (char* s, int type) override { items.emplace_back (s); }
+	int Length () override { return static_cast<int> (items.size ()); }
+	void Select (int n) override { selection = n; }
+	int GetSelection () override { return selection; }
+	int Find (const char* prefix) override
+	{
+		std::string_view p (prefix);
+		for (auto i = 0u; i < items.size (); ++i)
+		{
+			if (items[i].compare (0, p.size (), p) == 0)
+				return static_cast<int> (i);
+		}
+		return -1;
+	}
+	std::string GetValue (int n) override
+	{
+		if (n < 0 || n >= Length ())
+			return {};
+		return items[static_cast<size_t> (n)];
+	}
+	void RegisterImage (int type, const char* xpm_data) override {}
+	void RegisterRGBAImage (int type, int width, int height,
+	                        const unsigned char* pixelsImage) override
+	{
+	}
+	void ClearRegisteredImages () override {}
+	void SetDelegate (IListBoxDelegate* lbDelegate) override {}
+	void SetList (const char* list, char separator, char typesep) override
+	{
+		Clear ();
+		std::string_view str (list);
+		while (!str.empty ())
+		{
+			auto end = str.find (separator);
+			auto item = str.substr (0, end);
+			item = item.substr (0, item.find (typesep));
+			items.emplace_back (item);
+			if (end == std::string_view::npos)
+				break;
+			str.remove_prefix (end + 1);
+		}
+	}
+	void SetOptions (ListOptions options) override {}
+
+private:
+	std::vector<std::string> items;
+	int visibleRows {5};
+	int selection {-1};
+};
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+ScintillaEditorBase::ScintillaEditorBase (NotifyFunc&& notify) : notifyFunc (std::move (notify))
+{
+	// VSTGUI already draws into a back buffer
+	WndProc (Message::SetBufferedDraw, 0, 0);
+	WndProc (Message::UsePopUp, static_cast<uptr_t> (PopUp::Never), 0);
+	WndProc (Message::SetCodePage, SC_CP_UTF8, 0);
+	// set the window after the messages above, as the derived host is not yet constructed
+	wMain = static_cast<IWindowHost*> (this);
+}
+
+//------------------------------------------------------------------------
+ScintillaEditorBase::~ScintillaEditorBase () noexcept
+{
+	wMain = nullptr;
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaEditorBase::UTF8FromEncoded (std::string_view encoded) const
+{
+	return std::string (encoded);
+}
+
+//------------------------------------------------------------------------
+std::string ScintillaEditorBase::EncodedFromUTF8 (std::string_view utf8) const
+{
+	return std::string (utf8);
+}
+
+//------------------------------------------------------------------------
+void ScintillaEditorBase::NotifyParent (NotificationData scn)
+{
+	scn.nmhdr.hwndFrom = wMain.GetID ();
+	scn.nmhdr.idFrom = GetCtrlID ();
+	if (notifyFunc)
+		notifyFunc (reinterpret_cast<SCNotification*> (&scn));
+}
+
+//------------------------------------------------------------------------
+Window::~Window () noexcept {}
+
+//------------------------------------------------------------------------
+void Window::Destroy () noexcept
+{
+	wid = nullptr;
+}
+
+//------------------------------------------------------------------------
+PRectangle Window::GetPosition () const
+{
+	if (auto host = windowHost (wid))
+		return host->getPosition ();
+	return {};
+}
+
+//------------------------------------------------------------------------
+void Window::SetPosition (PRectangle rc) {}
+
+//------------------------------------------------------------------------
+void Window::SetPositionRelative (PRectangle rc, const Window* relativeTo) {}
+
+//------------------------------------------------------------------------
+PRectangle Window::GetClientPosition () const
+{
+	return GetPosition ();
+}
+
+//------------------------------------------------------------------------
+void Window::Show (bool show) {}
+
+//------------------------------------------------------------------------
+void Window::InvalidateAll ()
+{
+	if (auto host = windowHost (wid))
+		host->invalidateAll ();
+}
+
+//------------------------------------------------------------------------
+void Window::InvalidateRectangle (PRectangle rc)
+{
+	if (auto host = windowHost (wid))
+		host->invalidate (rc);
+}
+
+//------------------------------------------------------------------------
+void Window::SetCursor (Cursor curs)
+{
+	if (curs == cursorLast)
+		return;
+	cursorLast = curs;
+	if (auto host = windowHost (wid))
+		host->setCursor (curs);
+}
+
+//------------------------------------------------------------------------
+PRectangle Window::GetMonitorRect (Point pt)
+{
+	return PRectangle (0., 0., 100000., 100000.);
+}
+
+//------------------------------------------------------------------------
+ListBox::ListBox () noexcept {}
+
+//------------------------------------------------------------------------
+ListBox::~ListBox () noexcept {}
+
+//------------------------------------------------------------------------
+std::unique_ptr<ListBox> ListBox::Allocate ()
+{
+	return std::make_unique<ListBoxModel> ();
+}
+
+//------------------------------------------------------------------------
+Menu::Menu () noexcept : mid (nullptr) {}
+
+//------------------------------------------------------------------------
+void Menu::CreatePopUp () {}
+
+//------------------------------------------------------------------------
+void Menu::Destroy () noexcept
+{
+	mid = nullptr;
+}
+
+//------------------------------------------------------------------------
+void Menu::Show (Point pt, const Window& w) {}
+
+//------------------------------------------------------------------------
+ColourRGBA Platform::Chrome ()
+{
+	return ColourRGBA (0xe0, 0xe0, 0xe0);
+}
+
+//------------------------------------------------------------------------
+ColourRGBA Platform::ChromeHighlight ()
+{
+	return ColourRGBA (0xff, 0xff, 0xff);
+}
+
+//------------------------------------------------------------------------
+const char* Platform::DefaultFont ()
+{
+	return "Monospace";
+}
+
+//------------------------------------------------------------------------
+int Platform::DefaultFontSize ()
+{
+	return 10;
+}
+
+//------------------------------------------------------------------------
+unsigned int Platform::DoubleClickTime ()
+{
+	return 500;
+}
+
+//------------------------------------------------------------------------
+void Platform::DebugDisplay (const char* s) noexcept
+{
+	fprintf (stderr, "%s", s);
+}
+
+//------------------------------------------------------------------------
+void Platform::DebugPrintf (const char* format, ...) noexcept
+{
+#ifdef TRACE
+	char buffer[2000];
+	va_list pArguments;
+	va_start (pArguments, format);
+	vsnprintf (buffer, std::size (buffer), format, pArguments);
+	va_end (pArguments);
+	Platform::DebugDisplay (buffer);
+#endif
+}
+
+//------------------------------------------------------------------------
+bool Platform::ShowAssertionPopUps (bool) noexcept
+{
+	return false;
+}
+
+//------------------------------------------------------------------------
+void Platform::Assert (const char* c, const char* file, int line) noexcept
+{
+	fprintf (stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+	assert (false);
+}
+
+//------------------------------------------------------------------------
+} // Scintilla::Internal
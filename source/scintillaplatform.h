@@ -0,0 +1,106 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+#include "Scintilla.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "CallTip.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "CaseConvert.h"
+#include "UniConversion.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+#include "AutoComplete.h"
+#include "ScintillaBase.h"
+
+//------------------------------------------------------------------------
+namespace Scintilla::Internal {
+
+//------------------------------------------------------------------------
+/** the part of a window scintilla needs to know about, the WindowID of a Window points to it */
+class IWindowHost
+{
+public:
+	virtual PRectangle getPosition () const = 0;
+	virtual void invalidate (PRectangle rc) = 0;
+	virtual void invalidateAll () = 0;
+	virtual void setCursor (Window::Cursor cursor) = 0;
+
+	virtual ~IWindowHost () noexcept = default;
+};
+
+//------------------------------------------------------------------------
+/** Common base for the backends which run the scintilla editor in process instead of hosting a
+ *	native scintilla view (Linux and headless).
+ */
+class ScintillaEditorBase : public ScintillaBase, public IWindowHost
+{
+public:
+	using NotifyFunc = std::function<void (SCNotification*)>;
+
+	sptr_t send (unsigned int message, uptr_t wParam, sptr_t lParam)
+	{
+		return WndProc (static_cast<Message> (message), wParam, lParam);
+	}
+
+	void resized () { ChangeSize (); }
+
+protected:
+	explicit ScintillaEditorBase (NotifyFunc&& notify);
+	~ScintillaEditorBase () noexcept override;
+
+	void Initialise () override {}
+	void SetVerticalScrollPos () override {}
+	void SetHorizontalScrollPos () override {}
+	bool ModifyScrollBars (Sci::Line nMax, Sci::Line nPage) override { return false; }
+	void ClaimSelection () override {}
+	void NotifyChange () override {}
+	void SetMouseCapture (bool on) override { mouseCapture = on; }
+	bool HaveMouseCapture () override { return mouseCapture; }
+	void CreateCallTipWindow (PRectangle rc) override {}
+	void AddToPopUp (const char* label, int cmd, bool enabled) override {}
+	sptr_t DefWndProc (Message iMessage, uptr_t wParam, sptr_t lParam) override { return 0; }
+	std::string UTF8FromEncoded (std::string_view encoded) const override;
+	std::string EncodedFromUTF8 (std::string_view utf8) const override;
+	void NotifyParent (NotificationData scn) override;
+
+private:
+	NotifyFunc notifyFunc;
+	bool mouseCapture {false};
+};
+
+//------------------------------------------------------------------------
+} // Scintilla::Internal
@@ -0,0 +1,106 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillatheme.h"
+
+#include "ScintillaTypes.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setFont (const SharedPointer<CFontDesc>& inFont)
+{
+	font = inFont;
+	if (!font)
+		return;
+	defaultStyle.fontName = font->getName ().getString ();
+	defaultStyle.fontSize = static_cast<int32_t> (
+	    font->getSize () * static_cast<CCoord> (Scintilla::FontSizeMultiplier));
+	defaultStyle.weight = (font->getStyle () & kBoldFace) ? 700 : 400;
+	defaultStyle.italic = (font->getStyle () & kItalicFace) != 0;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setStyleForeground (uint32_t index, const CColor& color)
+{
+	styles[index].foreground = color;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setStyleBackground (uint32_t index, const CColor& color)
+{
+	styles[index].background = color;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setStyleWeight (uint32_t index, uint32_t weight)
+{
+	styles[index].weight = weight;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setStyleItalic (uint32_t index, bool state)
+{
+	styles[index].italic = state;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::setStyle (uint32_t index, const Style& style)
+{
+	styles[index] = style;
+}
+
+//------------------------------------------------------------------------
+void ScintillaTheme::resetStyle (uint32_t index)
+{
+	styles.erase (index);
+}
+
+//------------------------------------------------------------------------
+auto ScintillaTheme::resolve (uint32_t index) const -> ResolvedStyle
+{
+	ResolvedStyle result {defaultStyle.foreground, defaultStyle.background, defaultStyle.weight,
+	                      defaultStyle.italic};
+	auto it = styles.find (index);
+	if (it == styles.end ())
+		return result;
+	const auto& style = it->second;
+	if (style.foreground)
+		result.foreground = *style.foreground;
+	if (style.background)
+		result.background = *style.background;
+	if (style.weight)
+		result.weight = *style.weight;
+	if (style.italic)
+		result.italic = *style.italic;
+	return result;
+}
+
+//------------------------------------------------------------------------
+std::shared_ptr<const ScintillaTheme> ScintillaTheme::intern (const ScintillaTheme& theme)
+{
+	static std::mutex mutex;
+	static std::vector<std::weak_ptr<const ScintillaTheme>> themes;
+
+	std::lock_guard<std::mutex> guard (mutex);
+	themes.erase (std::remove_if (themes.begin (), themes.end (),
+	                              [] (const auto& weak) { return weak.expired (); }),
+	              themes.end ());
+	for (const auto& weak : themes)
+	{
+		if (auto shared = weak.lock (); shared && *shared == theme)
+			return shared;
+	}
+	auto shared = std::make_shared<const ScintillaTheme> (theme);
+	themes.emplace_back (shared);
+	return shared;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,109 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "vstgui/lib/ccolor.h"
+#include "vstgui/lib/cfont.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** The font and colors of all styles of a ScintillaEditorView.
+ *
+ *	A theme is a value. Once it is set on a view it is shared as std::shared_ptr<const
+ *	ScintillaTheme> and never changed, use intern () to share equal themes between views.
+ *	A view only sends the styles to scintilla which differ from its previous theme.
+ */
+class ScintillaTheme
+{
+public:
+	/** attributes of the default style, all other styles start with these */
+	struct DefaultStyle
+	{
+		std::string fontName;
+		/** font size multiplied by Scintilla::FontSizeMultiplier */
+		int32_t fontSize {1000};
+		uint32_t weight {400};
+		bool italic {false};
+		CColor foreground {kBlackCColor};
+		CColor background {kWhiteCColor};
+
+		bool operator== (const DefaultStyle& o) const
+		{
+			return fontName == o.fontName && fontSize == o.fontSize && weight == o.weight &&
+			       italic == o.italic && foreground == o.foreground && background == o.background;
+		}
+		bool operator!= (const DefaultStyle& o) const { return !(*this == o); }
+	};
+
+	/** the attributes of a style which differ from the default style */
+	struct Style
+	{
+		std::optional<CColor> foreground;
+		std::optional<CColor> background;
+		std::optional<uint32_t> weight;
+		std::optional<bool> italic;
+
+		bool operator== (const Style& o) const
+		{
+			return foreground == o.foreground && background == o.background &&
+			       weight == o.weight && italic == o.italic;
+		}
+		bool operator!= (const Style& o) const { return !(*this == o); }
+	};
+
+	/** a style merged with the default style */
+	struct ResolvedStyle
+	{
+		CColor foreground;
+		CColor background;
+		uint32_t weight;
+		bool italic;
+	};
+
+	using StyleMap = std::map<uint32_t, Style>;
+
+	void setFont (const SharedPointer<CFontDesc>& font);
+	void setForeground (const CColor& color) { defaultStyle.foreground = color; }
+	void setBackground (const CColor& color) { defaultStyle.background = color; }
+	void setDefaultStyle (const DefaultStyle& style) { defaultStyle = style; }
+
+	void setStyleForeground (uint32_t index, const CColor& color);
+	void setStyleBackground (uint32_t index, const CColor& color);
+	void setStyleWeight (uint32_t index, uint32_t weight);
+	void setStyleItalic (uint32_t index, bool state);
+	void setStyle (uint32_t index, const Style& style);
+	void resetStyle (uint32_t index);
+
+	[[nodiscard]] const SharedPointer<CFontDesc>& getFont () const { return font; }
+	[[nodiscard]] const DefaultStyle& getDefaultStyle () const { return defaultStyle; }
+	[[nodiscard]] const StyleMap& getStyles () const { return styles; }
+	[[nodiscard]] ResolvedStyle resolve (uint32_t index) const;
+
+	/** the font description is not compared, only its resolved attributes */
+	bool operator== (const ScintillaTheme& o) const
+	{
+		return defaultStyle == o.defaultStyle && styles == o.styles;
+	}
+	bool operator!= (const ScintillaTheme& o) const { return !(*this == o); }
+
+	/** get a shared theme equal to theme, equal themes are only kept once */
+	static std::shared_ptr<const ScintillaTheme> intern (const ScintillaTheme& theme);
+
+private:
+	SharedPointer<CFontDesc> font;
+	DefaultStyle defaultStyle;
+	StyleMap styles;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,290 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "textsearch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VSTGUI_TEXTSEARCH_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define VSTGUI_TEXTSEARCH_SSE2 0
+#endif
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+inline uint8_t foldASCII (uint8_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t> (c + ('a' - 'A')) : c;
+}
+
+//------------------------------------------------------------------------
+inline uint8_t byteAt (const TextSearch::TextView& text, size_t position)
+{
+	if (position < text.first.size ())
+		return static_cast<uint8_t> (text.first[position]);
+	return static_cast<uint8_t> (text.second[position - text.first.size ()]);
+}
+
+#if VSTGUI_TEXTSEARCH_SSE2
+//------------------------------------------------------------------------
+inline uint32_t countTrailingZeros (uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward (&index, value);
+	return index;
+#else
+	return static_cast<uint32_t> (__builtin_ctz (value));
+#endif
+}
+#endif
+
+//------------------------------------------------------------------------
+/** find the first byte which is a or b */
+const char* findEither (const char* begin, const char* end, char a, char b)
+{
+#if VSTGUI_TEXTSEARCH_SSE2
+	auto va = _mm_set1_epi8 (a);
+	auto vb = _mm_set1_epi8 (b);
+	while (end - begin >= 16)
+	{
+		auto chunk = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (begin));
+		auto equal = _mm_or_si128 (_mm_cmpeq_epi8 (chunk, va), _mm_cmpeq_epi8 (chunk, vb));
+		if (auto mask = static_cast<uint32_t> (_mm_movemask_epi8 (equal)))
+			return begin + countTrailingZeros (mask);
+		begin += 16;
+	}
+#endif
+	for (; begin != end; ++begin)
+	{
+		if (*begin == a || *begin == b)
+			return begin;
+	}
+	return end;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+TextSearch::TextSearch (std::string_view inPattern, uint32_t searchFlags)
+: pattern (inPattern), flags (searchFlags)
+{
+	if (!(flags & ScintillaEditorView::MatchCase))
+	{
+		folded = pattern;
+		for (auto& c : folded)
+			c = static_cast<char> (foldASCII (static_cast<uint8_t> (c)));
+	}
+	for (size_t c = 0; c < charClasses.size (); ++c)
+	{
+		if (c == '\r' || c == '\n')
+			charClasses[c] = CharClass::NewLine;
+		else if (c < 0x20 || c == ' ')
+			charClasses[c] = CharClass::Space;
+		else if (c >= 0x80 || c == '_' || std::isalnum (static_cast<int> (c)))
+			charClasses[c] = CharClass::Word;
+		else
+			charClasses[c] = CharClass::Punctuation;
+	}
+}
+
+//------------------------------------------------------------------------
+void TextSearch::setCharClasses (std::string_view wordChars, std::string_view whitespaceChars,
+                                 std::string_view punctuationChars)
+{
+	charClasses.fill (CharClass::Punctuation);
+	charClasses['\r'] = charClasses['\n'] = CharClass::NewLine;
+	for (auto c : whitespaceChars)
+		charClasses[static_cast<uint8_t> (c)] = CharClass::Space;
+	for (auto c : punctuationChars)
+		charClasses[static_cast<uint8_t> (c)] = CharClass::Punctuation;
+	for (auto c : wordChars)
+		charClasses[static_cast<uint8_t> (c)] = CharClass::Word;
+}
+
+//------------------------------------------------------------------------
+bool TextSearch::isSupported () const
+{
+	if (pattern.empty () || (flags & ScintillaEditorView::RegularExpression))
+		return false;
+	if (flags & ScintillaEditorView::MatchCase)
+		return true;
+	return std::none_of (pattern.begin (), pattern.end (),
+	                     [] (auto c) { return static_cast<uint8_t> (c) >= 0x80; });
+}
+
+//------------------------------------------------------------------------
+bool TextSearch::canOverlap () const
+{
+	std::string_view p ((flags & ScintillaEditorView::MatchCase) ? pattern : folded);
+	for (size_t length = 1; length < p.size (); ++length)
+	{
+		if (p.substr (0, length) == p.substr (p.size () - length))
+			return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------
+const char* TextSearch::findCandidate (const char* begin, const char* end) const
+{
+	if (flags & ScintillaEditorView::MatchCase)
+	{
+		auto result = std::memchr (begin, pattern[0], static_cast<size_t> (end - begin));
+		return result ? static_cast<const char*> (result) : end;
+	}
+	auto lower = folded[0];
+	auto upper = (lower >= 'a' && lower <= 'z') ? static_cast<char> (lower - ('a' - 'A')) : lower;
+	return findEither (begin, end, lower, upper);
+}
+
+//------------------------------------------------------------------------
+bool TextSearch::isWordStartAt (int64_t position, const TextView& text) const
+{
+	// like Document::IsWordStartAt of scintilla. The bytes of UTF-8 characters are word
+	// characters, scintilla looks up their unicode category instead.
+	if (position >= static_cast<int64_t> (text.size ()))
+		return false;
+	if (position <= 0)
+		return true;
+	auto at = charClasses[byteAt (text, static_cast<size_t> (position))];
+	auto before = charClasses[byteAt (text, static_cast<size_t> (position - 1))];
+	return (at == CharClass::Word || at == CharClass::Punctuation) && at != before;
+}
+
+//------------------------------------------------------------------------
+bool TextSearch::isWordEndAt (int64_t position, const TextView& text) const
+{
+	// like Document::IsWordEndAt of scintilla
+	if (position <= 0)
+		return false;
+	if (position >= static_cast<int64_t> (text.size ()))
+		return true;
+	auto at = charClasses[byteAt (text, static_cast<size_t> (position))];
+	auto before = charClasses[byteAt (text, static_cast<size_t> (position - 1))];
+	return (before == CharClass::Word || before == CharClass::Punctuation) && at != before;
+}
+
+//------------------------------------------------------------------------
+bool TextSearch::matchesAt (const TextView& text, int64_t position) const
+{
+	auto length = pattern.size ();
+	auto size = text.size ();
+	if (position < 0 || static_cast<size_t> (position) + length > size)
+		return false;
+	auto pos = static_cast<size_t> (position);
+	auto firstSize = text.first.size ();
+	if (pos + length <= firstSize || pos >= firstSize)
+	{
+		auto data = pos < firstSize ? text.first.data () + pos : text.second.data () + (pos - firstSize);
+		if (flags & ScintillaEditorView::MatchCase)
+		{
+			if (std::memcmp (data, pattern.data (), length) != 0)
+				return false;
+		}
+		else
+		{
+			for (size_t i = 0; i < length; ++i)
+			{
+				if (foldASCII (static_cast<uint8_t> (data[i])) != static_cast<uint8_t> (folded[i]))
+					return false;
+			}
+		}
+	}
+	else
+	{
+		// the match spans the gap
+		const auto& expected = (flags & ScintillaEditorView::MatchCase) ? pattern : folded;
+		for (size_t i = 0; i < length; ++i)
+		{
+			auto c = byteAt (text, pos + i);
+			if (!(flags & ScintillaEditorView::MatchCase))
+				c = foldASCII (c);
+			if (c != static_cast<uint8_t> (expected[i]))
+				return false;
+		}
+	}
+	if (flags & (ScintillaEditorView::WholeWord | ScintillaEditorView::WordStart))
+	{
+		if (!isWordStartAt (position, text))
+			return false;
+		if ((flags & ScintillaEditorView::WholeWord) &&
+		    !isWordEndAt (position + static_cast<int64_t> (length), text))
+			return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+template <typename Proc>
+void TextSearch::forEachMatch (const TextView& text, int64_t start, int64_t end, Proc proc) const
+{
+	if (!isSupported ())
+		return;
+	auto length = static_cast<int64_t> (pattern.size ());
+	end = std::min (end, static_cast<int64_t> (text.size ()));
+	auto from = std::max<int64_t> (start, 0);
+	int64_t base = 0;
+	for (auto part : {text.first, text.second})
+	{
+		auto partEnd = base + static_cast<int64_t> (part.size ());
+		from = std::max (from, base);
+		auto to = std::min (end, partEnd);
+		while (from < to)
+		{
+			auto last = part.data () + (to - base);
+			auto candidate = findCandidate (part.data () + (from - base), last);
+			if (candidate == last)
+				break;
+			auto position = base + (candidate - part.data ());
+			if (matchesAt (text, position))
+			{
+				proc (position, position + length);
+				from = position + length;
+			}
+			else
+				from = position + 1;
+		}
+		base = partEnd;
+	}
+}
+
+//------------------------------------------------------------------------
+void TextSearch::findAll (const TextView& text, std::vector<Range>& matches) const
+{
+	findAll (text, 0, static_cast<int64_t> (text.size ()), matches);
+}
+
+//------------------------------------------------------------------------
+void TextSearch::findAll (const TextView& text, int64_t start, int64_t end,
+                          std::vector<Range>& matches) const
+{
+	forEachMatch (text, start, end,
+	              [&] (int64_t from, int64_t to) { matches.push_back ({from, to}); });
+}
+
+//------------------------------------------------------------------------
+size_t TextSearch::count (const TextView& text) const
+{
+	size_t result = 0;
+	forEachMatch (text, 0, static_cast<int64_t> (text.size ()),
+	              [&] (int64_t, int64_t) { ++result; });
+	return result;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
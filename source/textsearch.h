@@ -0,0 +1,84 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** Plain text search directly on the parts of a ScintillaEditorView::TextView.
+ *
+ *	Candidates are found by scanning for the first byte of the pattern (with SSE2 when available,
+ *	both cases at once if the case does not matter) and then compared. Case folding is only
+ *	done for ASCII characters, see isSupported.
+ */
+class TextSearch
+{
+public:
+	using Range = ScintillaEditorView::Range;
+	using TextView = ScintillaEditorView::TextView;
+
+	/** @param searchFlags MatchCase, WholeWord and WordStart of ScintillaEditorView::SearchFlags */
+	TextSearch (std::string_view pattern, uint32_t searchFlags);
+
+	/** set the character classes for WholeWord and WordStart as scintilla reports them with
+	 *	GetWordChars, GetWhitespaceChars and GetPunctuationChars. Other bytes are line ends if
+	 *	they are \r or \n, otherwise punctuation. The default are the classes of scintilla:
+	 *	letters, digits, '_' and all bytes >= 0x80 are word characters, bytes below 0x20 and
+	 *	space are whitespace and the others punctuation.
+	 */
+	void setCharClasses (std::string_view wordChars, std::string_view whitespaceChars,
+	                     std::string_view punctuationChars);
+
+	/** false if the pattern is empty, a regular expression or has non ASCII characters and the
+	 *	case does not matter
+	 */
+	[[nodiscard]] bool isSupported () const;
+	/** true if two matches can overlap, that is a proper prefix of the pattern is also a suffix */
+	[[nodiscard]] bool canOverlap () const;
+	[[nodiscard]] const std::string& getPattern () const { return pattern; }
+	[[nodiscard]] uint32_t getSearchFlags () const { return flags; }
+
+	/** append all non overlapping matches in text to matches */
+	void findAll (const TextView& text, std::vector<Range>& matches) const;
+	/** append the non overlapping matches which start in [start, end) */
+	void findAll (const TextView& text, int64_t start, int64_t end,
+	              std::vector<Range>& matches) const;
+	/** the number of non overlapping matches in text */
+	[[nodiscard]] size_t count (const TextView& text) const;
+	/** check if the pattern matches at position */
+	[[nodiscard]] bool matchesAt (const TextView& text, int64_t position) const;
+
+private:
+	template <typename Proc>
+	void forEachMatch (const TextView& text, int64_t start, int64_t end, Proc proc) const;
+	const char* findCandidate (const char* begin, const char* end) const;
+	bool isWordStartAt (int64_t position, const TextView& text) const;
+	bool isWordEndAt (int64_t position, const TextView& text) const;
+
+	enum class CharClass : uint8_t
+	{
+		Space,
+		NewLine,
+		Word,
+		Punctuation
+	};
+
+	std::string pattern;
+	/** the pattern in lower case if the case does not matter */
+	std::string folded;
+	uint32_t flags;
+	std::array<CharClass, 256> charClasses;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
@@ -0,0 +1,70 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "threadpool.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+ThreadPool::ThreadPool (unsigned numThreads)
+{
+	numThreads = std::max (numThreads, 1u);
+	threads.reserve (numThreads);
+	for (unsigned i = 0; i < numThreads; ++i)
+		threads.emplace_back ([this] () { run (); });
+}
+
+//------------------------------------------------------------------------
+ThreadPool::~ThreadPool () noexcept
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		stop = true;
+		tasks.clear ();
+	}
+	condition.notify_all ();
+	for (auto& thread : threads)
+		thread.join ();
+}
+
+//------------------------------------------------------------------------
+void ThreadPool::post (Task&& task)
+{
+	{
+		std::lock_guard<std::mutex> guard (mutex);
+		tasks.emplace_back (std::move (task));
+	}
+	condition.notify_one ();
+}
+
+//------------------------------------------------------------------------
+void ThreadPool::run ()
+{
+	while (true)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			condition.wait (lock, [this] () { return stop || !tasks.empty (); });
+			if (stop)
+				return;
+			task = std::move (tasks.front ());
+			tasks.pop_front ();
+		}
+		task ();
+	}
+}
+
+//------------------------------------------------------------------------
+ThreadPool& ThreadPool::shared ()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
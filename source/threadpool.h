@@ -0,0 +1,46 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** A fixed number of worker threads executing tasks in the order they were posted. */
+class ThreadPool
+{
+public:
+	using Task = std::function<void ()>;
+
+	/** @param numThreads number of workers, at least one */
+	explicit ThreadPool (unsigned numThreads = std::thread::hardware_concurrency ());
+	/** tasks which did not start yet are dropped, running tasks are waited for */
+	~ThreadPool () noexcept;
+
+	void post (Task&& task);
+	[[nodiscard]] size_t getNumThreads () const { return threads.size (); }
+
+	/** the pool shared by the editor components */
+	static ThreadPool& shared ();
+
+private:
+	void run ();
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<Task> tasks;
+	bool stop {false};
+	std::vector<std::thread> threads;
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
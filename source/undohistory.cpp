@@ -0,0 +1,189 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "undohistory.h"
+
+#include <algorithm>
+#include <limits>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+constexpr std::string_view Magic = "VSTGUI-UNDO-2";
+
+//------------------------------------------------------------------------
+void writeUInt64 (std::string& output, uint64_t value)
+{
+	for (auto shift = 0u; shift < 64; shift += 8)
+		output += static_cast<char> (value >> shift);
+}
+
+//------------------------------------------------------------------------
+bool readUInt64 (std::string_view& input, uint64_t& value)
+{
+	if (input.size () < 8)
+		return false;
+	value = 0;
+	for (auto index = 0u; index < 8; ++index)
+		value |= static_cast<uint64_t> (static_cast<uint8_t> (input[index])) << (index * 8);
+	input.remove_prefix (8);
+	return true;
+}
+
+//------------------------------------------------------------------------
+bool readText (std::string_view& input, std::string& text)
+{
+	uint64_t length;
+	if (!readUInt64 (input, length) || length > input.size ())
+		return false;
+	text.assign (input.data (), length);
+	input.remove_prefix (length);
+	return true;
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+
+//------------------------------------------------------------------------
+uint64_t UndoHistory::getMemoryUsage () const
+{
+	uint64_t result = 0;
+	for (const auto& action : actions)
+		result += ActionOverhead + action.text.size ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+size_t UndoHistory::trim (uint64_t bytes)
+{
+	auto numActions = static_cast<int64_t> (actions.size ());
+	auto usage = getMemoryUsage ();
+	// the oldest steps which are done
+	int64_t first = 0;
+	while (usage > bytes && first < current)
+	{
+		auto end = first;
+		while (end < numActions - 1 && actions[static_cast<size_t> (end)].continuesStep ())
+			++end;
+		if (end + 1 >= numActions)
+			break;
+		for (auto index = first; index <= end; ++index)
+			usage -= ActionOverhead + actions[static_cast<size_t> (index)].text.size ();
+		first = end + 1;
+	}
+	// then the newest steps which can be redone
+	auto last = numActions;
+	while (usage > bytes && last > std::max (current, first + 1))
+	{
+		auto start = last - 1;
+		while (start > current && actions[static_cast<size_t> (start - 1)].continuesStep ())
+			--start;
+		if (start <= first)
+			break;
+		for (auto index = start; index < last; ++index)
+			usage -= ActionOverhead + actions[static_cast<size_t> (index)].text.size ();
+		last = start;
+	}
+	if (first == 0 && last == numActions)
+		return 0;
+
+	actions.erase (actions.begin () + last, actions.end ());
+	actions.erase (actions.begin (), actions.begin () + first);
+	auto move = [&] (int64_t& index) {
+		index = (index < first || index > last) ? -1 : index - first;
+	};
+	current -= first;
+	move (savePoint);
+	move (detach);
+	move (tentative);
+	return static_cast<size_t> (numActions - static_cast<int64_t> (actions.size ()));
+}
+
+//------------------------------------------------------------------------
+bool UndoHistory::revert (std::string& text) const
+{
+	if (current < 0 || current > static_cast<int64_t> (actions.size ()))
+		return false;
+	for (auto index = current; index > 0; --index)
+	{
+		const auto& action = actions[static_cast<size_t> (index - 1)];
+		auto position = static_cast<size_t> (action.position);
+		if (action.position < 0 || position > text.size ())
+			return false;
+		if (action.isInsert ())
+		{
+			if (text.compare (position, action.text.size (), action.text) != 0)
+				return false;
+			text.erase (position, action.text.size ());
+		}
+		else if (action.isDelete ())
+			text.insert (position, action.text);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+std::string UndoHistory::serialize (std::string_view text) const
+{
+	std::string output (Magic);
+	writeUInt64 (output, text.size ());
+	output.append (text);
+	writeUInt64 (output, actions.size ());
+	// the indices are stored plus one, so that none is zero
+	for (auto index : {current, savePoint, detach, tentative})
+		writeUInt64 (output, static_cast<uint64_t> (index + 1));
+	for (const auto& action : actions)
+	{
+		writeUInt64 (output, static_cast<uint32_t> (action.type));
+		writeUInt64 (output, static_cast<uint64_t> (action.position));
+		writeUInt64 (output, action.text.size ());
+		output.append (action.text);
+	}
+	return output;
+}
+
+//------------------------------------------------------------------------
+bool UndoHistory::deserialize (std::string_view data, std::string& text, UndoHistory& history)
+{
+	if (data.substr (0, Magic.size ()) != Magic)
+		return false;
+	data.remove_prefix (Magic.size ());
+	UndoHistory result;
+	uint64_t numActions;
+	if (!readText (data, text) || !readUInt64 (data, numActions))
+		return false;
+	for (auto index : {&result.current, &result.savePoint, &result.detach, &result.tentative})
+	{
+		uint64_t value;
+		if (!readUInt64 (data, value) || value > numActions + 1)
+			return false;
+		*index = static_cast<int64_t> (value) - 1;
+	}
+	if (result.current < 0)
+		return false;
+	for (uint64_t index = 0; index < numActions; ++index)
+	{
+		Action action;
+		uint64_t type, position;
+		if (!readUInt64 (data, type) || !readUInt64 (data, position) ||
+		    !readText (data, action.text) || type > 0xFFFF ||
+		    position > static_cast<uint64_t> (std::numeric_limits<int64_t>::max ()))
+			return false;
+		action.type = static_cast<int32_t> (type);
+		action.position = static_cast<int64_t> (position);
+		result.actions.emplace_back (std::move (action));
+	}
+	std::string base (text);
+	if (!data.empty () || !result.revert (base))
+		return false;
+	history = std::move (result);
+	return true;
+}
+
+//------------------------------------------------------------------------
+} // VSTGUI
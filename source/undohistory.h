@@ -0,0 +1,72 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+
+//------------------------------------------------------------------------
+/** A copy of the undo state of a scintilla document.
+ *
+ *	It is read with the undo state messages of scintilla only to be written to a file or to drop
+ *	the oldest actions, and is not kept while the document is edited. Scintilla stores typing and
+ *	deleting already in merged compact actions.
+ */
+class UndoHistory
+{
+public:
+	struct Action
+	{
+		/** the type as scintilla reports it, 0 for insert, 1 for delete and the coalesce flag */
+		int32_t type {0};
+		int64_t position {0};
+		/** the inserted or the deleted text */
+		std::string text;
+
+		/** the next action belongs to the same undo step */
+		[[nodiscard]] bool continuesStep () const { return (type & CoalesceFlag) != 0; }
+		[[nodiscard]] bool isInsert () const { return (type & ~CoalesceFlag) == 0; }
+		[[nodiscard]] bool isDelete () const { return (type & ~CoalesceFlag) == 1; }
+	};
+	static constexpr int32_t CoalesceFlag = 0x100;
+	/** the memory of an action in scintilla besides its text */
+	static constexpr uint64_t ActionOverhead = 16;
+
+	std::vector<Action> actions;
+	/** the number of actions which are done, the others can be redone */
+	int64_t current {0};
+	/** the action indices of the state of the same names of scintilla, -1 for none */
+	int64_t savePoint {0};
+	int64_t detach {-1};
+	int64_t tentative {-1};
+
+	/** an estimate of the memory of the actions */
+	[[nodiscard]] uint64_t getMemoryUsage () const;
+
+	/** drop the oldest steps, and if needed the steps which can be redone, until the memory
+	 *	usage is at most bytes. The last step is always kept.
+	 *	@return the number of actions which were dropped
+	 */
+	size_t trim (uint64_t bytes);
+
+	/** revert the actions which are done from text, the result is the text before the first
+	 *	action. Returns false if the actions do not match the text.
+	 */
+	[[nodiscard]] bool revert (std::string& text) const;
+
+	/** write the text after the current action and the history */
+	[[nodiscard]] std::string serialize (std::string_view text) const;
+	/** read what serialize wrote */
+	[[nodiscard]] static bool deserialize (std::string_view data, std::string& text,
+	                                       UndoHistory& history);
+};
+
+//------------------------------------------------------------------------
+} // VSTGUI
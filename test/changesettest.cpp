@@ -0,0 +1,114 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillachangeset.h"
+#include "testing.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testChangeSet ()
+{
+	// a replace all of three matches from the start to the end of the document
+	ScintillaChangeSetBuilder builder;
+	int64_t offset = 0;
+	for (int64_t position : {10, 30, 50})
+	{
+		builder.remove (position + offset, 3, 0);
+		builder.insert (position + offset, 5, 0);
+		offset += 2;
+	}
+	auto changeSet = builder.take ();
+	CHECK (builder.empty ());
+	CHECK (changeSet.numModifications == 6);
+	CHECK (changeSet.lengthDelta == 6);
+	CHECK (changeSet.ranges.size () == 3);
+	CHECK (changeSet.ranges[1].start == 32 && changeSet.ranges[1].end == 37);
+
+	// a delete covering earlier changes collapses them
+	builder.insert (0, 5, 1);
+	builder.insert (100, 5, 0);
+	builder.remove (2, 200, -1);
+	changeSet = builder.take ();
+	CHECK (changeSet.ranges.size () == 1);
+	CHECK (changeSet.ranges[0].start == 0 && changeSet.ranges[0].end == 2);
+	CHECK (changeSet.linesDelta == 0);
+}
+
+//------------------------------------------------------------------------
+struct ChangeSetRecorder : IScintillaChangeSetListener
+{
+	void onScintillaChangeSet (ScintillaEditorView*, const ScintillaChangeSet& changeSet) override
+	{
+		changeSets.push_back (changeSet);
+	}
+	std::vector<ScintillaChangeSet> changeSets;
+};
+
+//------------------------------------------------------------------------
+void testChangeSetChannel ()
+{
+	// the view is not attached, its changes are only delivered by flushChangeSet
+	auto view = makeView ();
+	view->setText ("int a;\nint b;\nint c;\n");
+	ChangeSetRecorder recorder;
+	view->registerChangeSetListener (&recorder);
+
+	int64_t offset = 0;
+	for (int64_t position : {4, 11, 18})
+	{
+		view->sendMessage (SCI_DELETERANGE, position + offset, 1);
+		view->sendMessage (SCI_INSERTTEXT, position + offset, "xy");
+		++offset;
+	}
+	CHECK (recorder.changeSets.empty ());
+	view->flushChangeSet ();
+	CHECK (recorder.changeSets.size () == 1);
+	if (recorder.changeSets.size () == 1)
+	{
+		const auto& changeSet = recorder.changeSets[0];
+		CHECK (changeSet.numModifications == 6);
+		CHECK (changeSet.lengthDelta == 3);
+		CHECK (changeSet.linesDelta == 0);
+		CHECK (changeSet.ranges.size () == 3);
+		CHECK (changeSet.ranges[2].start == 20 && changeSet.ranges[2].end == 22);
+	}
+
+	// nothing is delivered without changes
+	view->flushChangeSet ();
+	CHECK (recorder.changeSets.size () == 1);
+
+	view->sendMessage (SCI_INSERTTEXT, 0, "\n");
+	view->flushChangeSet ();
+	CHECK (recorder.changeSets.size () == 2);
+	if (recorder.changeSets.size () == 2)
+		CHECK (recorder.changeSets[1].linesDelta == 1);
+
+	view->unregisterChangeSetListener (&recorder);
+	view->sendMessage (SCI_INSERTTEXT, 0, "x");
+	view->flushChangeSet ();
+	CHECK (recorder.changeSets.size () == 2);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		testChangeSet ();
+		testChangeSetChannel ();
+	});
+}
@@ -0,0 +1,95 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "documentmanager.h"
+#include "testing.h"
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testDocumentManager (const std::string& source)
+{
+	auto editor = makeOwned<ScintillaEditorView> ();
+	DocumentManager manager (*editor);
+	auto first = manager.add (source);
+	auto second = manager.add ("second document");
+	CHECK (manager.show (first));
+	editor->setSelection ({100, 120});
+	CHECK (manager.show (second));
+	CHECK (editor->getText () == "second document");
+
+	measure ("park", source.size (), [&] () { CHECK (manager.park (first)); });
+	CHECK (manager.isParked (first));
+	CHECK (!manager.park (second));
+	auto stats = manager.getStats ();
+	CHECK (stats.numParked == 1);
+	CHECK (stats.parkedBytes == source.size ());
+	CHECK (stats.savedBytes () > source.size () / 2);
+	CHECK (stats.residentBytes == 15);
+
+	measure ("restore", source.size (), [&] () { CHECK (manager.show (first)); });
+	CHECK (!manager.isParked (first));
+	CHECK (editor->getText ().getString () == source);
+	CHECK (editor->getSelection ().start == 100 && editor->getSelection ().end == 120);
+	CHECK (manager.getStats ().numRestores == 1);
+
+	// documents with unsaved changes stay resident, the budget parks the others
+	editor->sendMessage (SCI_INSERTTEXT, 0, "x");
+	auto third = manager.add ("third");
+	CHECK (manager.show (second));
+	CHECK (!manager.park (first));
+	manager.setBudget (1024);
+	CHECK (manager.isParked (third));
+	CHECK (!manager.isParked (first));
+	CHECK (manager.show (third));
+	CHECK (editor->getText () == "third");
+
+	// saved documents are parked with their undo history
+	auto fourth = manager.add ("fourth");
+	CHECK (manager.show (fourth));
+	editor->sendMessage (SCI_INSERTTEXT, 0, "x");
+	editor->sendMessage (SCI_SETSAVEPOINT);
+	CHECK (manager.show (third));
+	CHECK (manager.park (fourth));
+	CHECK (manager.show (fourth));
+	CHECK (editor->getText () == "xfourth");
+	CHECK (editor->sendMessage (SCI_GETMODIFY) == 0);
+	CHECK (editor->canUndo ());
+	editor->undo ();
+	CHECK (editor->getText () == "fourth");
+	editor->redo ();
+	// unless the history is discarded
+	manager.setDiscardUndoHistory (true);
+	CHECK (manager.show (third));
+	CHECK (manager.park (fourth));
+	CHECK (manager.show (fourth));
+	CHECK (editor->getText () == "xfourth");
+	CHECK (!editor->canUndo ());
+	manager.remove (fourth);
+	CHECK (manager.show (third));
+
+	manager.remove (third);
+	CHECK (manager.getActive () == DocumentManager::InvalidID);
+	CHECK (manager.size () == 2);
+	CHECK (editor->getTextView ().empty ());
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		testDocumentManager (makeSource (100000));
+	});
+}
@@ -0,0 +1,75 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "editjournal.h"
+#include "testing.h"
+
+#include <filesystem>
+#include <string>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testJournal (ScintillaEditorView& view)
+{
+	auto path = std::filesystem::temp_directory_path () / "scintilla-headless-test.journal";
+	auto pathString = path.u8string ();
+	{
+		EditJournal journal (pathString);
+		// a few checkpoints are written while the edits below are journaled
+		journal.setCheckpointThreshold (256);
+		journal.attach (&view);
+		for (auto i = 0; i < 100; ++i)
+			view.sendMessage (SCI_INSERTTEXT, i * 7, "edit();");
+		view.sendMessage (SCI_DELETERANGE, 10, 20);
+		view.undo ();
+		view.sendMessage (SCI_DELETERANGE, 0, 3);
+		journal.detach ();
+		CHECK (!journal.hasFailed ());
+
+		std::string recovered;
+		CHECK (EditJournal::recover (pathString, recovered));
+		CHECK (recovered == view.getText ().getString ());
+
+		// showing another document writes a checkpoint of it
+		journal.attach (&view);
+		auto previous = view.getDocument ();
+		view.sendMessage (SCI_ADDREFDOCUMENT, 0, previous);
+		auto options = view.sendMessage (SCI_GETDOCUMENTOPTIONS);
+		auto other = reinterpret_cast<void*> (view.sendMessage (SCI_CREATEDOCUMENT, 0, options));
+		view.setDocument (other, true);
+		view.sendMessage (SCI_RELEASEDOCUMENT, 0, other);
+		view.sendMessage (SCI_INSERTTEXT, 0, "other");
+		journal.detach ();
+		CHECK (!journal.hasFailed ());
+		CHECK (EditJournal::recover (pathString, recovered));
+		CHECK (recovered == "other");
+		view.setDocument (previous, true);
+		view.sendMessage (SCI_RELEASEDOCUMENT, 0, previous);
+		journal.discard ();
+	}
+	std::string recovered;
+	CHECK (!EditJournal::recover (pathString, recovered));
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		auto view = makeView ();
+		view->setText (makeSource (1000).data ());
+		testJournal (*view);
+	});
+}
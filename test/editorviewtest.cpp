@@ -0,0 +1,385 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "testing.h"
+#include "SciLexer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testText (ScintillaEditorView& view, const std::string& source)
+{
+	NotificationCounter counter;
+	view.registerListener (&counter);
+	measure ("setText", source.size (), [&] () { view.setText (source.data ()); });
+	CHECK (counter.inserts == 1);
+
+	UTF8String text;
+	measure ("getText", source.size (), [&] () { text = view.getText (); });
+	CHECK (text.getString () == source);
+
+	// an insert in the middle of the text leaves the gap there
+	auto middle = static_cast<int64_t> (source.size () / 2);
+	view.sendMessage (SCI_INSERTTEXT, middle, "gap");
+	auto textView = view.getTextView ();
+	CHECK (textView.size () == source.size () + 3);
+	CHECK (!textView.second.empty ());
+	auto expected = source.substr (middle - 2, 2) + "gap" + source.substr (middle, 2);
+	CHECK (view.getText ({middle - 2, middle + 5}).getString () == expected);
+	view.sendMessage (SCI_DELETERANGE, middle, 3);
+	CHECK (counter.deletes == 1);
+
+	view.setText ("");
+	CHECK (counter.deletes == 2);
+	view.unregisterListener (&counter);
+	// the text may contain NUL bytes
+	view.setText (std::string_view ("a\0b", 3));
+	CHECK (view.getTextView ().size () == 3);
+	view.setText (source.data ());
+	CHECK (counter.inserts == 2);
+}
+
+//------------------------------------------------------------------------
+void testFilter (ScintillaEditorView& view)
+{
+	NotificationCounter counter;
+	view.registerListener (&counter, {{SCN_MODIFIED}, SC_MOD_DELETETEXT});
+	view.registerListener (&counter, {{SCN_UPDATEUI}});
+	// the view itself only needs inserts and deletes
+	CHECK (view.sendMessage (SCI_GETMODEVENTMASK) == (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT));
+	view.setText ("filtered");
+	CHECK (counter.inserts == 0);
+	CHECK (counter.deletes == 1);
+	view.unregisterListener (&counter);
+	view.unregisterListener (&counter);
+	view.setText ("");
+	CHECK (counter.deletes == 1);
+}
+
+//------------------------------------------------------------------------
+void testOpenFile (ScintillaEditorView& view, const std::string& source)
+{
+	auto path = std::filesystem::temp_directory_path () / "scintilla-headless-test.txt";
+	{
+		std::ofstream stream (path, std::ios::binary);
+		stream.write (source.data (), static_cast<std::streamsize> (source.size ()));
+	}
+	auto pathString = path.u8string ();
+	ScintillaEditorView::LoadResult result;
+	measure ("openFile", source.size (), [&] () { result = view.openFile (pathString.data ()); });
+	CHECK (result.success);
+	CHECK (result.bytes == source.size ());
+	CHECK (view.getTextView ().size () == source.size ());
+	CHECK (!view.canUndo ());
+	CHECK (!view.openFile ("/nonexistent/scintilla-headless-test.txt").success);
+
+	// a read-only view loads the file and stays read-only
+	view.setText ("");
+	view.sendMessage (SCI_SETREADONLY, 1);
+	CHECK (view.openFile (pathString.data ()).success);
+	CHECK (view.getTextView ().size () == source.size ());
+	CHECK (view.sendMessage (SCI_GETREADONLY) != 0);
+	view.sendMessage (SCI_SETREADONLY, 0);
+	std::filesystem::remove (path);
+}
+
+//------------------------------------------------------------------------
+void testOpenFileAsync (ScintillaEditorView& view, const std::string& source)
+{
+	struct LoadListener : IScintillaListener
+	{
+		void onScintillaNotification (SCNotification*) override {}
+		void onScintillaLoadFinished (ScintillaEditorView*, const ScintillaLoadResult& r) override
+		{
+			results.push_back (r);
+		}
+		std::vector<ScintillaLoadResult> results;
+	} listener;
+	view.registerListener (&listener);
+
+	auto path = std::filesystem::temp_directory_path () / "scintilla-headless-async.txt";
+	{
+		std::ofstream stream (path, std::ios::binary);
+		stream.write (source.data (), static_cast<std::streamsize> (source.size ()));
+	}
+	auto pathString = path.u8string ();
+	view.setLexer (ScintillaEditorView::createLexer ("cpp"));
+	auto lexer = view.getLexer ();
+
+	// a cancelled load shows the previous document with its undo history again
+	view.setText ("previous");
+	view.sendMessage (SCI_EMPTYUNDOBUFFER);
+	view.sendMessage (SCI_INSERTTEXT, 0, "the ");
+	auto undoMemory = view.getUndoMemoryUsage ();
+	CHECK (view.openFileAsync (pathString.data ()));
+	CHECK (view.isLoading ());
+	CHECK (view.getTextView ().empty ());
+	CHECK (view.sendMessage (SCI_GETREADONLY) != 0);
+	view.cancelLoading ();
+	CHECK (!view.isLoading ());
+	CHECK (view.getText () == "the previous");
+	CHECK (view.sendMessage (SCI_GETREADONLY) == 0);
+	CHECK (view.getUndoMemoryUsage () == undoMemory);
+	view.undo ();
+	CHECK (view.getText () == "previous");
+	CHECK (listener.results.size () == 1 && !listener.results[0].success);
+
+	// a finished load replaces the document and keeps the lexer
+	CHECK (view.openFileAsync (pathString.data ()));
+	measure ("openFileAsync", source.size (), [&] () { view.flushLoading (); });
+	std::filesystem::remove (path);
+	CHECK (!view.isLoading ());
+	CHECK (listener.results.size () == 2 && listener.results[1].success);
+	CHECK (listener.results[1].bytes == source.size ());
+	CHECK (view.getTextView ().size () == source.size ());
+	CHECK (view.sendMessage (SCI_GETREADONLY) == 0);
+	CHECK (!view.canUndo ());
+	CHECK (view.getLexer () == lexer);
+	CHECK (!view.openFileAsync ("/nonexistent/scintilla-headless-async.txt"));
+
+	view.setLexer (nullptr);
+	view.unregisterListener (&listener);
+}
+
+//------------------------------------------------------------------------
+void testLargeFile (ScintillaEditorView& view, const std::string& source)
+{
+	struct ModeListener : IScintillaListener
+	{
+		void onScintillaLargeFileMode (ScintillaEditorView*, bool state) override
+		{
+			states.push_back (state);
+		}
+		std::vector<bool> states;
+	} listener;
+	view.registerListener (&listener);
+
+	auto path = std::filesystem::temp_directory_path () / "scintilla-headless-large.txt";
+	{
+		std::ofstream stream (path, std::ios::binary);
+		stream.write (source.data (), static_cast<std::streamsize> (source.size ()));
+	}
+	auto pathString = path.u8string ();
+	auto defaultThreshold = view.getLargeFileThreshold ();
+	constexpr uint64_t threshold = 1024 * 1024;
+	view.setLargeFileThreshold (threshold);
+	measure ("openFile (large)", source.size (),
+	         [&] () { CHECK (view.openFile (pathString.data ()).success); });
+	CHECK (view.isLargeFileMode ());
+	CHECK (view.sendMessage (SCI_GETDOCUMENTOPTIONS) & SC_DOCUMENTOPTION_STYLES_NONE);
+	CHECK (view.sendMessage (SCI_GETLAYOUTCACHE) == SC_CACHE_PAGE);
+	CHECK (view.sendMessage (SCI_GETWRAPMODE) == SC_WRAP_NONE);
+	CHECK (view.getTextView ().size () == source.size ());
+
+	// the mode is kept slightly below the threshold and left below three quarters of it
+	view.sendMessage (SCI_DELETERANGE, 0, source.size () - threshold + 1024);
+	CHECK (view.isLargeFileMode ());
+	view.sendMessage (SCI_DELETERANGE, 0, threshold / 2);
+	CHECK (!view.isLargeFileMode ());
+	CHECK ((listener.states == std::vector<bool> {true, false}));
+
+	// the styles come back with the next loaded document
+	view.setLargeFileThreshold (defaultThreshold);
+	CHECK (view.openFile (pathString.data ()).success);
+	std::filesystem::remove (path);
+	CHECK (!view.isLargeFileMode ());
+	CHECK (!(view.sendMessage (SCI_GETDOCUMENTOPTIONS) & SC_DOCUMENTOPTION_STYLES_NONE));
+	CHECK (view.getTextView ().size () == source.size ());
+	view.unregisterListener (&listener);
+}
+
+//------------------------------------------------------------------------
+void testSharedDocument (ScintillaEditorView& view)
+{
+	view.setLexer (ScintillaEditorView::createLexer ("cpp"));
+	auto length = view.getTextView ().size ();
+	auto second = makeOwned<ScintillaEditorView> ();
+	second->setText ("other");
+	CHECK (second->attachDocument (view));
+	CHECK (view.getNumDocumentViews () == 2);
+	CHECK (second->sendMessage (SCI_GETDOCPOINTER) == view.sendMessage (SCI_GETDOCPOINTER));
+	CHECK (second->getLexer () == view.getLexer ());
+	CHECK (second->getTextView ().size () == length);
+
+	// one text and one undo history
+	second->sendMessage (SCI_INSERTTEXT, 0, "int x;\n");
+	CHECK (view.getTextView ().size () == length + 7);
+	CHECK (view.canUndo ());
+	view.sendMessage (SCI_UNDO);
+	CHECK (second->getTextView ().size () == length);
+
+	second->detachDocument ();
+	CHECK (view.getNumDocumentViews () == 1);
+	CHECK (second->getNumDocumentViews () == 1);
+	CHECK (second->getTextView ().size () == 0);
+	CHECK (second->getLexer () == nullptr);
+	CHECK (view.getLexer () != nullptr);
+
+	// the document lives as long as one of its views
+	auto first = makeOwned<ScintillaEditorView> ();
+	first->setText ("shared");
+	CHECK (second->attachDocument (*first));
+	first = nullptr;
+	CHECK (second->getNumDocumentViews () == 1);
+	CHECK (second->getText () == "shared");
+}
+
+//------------------------------------------------------------------------
+void testTheme (ScintillaEditorView& view)
+{
+	ScintillaTheme theme (*view.getTheme ());
+	theme.setBackground (kGreyCColor);
+	theme.setStyleForeground (SCE_C_COMMENT, kRedCColor);
+	auto shared = ScintillaTheme::intern (theme);
+	CHECK (shared == ScintillaTheme::intern (theme));
+
+	view.setTheme (shared);
+	CHECK (view.getBackgroundColor () == kGreyCColor);
+	CHECK (fromScintillaColor (view.sendMessage (SCI_STYLEGETBACK, SCE_C_WORD)) == kGreyCColor);
+	CHECK (fromScintillaColor (view.sendMessage (SCI_STYLEGETFORE, SCE_C_COMMENT)) == kRedCColor);
+
+	// switching back only resets the comment style
+	theme.resetStyle (SCE_C_COMMENT);
+	view.setTheme (ScintillaTheme::intern (theme));
+	CHECK (view.sendMessage (SCI_STYLEGETFORE, SCE_C_COMMENT) ==
+	       view.sendMessage (SCI_STYLEGETFORE, STYLE_DEFAULT));
+}
+
+//------------------------------------------------------------------------
+void testUndo (ScintillaEditorView& view)
+{
+	auto length = view.sendMessage (SCI_GETTEXTLENGTH);
+	view.sendMessage (SCI_EMPTYUNDOBUFFER);
+	CHECK (!view.canUndo ());
+	view.sendMessage (SCI_INSERTTEXT, 0, "// header\n");
+	CHECK (view.canUndo ());
+	view.undo ();
+	CHECK (view.sendMessage (SCI_GETTEXTLENGTH) == length);
+	CHECK (view.canRedo ());
+	view.redo ();
+	CHECK (view.sendMessage (SCI_GETTEXTLENGTH) == length + 10);
+}
+
+//------------------------------------------------------------------------
+void testDiagnostics (ScintillaEditorView& view)
+{
+	std::vector<ScintillaDiagnostic> diagnostics;
+	for (int64_t line = 0; line < 10000; ++line)
+	{
+		auto severity = static_cast<ScintillaDiagnostic::Severity> (line % 3);
+		diagnostics.push_back ({line * 5, 0, 4, severity, "diagnostic " + std::to_string (line)});
+	}
+	measure ("setDiagnostics", 0, [&] () { view.setDiagnostics (diagnostics); });
+	constexpr auto ErrorMarker = 1 << 22;
+	CHECK (view.sendMessage (SCI_MARKERGET, 10) == ErrorMarker);
+	CHECK (view.sendMessage (SCI_ANNOTATIONGETTEXT, 10) == 12);
+
+	diagnostics[2].message = "changed";
+	diagnostics.pop_back ();
+	measure ("setDiagnostics (diff)", 0, [&] () { view.setDiagnostics (diagnostics); });
+	CHECK (view.sendMessage (SCI_ANNOTATIONGETTEXT, 10) == 7);
+	CHECK (view.sendMessage (SCI_MARKERGET, 9999 * 5) == 0);
+
+	// an added line moves the following diagnostics, the diff follows them
+	view.sendMessage (SCI_INSERTTEXT, view.sendMessage (SCI_POSITIONFROMLINE, 10), "added\n");
+	for (auto& diagnostic : diagnostics)
+	{
+		if (diagnostic.line >= 10)
+			++diagnostic.line;
+	}
+	view.setDiagnostics (diagnostics);
+	CHECK (view.sendMessage (SCI_MARKERGET, 10) == 0);
+	CHECK (view.sendMessage (SCI_ANNOTATIONGETTEXT, 10) == 0);
+	CHECK (view.sendMessage (SCI_MARKERGET, 11) == ErrorMarker);
+	CHECK (view.sendMessage (SCI_ANNOTATIONGETTEXT, 11) == 7);
+	CHECK (view.sendMessage (SCI_MARKERGET, 9998 * 5 + 1) != 0);
+	view.sendMessage (SCI_DELETERANGE, view.sendMessage (SCI_POSITIONFROMLINE, 10), 6);
+
+	view.clearDiagnostics ();
+	CHECK (view.sendMessage (SCI_MARKERGET, 10) == 0);
+	CHECK (view.sendMessage (SCI_ANNOTATIONGETTEXT, 10) == 0);
+}
+
+//------------------------------------------------------------------------
+void testPositionConversion ()
+{
+	using PositionUnit = ScintillaEditorView::PositionUnit;
+	constexpr int64_t numLines = 100000;
+	// "é" is one UTF-16 code unit in two bytes, "😀" two UTF-16 code units in four bytes
+	std::string text;
+	for (int64_t i = 0; i < numLines; ++i)
+		text += "\xC3\xA9\xF0\x9F\x98\x80 value = " + std::to_string (i) + ";\n";
+	auto editor = makeOwned<ScintillaEditorView> ();
+	editor->setText (text.data ());
+
+	auto lineStart = editor->sendMessage (SCI_POSITIONFROMLINE, 1);
+	auto bytes = editor->toBytePositions (
+	    {{1, 0}, {1, 1}, {1, 2}, {1, 3}, {1, 1000}, {numLines + 1, 0}}, PositionUnit::UTF16);
+	CHECK (bytes[0] == lineStart && bytes[1] == lineStart + 2);
+	// a column inside of a surrogate pair maps to the start of the character
+	CHECK (bytes[2] == lineStart + 2 && bytes[3] == lineStart + 6);
+	CHECK (bytes[4] == editor->sendMessage (SCI_GETLINEENDPOSITION, 1));
+	CHECK (bytes[5] == static_cast<int64_t> (text.size ()));
+	CHECK (editor->toBytePositions ({{1, 2}}, PositionUnit::UTF32)[0] == lineStart + 6);
+	auto lines = editor->toLinePositions ({lineStart + 6, lineStart + 3}, PositionUnit::UTF16);
+	CHECK (lines[0].line == 1 && lines[0].column == 3);
+	CHECK (lines[1].line == 1 && lines[1].column == 1);
+
+	// the positions of diagnostics, in no particular order
+	std::vector<ScintillaEditorView::LinePosition> positions;
+	for (int64_t i = 0; i < numLines; ++i)
+		positions.push_back ({(i * 7919) % numLines, 3 + i % 8});
+	measure ("toBytePositions", 0,
+	         [&] () { bytes = editor->toBytePositions (positions, PositionUnit::UTF16); });
+	measure ("toLinePositions", 0,
+	         [&] () { lines = editor->toLinePositions (bytes, PositionUnit::UTF16); });
+	CHECK (std::equal (lines.begin (), lines.end (), positions.begin (), [] (auto a, auto b) {
+		return a.line == b.line && a.column == b.column;
+	}));
+
+	auto firstLineUnits = static_cast<int64_t> (text.find ('\n')) + 1 - 3;
+	auto index = editor->byteToIndexPositions ({lineStart, lineStart + 6}, PositionUnit::UTF16);
+	CHECK (index[0] == firstLineUnits && index[1] == firstLineUnits + 3);
+	CHECK (editor->indexToBytePositions (index, PositionUnit::UTF16)[1] == lineStart + 6);
+	measure ("byteToIndexPositions", 0,
+	         [&] () { index = editor->byteToIndexPositions (bytes, PositionUnit::UTF16); });
+	CHECK (editor->indexToBytePositions (index, PositionUnit::UTF16) == bytes);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		auto source = makeSource (100000);
+		auto view = makeView ();
+		testText (*view, source);
+		testFilter (*view);
+		testOpenFile (*view, source);
+		testOpenFileAsync (*view, source);
+		testLargeFile (*view, source);
+		testSharedDocument (*view);
+		testTheme (*view);
+		testUndo (*view);
+		testDiagnostics (*view);
+		testPositionConversion ();
+		if (ScintillaMessageStats::enabled ())
+			CHECK (!ScintillaMessageStats::snapshot ().empty ());
+	});
+}
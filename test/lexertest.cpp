@@ -0,0 +1,128 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "lexerregistry.h"
+#include "testing.h"
+#include "SciLexer.h"
+
+#include <string>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testLexer (ScintillaEditorView& view, size_t bytes)
+{
+	auto lexer = ScintillaEditorView::createLexer ("cpp");
+	CHECK (lexer != nullptr);
+	measure ("setLexer + colourise", bytes, [&] () {
+		view.setLexer (lexer);
+		view.sendMessage (SCI_SETKEYWORDS, 0, "int");
+		view.sendMessage (SCI_COLOURISE, 0, -1);
+	});
+	CHECK (view.sendMessage (SCI_GETENDSTYLED) == view.sendMessage (SCI_GETTEXTLENGTH));
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, 0) == SCE_C_WORD);
+}
+
+//------------------------------------------------------------------------
+void testBackgroundLexing (ScintillaEditorView& view, size_t bytes)
+{
+	auto lexer = ScintillaEditorView::createLexer ("cpp");
+	lexer->WordListSet (0, "int");
+	lexer->PropertySet ("fold", "1");
+	view.setLexer (lexer);
+	view.setBackgroundLexing (true);
+	CHECK (view.isBackgroundLexing ());
+	measure ("background lexing", bytes, [&] () {
+		view.sendMessage (SCI_COLOURISE, 0, -1);
+		view.flushBackgroundLexing ();
+	});
+	CHECK (view.sendMessage (SCI_GETENDSTYLED) == view.sendMessage (SCI_GETTEXTLENGTH));
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, 0) == SCE_C_WORD);
+	auto lastLine = view.sendMessage (SCI_GETLINECOUNT) - 2;
+	auto lastLineStart = view.sendMessage (SCI_POSITIONFROMLINE, lastLine);
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, lastLineStart) == SCE_C_WORD);
+
+	// the result of the job is discarded as the document changes before it is applied
+	view.sendMessage (SCI_COLOURISE, 0, -1);
+	view.sendMessage (SCI_INSERTTEXT, 0, "void f ()\n{\n/* x */\n}\n");
+	view.flushBackgroundLexing ();
+	CHECK (view.sendMessage (SCI_GETENDSTYLED) == view.sendMessage (SCI_GETTEXTLENGTH));
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, view.sendMessage (SCI_POSITIONFROMLINE, 2)) ==
+	       SCE_C_COMMENT);
+	CHECK (view.sendMessage (SCI_GETFOLDLEVEL, 1) & SC_FOLDLEVELHEADERFLAG);
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, view.sendMessage (SCI_POSITIONFROMLINE, 4)) ==
+	       SCE_C_WORD);
+
+	view.sendMessage (SCI_DELETERANGE, 0, 22);
+	view.setBackgroundLexing (false);
+	CHECK (view.getLexer () == lexer);
+}
+
+//------------------------------------------------------------------------
+void testLexerRegistry (ScintillaEditorView& view)
+{
+	auto& registry = LexerRegistry::instance ();
+	LexerRegistry::Config config;
+	config.lexerName = "cpp";
+	config.keywords[0] = "  int\n\tvoid ";
+	config.properties["fold"] = "1";
+	config.styles[SCE_C_WORD].weight = 900;
+	registry.add ("test-cpp", std::move (config));
+	CHECK (registry.contains ("test-cpp"));
+	CHECK (registry.create ("unknown") == nullptr);
+
+	auto lexer = registry.create ("test-cpp");
+	CHECK (lexer != nullptr);
+	CHECK (std::string (lexer->PropertyGet ("fold")) == "1");
+	view.setLexer (lexer);
+	view.sendMessage (SCI_COLOURISE, 0, -1);
+	CHECK (view.sendMessage (SCI_GETSTYLEAT, 0) == SCE_C_WORD);
+
+	// the lexer is reused after the view and the caller released it
+	auto address = lexer.get ();
+	lexer = nullptr;
+	CHECK (registry.getNumIdleLexers ("test-cpp") == 0);
+	view.setLexer (nullptr);
+	CHECK (registry.getNumIdleLexers ("test-cpp") == 1);
+	lexer = registry.create ("test-cpp");
+	CHECK (lexer.get () == address);
+	CHECK (registry.getNumIdleLexers ("test-cpp") == 0);
+
+	ScintillaTheme theme;
+	CHECK (registry.applyStyles ("test-cpp", theme));
+	CHECK (theme.resolve (SCE_C_WORD).weight == 900);
+
+	// a lexer of a removed configuration is released and not kept
+	registry.remove ("test-cpp");
+	lexer = nullptr;
+	CHECK (registry.getNumIdleLexers ("test-cpp") == 0);
+
+	auto cppLexer = ScintillaEditorView::createLexer ("cpp");
+	cppLexer->WordListSet (0, "int");
+	view.setLexer (cppLexer);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		auto source = makeSource (100000);
+		auto view = makeView ();
+		view->setText (source.data ());
+		testLexer (*view, source.size ());
+		testBackgroundLexing (*view, source.size ());
+		testLexerRegistry (*view);
+	});
+}
@@ -0,0 +1,70 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "scintillaminimapview.h"
+#include "testing.h"
+#include "SciLexer.h"
+
+#include <string>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testMinimap (const std::string& source)
+{
+	auto editor = makeOwned<ScintillaEditorView> ();
+	editor->setTabWidth (4);
+	auto lexer = ScintillaEditorView::createLexer ("cpp");
+	lexer->WordListSet (0, "int");
+	editor->setLexer (lexer);
+	editor->setText ("\tint x;\n    // comment\n");
+	editor->sendMessage (SCI_COLOURISE, 0, -1);
+	auto minimap = makeOwned<ScintillaMinimapView> (CRect (0, 0, 80, 400));
+	minimap->setEditor (editor);
+
+	auto summary = minimap->getLineSummary (0);
+	CHECK (summary.style == SCE_C_WORD && summary.indent == 4 && summary.length == 10);
+	summary = minimap->getLineSummary (1);
+	CHECK (summary.style == SCE_C_COMMENTLINE && summary.indent == 4 && summary.length == 14);
+
+	// the summaries move with their lines
+	editor->sendMessage (SCI_INSERTTEXT, 0, "a\nb\n");
+	CHECK (minimap->getLineSummary (2).style == SCE_C_WORD);
+	CHECK (minimap->getLineSummary (3).style == SCE_C_COMMENTLINE);
+	editor->sendMessage (SCI_DELETERANGE, 0, 4);
+	CHECK (minimap->getLineSummary (1).style == SCE_C_COMMENTLINE);
+	editor->sendMessage (SCI_STARTSTYLING, editor->sendMessage (SCI_POSITIONFROMLINE, 1));
+	editor->sendMessage (SCI_SETSTYLING, 14, SCE_C_STRING);
+	CHECK (minimap->getLineSummary (1).style == SCE_C_STRING);
+
+	editor->setText (source.data ());
+	editor->sendMessage (SCI_COLOURISE, 0, -1);
+	auto numLines = editor->sendMessage (SCI_GETLINECOUNT);
+	uint64_t columns = 0;
+	measure ("minimap summaries", source.size (), [&] () {
+		for (intptr_t line = 0; line < numLines; ++line)
+			columns += minimap->getLineSummary (line).length;
+	});
+	CHECK (columns + numLines - 1 == source.size ());
+	minimap->setEditor (nullptr);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		testMinimap (makeSource (100000));
+	});
+}
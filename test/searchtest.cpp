@@ -0,0 +1,279 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "incrementalsearch.h"
+#include "multidocumentsearch.h"
+#include "testing.h"
+
+#include <chrono>
+#include <limits>
+#include <map>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testFind (ScintillaEditorView& view, size_t numLines, size_t bytes)
+{
+	view.sendMessage (SCI_SETSEL, 0, 0);
+	size_t found = 0;
+	measure ("findAndSelect", bytes, [&] () {
+		while (view.findAndSelect ("computeValue", ScintillaEditorView::MatchCase) >= 0)
+			++found;
+	});
+	CHECK (found == numLines);
+
+	view.sendMessage (SCI_SETSEL, 0, 0);
+	CHECK (view.findAndSelect ("COMPUTEVALUE", ScintillaEditorView::MatchCase) < 0);
+	CHECK (view.findAndSelect ("COMPUTEVALUE", 0) >= 0);
+
+	// findAll works on the gap buffer and does not touch the selection
+	auto middle = view.sendMessage (SCI_POSITIONFROMLINE, numLines / 2);
+	view.sendMessage (SCI_INSERTTEXT, middle, "computeValue");
+	view.sendMessage (SCI_SETSEL, 5, 7);
+	std::vector<ScintillaEditorView::Range> matches;
+	measure ("findAll", bytes, [&] () { matches = view.findAll ("COMPUTEVALUE", 0); });
+	CHECK (matches.size () == numLines + 1);
+	CHECK (view.getSelection ().start == 5 && view.getSelection ().end == 7);
+	CHECK (view.countMatches ("computeValue", ScintillaEditorView::MatchCase) == numLines + 1);
+	CHECK (view.countMatches ("value", ScintillaEditorView::WholeWord) == 0);
+	CHECK (view.countMatches ("value1", ScintillaEditorView::WordStart) > 0);
+	constexpr auto Regex = ScintillaEditorView::RegularExpression;
+	measure ("findAll (regex)", bytes,
+	         [&] () { matches = view.findAll ("computevalue \\(\\d+\\)", Regex); });
+	CHECK (matches.size () == numLines);
+	// the line with the inserted text does not start with int
+	CHECK (view.findAll ("^int value\\d+ =", Regex | ScintillaEditorView::MatchCase).size () ==
+	       numLines - 1);
+	CHECK (view.findAll ("([", Regex).empty ());
+	// \b at the start of a chunk sees the line end before the chunk
+	CHECK (view.findAll ("\\bint\\b", Regex | ScintillaEditorView::MatchCase).size () ==
+	       numLines - 1);
+	// the ^ of a character class does not anchor, the pattern matches across a line end
+	CHECK (view.findAll ("[^x]\nint value1 =", Regex | ScintillaEditorView::MatchCase).size () ==
+	       1);
+	matches = view.findAll ("COMPUTEVALUE", 0);
+	view.setFindHighlights (matches);
+	CHECK (view.sendMessage (SCI_INDICATORVALUEAT, 11, matches[0].start) == 1);
+	view.clearFindHighlights ();
+	view.sendMessage (SCI_DELETERANGE, middle, 12);
+}
+
+//------------------------------------------------------------------------
+void testIncrementalSearch (ScintillaEditorView& view, size_t numLines)
+{
+	IncrementalSearch search (&view);
+	// scan immediately, the debounced scan is tested below
+	search.setDebounceThreshold (std::numeric_limits<size_t>::max ());
+	int callbacks = 0;
+	search.setCallback ([&] (const auto&) { ++callbacks; });
+
+	search.setQuery ("comp", ScintillaEditorView::MatchCase);
+	CHECK (search.getMatches ().size () == numLines);
+	// extending the query filters the known matches
+	search.setQuery ("computeV", ScintillaEditorView::MatchCase);
+	CHECK (search.getMatches ().size () == numLines);
+	search.setQuery ("computeVx", ScintillaEditorView::MatchCase);
+	CHECK (search.getMatches ().empty ());
+	search.setQuery ("computeValue", ScintillaEditorView::MatchCase);
+	CHECK (search.getMatches ().size () == numLines);
+	CHECK (callbacks == 4);
+
+	// edits only touch the matches around the change
+	auto position = search.getMatches ()[10].start;
+	view.sendMessage (SCI_INSERTTEXT, position + 3, "X");
+	CHECK (search.getMatches ().size () == numLines - 1);
+	view.sendMessage (SCI_DELETERANGE, position + 3, 1);
+	CHECK (search.getMatches ().size () == numLines);
+	CHECK (search.getMatches ()[10].start == position);
+	view.sendMessage (SCI_INSERTTEXT, 0, "computeValue");
+	CHECK (search.getMatches ().size () == numLines + 1);
+	CHECK (search.getMatches ()[11].start == position + 12);
+	view.sendMessage (SCI_DELETERANGE, 0, 12);
+	CHECK (search.nextMatch (position) == 10);
+
+	// the document is larger than the threshold, new queries wait for the debounce delay. The
+	// view is not attached, so the delayed scan is only run by flush.
+	search.setDebounceThreshold (0);
+	search.setQuery ("value", ScintillaEditorView::MatchCase);
+	CHECK (search.isPending ());
+	CHECK (search.getMatches ().size () == numLines);
+	search.setQuery ("value1", ScintillaEditorView::MatchCase);
+	CHECK (search.isPending ());
+	CHECK (callbacks == 4);
+	// edits while pending do not touch the matches of the previous query
+	view.sendMessage (SCI_INSERTTEXT, 0, "value1");
+	CHECK (search.getMatches ().size () == numLines);
+	search.flush ();
+	CHECK (!search.isPending ());
+	CHECK (callbacks == 5);
+	CHECK (search.getQuery () == "value1");
+	CHECK (search.getMatches ().size () ==
+	       view.countMatches ("value1", ScintillaEditorView::MatchCase));
+	CHECK (search.getMatches ()[0].start == 0);
+	// a flush without a pending scan does nothing
+	search.flush ();
+	CHECK (callbacks == 5);
+	view.sendMessage (SCI_DELETERANGE, 0, 6);
+
+	// a regular expression can not be updated around an edit, the edit only marks a scan as
+	// pending which does not call the callback
+	search.setDebounceThreshold (std::numeric_limits<size_t>::max ());
+	search.setQuery ("value1+", ScintillaEditorView::MatchCase |
+	                                ScintillaEditorView::RegularExpression);
+	CHECK (callbacks == 6);
+	auto count = search.getMatches ().size ();
+	view.sendMessage (SCI_INSERTTEXT, 0, "value1");
+	CHECK (search.isPending ());
+	CHECK (search.getMatches ().size () == count);
+	search.flush ();
+	CHECK (search.getMatches ().size () == count + 1);
+	CHECK (callbacks == 6);
+	view.sendMessage (SCI_DELETERANGE, 0, 6);
+	search.flush ();
+	CHECK (search.getMatches ().size () == count);
+}
+
+//------------------------------------------------------------------------
+void testWordBoundaryParity ()
+{
+	// findAll searches on the text directly, findAndSelect lets scintilla search
+	auto view = makeView ();
+	view->setText ("a (b) foo.bar  foo_bar\n(x) -> foo ->y\n\tfoo(\n ( foo");
+	for (auto flags : {ScintillaEditorView::WholeWord, ScintillaEditorView::WordStart})
+	{
+		for (auto pattern : {"(", " foo", "foo", "a (", "->", ".bar", "foo(", "\n("})
+		{
+			auto searchFlags = ScintillaEditorView::MatchCase | flags;
+			std::vector<int64_t> expected;
+			view->sendMessage (SCI_SETSEL, 0, 0);
+			while (view->findAndSelect (pattern, searchFlags) >= 0)
+				expected.push_back (view->getSelection ().start);
+			std::vector<int64_t> found;
+			for (const auto& match : view->findAll (pattern, searchFlags))
+				found.push_back (match.start);
+			CHECK (found == expected);
+			CHECK (view->countMatches (pattern, searchFlags) == expected.size ());
+		}
+	}
+	// whitespace, words and punctuation are three classes
+	CHECK (view->countMatches ("(", ScintillaEditorView::WholeWord) == 4);
+	CHECK (view->countMatches (" foo", ScintillaEditorView::WholeWord) == 0);
+}
+
+//------------------------------------------------------------------------
+void testReplaceAll (ScintillaEditorView& view, size_t numLines, size_t bytes)
+{
+	auto length = view.sendMessage (SCI_GETTEXTLENGTH);
+	view.sendMessage (SCI_EMPTYUNDOBUFFER);
+	size_t count = 0;
+	measure ("replaceAll", bytes, [&] () {
+		count = view.replaceAll ("computeValue", "calc", ScintillaEditorView::MatchCase);
+	});
+	CHECK (count == numLines);
+	CHECK (view.sendMessage (SCI_GETTEXTLENGTH) == length - static_cast<intptr_t> (numLines * 8));
+	CHECK (view.countMatches ("calc (", ScintillaEditorView::MatchCase) == numLines);
+	view.undo ();
+	CHECK (!view.canUndo ());
+	CHECK (view.sendMessage (SCI_GETTEXTLENGTH) == length);
+	CHECK (view.replaceAll ("notInTheText", "x", 0) == 0);
+}
+
+//------------------------------------------------------------------------
+void testReplaceAllChangedRange ()
+{
+	auto view = makeView ();
+	view->setText ("x\nb\nX\nc\nx\n");
+	view->sendMessage (SCI_EMPTYUNDOBUFFER);
+	view->sendMessage (SCI_MARKERADD, 1, 2);
+	view->sendMessage (SCI_MARKERADD, 3, 2);
+	view->sendMessage (SCI_SETINDICATORCURRENT, 8);
+	view->sendMessage (SCI_INDICATORFILLRANGE, 6, 1);
+
+	// only the upper case match differs from its replacement, the marker and indicator around it
+	// are kept
+	CHECK (view->replaceAll ("x", "x", 0) == 3);
+	CHECK (view->getTextView ().equals ("x\nb\nx\nc\nx\n"));
+	CHECK (view->sendMessage (SCI_MARKERGET, 1) == (1 << 2));
+	CHECK (view->sendMessage (SCI_MARKERGET, 3) == (1 << 2));
+	CHECK (view->sendMessage (SCI_INDICATORVALUEAT, 8, 6) == 1);
+	// as one undo step
+	view->undo ();
+	CHECK (!view->canUndo ());
+	CHECK (view->getTextView ().equals ("x\nb\nX\nc\nx\n"));
+
+	// a replacement which changes nothing is no edit
+	CHECK (view->replaceAll ("b", "b", ScintillaEditorView::MatchCase) == 1);
+	CHECK (!view->canUndo ());
+
+	// nothing is replaced in a read-only document
+	view->sendMessage (SCI_SETREADONLY, 1);
+	CHECK (view->replaceAll ("x", "yy", ScintillaEditorView::MatchCase) == 0);
+	CHECK (view->getTextView ().equals ("x\nb\nX\nc\nx\n"));
+	CHECK (!view->canUndo ());
+}
+
+//------------------------------------------------------------------------
+void testMultiDocumentSearch (ScintillaEditorView& view, size_t numLines, size_t bytes)
+{
+	std::vector<SharedPointer<ScintillaEditorView>> others;
+	std::vector<ScintillaEditorView*> views {&view};
+	for (auto i = 0; i < 8; ++i)
+	{
+		others.emplace_back (makeOwned<ScintillaEditorView> ());
+		others.back ()->setText ((std::string (i, '\n') + "computeValue ()").data ());
+		views.emplace_back (others.back ());
+	}
+	std::map<ScintillaEditorView*, size_t> results;
+	size_t total = 0;
+	MultiDocumentSearch search (false);
+	measure ("MultiDocumentSearch", bytes, [&] () {
+		search.start (views, "computevalue", 0,
+		              [&] (auto v, auto&& matches) { results[v] = matches.size (); },
+		              [&] (auto numMatches) { total = numMatches; });
+		while (!search.poll ())
+			std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	});
+	CHECK (!search.isRunning ());
+	CHECK (total == numLines + others.size ());
+	CHECK (results.size () == views.size ());
+	CHECK (results[&view] == numLines);
+
+	// non ASCII patterns without MatchCase are searched by scintilla on the calling thread
+	others.front ()->setText ("\xC3\xA4 \xC3\xA4");
+	search.start ({others.front ()}, "\xC3\xA4", 0, {},
+	              [&] (auto numMatches) { total = numMatches; });
+	while (!search.poll ())
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	CHECK (total == 2);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		constexpr size_t numLines = 100000;
+		auto source = makeSource (numLines);
+		auto view = makeView ();
+		view->setText (source.data ());
+		testFind (*view, numLines, source.size ());
+		testIncrementalSearch (*view, numLines);
+		testWordBoundaryParity ();
+		testReplaceAll (*view, numLines, source.size ());
+		testReplaceAllChangedRange ();
+		testMultiDocumentSearch (*view, numLines, source.size ());
+	});
+}
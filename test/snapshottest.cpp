@@ -0,0 +1,72 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "documentsnapshot.h"
+#include "testing.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testSnapshot (ScintillaEditorView& view, const std::string& source)
+{
+	view.setText (source.data ());
+	std::shared_ptr<const DocumentSnapshot> snapshot;
+	measure ("createSnapshot (first)", source.size (),
+	         [&] () { snapshot = view.createSnapshot (); });
+	CHECK (snapshot->getText () == source);
+	CHECK (view.createSnapshot () == snapshot);
+
+	// an edit only copies the chunk it touches, older snapshots keep their text
+	auto middle = static_cast<int64_t> (source.size () / 2);
+	view.sendMessage (SCI_INSERTTEXT, middle, "snapshot");
+	view.sendMessage (SCI_DELETERANGE, 0, 10);
+	std::shared_ptr<const DocumentSnapshot> edited;
+	measure ("createSnapshot (edited)", source.size (),
+	         [&] () { edited = view.createSnapshot (); });
+	CHECK (edited->getVersion () > snapshot->getVersion ());
+	CHECK (edited->getText () == view.getText ().getString ());
+	CHECK (snapshot->getText () == source);
+	size_t shared = 0;
+	for (const auto& chunk : edited->getChunks ())
+	{
+		const auto& chunks = snapshot->getChunks ();
+		shared += std::find (chunks.begin (), chunks.end (), chunk) != chunks.end ();
+	}
+	CHECK (shared + 2 >= edited->getChunks ().size ());
+
+	// read on another thread while the document changes
+	std::string copy;
+	std::thread reader ([&] () { copy = edited->getText (); });
+	view.sendMessage (SCI_DELETERANGE, 0, middle);
+	reader.join ();
+	CHECK (copy.size () == source.size () - 2);
+	CHECK (view.createSnapshot ()->getText () == view.getText ().getString ());
+	view.setText (source.data ());
+	CHECK (view.createSnapshot ()->getText () == source);
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		auto source = makeSource (100000);
+		auto view = makeView ();
+		testSnapshot (*view, source);
+	});
+}
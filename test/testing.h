@@ -0,0 +1,108 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#pragma once
+
+#include "scintillaeditorview.h"
+#include "scintillamessagestats.h"
+#include "Scintilla.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace Test {
+
+//------------------------------------------------------------------------
+inline int failures = 0;
+/** set by --benchmark, only then the throughput of the measured blocks is printed */
+inline bool benchmark = false;
+
+#define CHECK(expr)                                                                          \
+	do                                                                                       \
+	{                                                                                        \
+		if (!(expr))                                                                         \
+		{                                                                                    \
+			fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);         \
+			++VSTGUI::Test::failures;                                                        \
+		}                                                                                    \
+	} while (false)
+
+//------------------------------------------------------------------------
+/** runs func and prints its throughput when benchmarking */
+template <typename Proc>
+void measure (const char* name, size_t bytes, Proc func)
+{
+	auto start = std::chrono::steady_clock::now ();
+	func ();
+	if (!benchmark)
+		return;
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now () - start;
+	auto mbPerSecond = seconds.count () > 0. ? (bytes / (1024. * 1024.)) / seconds.count () : 0.;
+	printf ("%-24s %10.3f ms %10.1f MB/s\n", name, seconds.count () * 1000., mbPerSecond);
+}
+
+//------------------------------------------------------------------------
+/** numLines lines of C++ like source, each one contains computeValue once */
+inline std::string makeSource (size_t numLines)
+{
+	std::string text;
+	text.reserve (numLines * 48);
+	for (size_t i = 0; i < numLines; ++i)
+	{
+		text += "int value" + std::to_string (i) + " = computeValue (" + std::to_string (i) +
+		        "); // note\n";
+	}
+	return text;
+}
+
+//------------------------------------------------------------------------
+/** a view with a size, as the views of the tests are not attached to a frame */
+inline SharedPointer<ScintillaEditorView> makeView ()
+{
+	auto view = makeOwned<ScintillaEditorView> ();
+	view->setViewSize (CRect (0, 0, 800, 600), false);
+	return view;
+}
+
+//------------------------------------------------------------------------
+struct NotificationCounter : IScintillaListener
+{
+	void onScintillaNotification (SCNotification* notification) override
+	{
+		if (notification->nmhdr.code != SCN_MODIFIED)
+			return;
+		if (notification->modificationType & SC_MOD_INSERTTEXT)
+			++inserts;
+		if (notification->modificationType & SC_MOD_DELETETEXT)
+			++deletes;
+	}
+	int inserts {0};
+	int deletes {0};
+};
+
+//------------------------------------------------------------------------
+/** parses the arguments, runs the tests and reports the result as the exit code */
+template <typename Proc>
+int run (int argc, char* argv[], Proc tests)
+{
+	for (auto i = 1; i < argc; ++i)
+	{
+		if (std::strcmp (argv[i], "--benchmark") == 0)
+			benchmark = true;
+	}
+	tests ();
+	if (benchmark && ScintillaMessageStats::enabled ())
+		printf ("%s", ScintillaMessageStats::toCSV (ScintillaMessageStats::snapshot ()).data ());
+	if (failures)
+		fprintf (stderr, "%d check(s) failed\n", failures);
+	return failures ? 1 : 0;
+}
+
+//------------------------------------------------------------------------
+} // Test
+} // VSTGUI
@@ -0,0 +1,102 @@
+// This file is part of VSTGUI. It is subject to the license terms
+// in the LICENSE file found in the top-level directory of this
+// distribution and at http://github.com/steinbergmedia/vstgui/LICENSE
+
+#include "testing.h"
+
+#include <string>
+#include <string_view>
+
+//------------------------------------------------------------------------
+namespace VSTGUI {
+namespace {
+
+using namespace Test;
+
+//------------------------------------------------------------------------
+void testUndoHistory ()
+{
+	auto editor = makeOwned<ScintillaEditorView> ();
+	editor->setText ("int main () {}\n");
+	editor->sendMessage (SCI_SETSAVEPOINT);
+	editor->sendMessage (SCI_GOTOPOS, 12);
+	for (auto c : std::string ("return 0;"))
+		editor->sendMessage (SCI_ADDTEXT, 1, &c);
+	CHECK (editor->getText () == "int main () {return 0;}\n");
+	editor->undo ();
+	CHECK (editor->getText () == "int main () {}\n");
+	CHECK (editor->sendMessage (SCI_GETMODIFY) == 0);
+	editor->redo ();
+
+	// the oldest steps are dropped, the remaining ones can still be undone
+	std::string block (1024, 'x');
+	block += "\n";
+	for (auto i = 0; i < 100; ++i)
+	{
+		editor->sendMessage (SCI_BEGINUNDOACTION);
+		editor->sendMessage (SCI_APPENDTEXT, block.size (), block.data ());
+		editor->sendMessage (SCI_ENDUNDOACTION);
+	}
+	auto text = editor->getText ().getString ();
+	editor->sendMessage (SCI_MARKERADD, 50, 1);
+	CHECK (editor->getUndoMemoryUsage () > 100 * 1024);
+	measure ("trimUndoHistory", text.size (), [&] () { editor->setUndoMemoryLimit (16 * 1024); });
+	CHECK (editor->getUndoMemoryUsage () <= 16 * 1024);
+	CHECK (editor->getText ().getString () == text);
+	// only the undo history changed, the markers stay on their lines
+	CHECK (editor->sendMessage (SCI_MARKERGET, 50) == (1 << 1));
+	editor->sendMessage (SCI_MARKERDELETEALL, -1);
+	size_t numSteps = 0;
+	while (editor->canUndo ())
+	{
+		editor->undo ();
+		++numSteps;
+	}
+	CHECK (numSteps > 0 && numSteps < 16);
+	CHECK (editor->getTextView ().size () == text.size () - numSteps * block.size ());
+	CHECK (editor->sendMessage (SCI_GETMODIFY) != 0);
+	while (editor->canRedo ())
+		editor->redo ();
+	CHECK (editor->getText ().getString () == text);
+
+	// the history survives a restart
+	editor->undo ();
+	editor->undo ();
+	auto data = editor->saveUndoHistory ();
+	auto restored = makeOwned<ScintillaEditorView> ();
+	CHECK (!restored->restoreUndoHistory ("invalid"));
+	measure ("restoreUndoHistory", data.size (),
+	         [&] () { CHECK (restored->restoreUndoHistory (data)); });
+	CHECK (restored->getText () == editor->getText ());
+	CHECK (restored->canUndo () && restored->canRedo ());
+	restored->redo ();
+	restored->redo ();
+	CHECK (restored->getText ().getString () == text);
+	restored->undo ();
+	CHECK (restored->getTextView ().size () == text.size () - block.size ());
+
+	// text with NUL bytes is restored completely
+	const std::string_view nulText ("a\0b", 3);
+	editor->setText (nulText);
+	editor->sendMessage (SCI_APPENDTEXT, 1, "c");
+	data = editor->saveUndoHistory ();
+	CHECK (restored->restoreUndoHistory (data));
+	CHECK (restored->getTextView ().equals (std::string_view ("a\0bc", 4)));
+	restored->undo ();
+	CHECK (restored->getTextView ().equals (nulText));
+}
+
+//------------------------------------------------------------------------
+} // anonymous
+} // VSTGUI
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	using namespace VSTGUI;
+	using namespace VSTGUI::Test;
+
+	return run (argc, argv, [] () {
+		testUndoHistory ();
+	});
+}